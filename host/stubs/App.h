@@ -0,0 +1,22 @@
+/**
+ * @file App.h
+ *
+ * @brief Host replacement of the Electra application base. Only the
+ *  SysEx memory pool is provided.
+ */
+
+#pragma once
+
+#include "SysexBlock.h"
+
+class App
+{
+public:
+    static App *get(void)
+    {
+        static App app;
+        return (&app);
+    }
+
+    SysexPool sysexPool;
+};
@@ -0,0 +1,46 @@
+/**
+ * @file Arduino.h
+ *
+ * @brief Host replacement of the Arduino core functions used by the
+ *  controller sources.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+typedef uint8_t byte;
+
+template <class T, class L, class H>
+inline T constrain(T amount, L low, H high)
+{
+    return ((amount < (T)low) ? (T)low
+                              : ((amount > (T)high) ? (T)high : amount));
+}
+
+template <class T, class A, class B, class C, class D>
+inline T map(T x, A inMin, B inMax, C outMin, D outMax)
+{
+    return ((x - (T)inMin) * ((T)outMax - (T)outMin) / ((T)inMax - (T)inMin)
+            + (T)outMin);
+}
+
+// Added to the clock, lets a replay skip the idle time of a capture
+inline uint32_t hostClockOffset = 0;
+
+inline uint32_t micros(void)
+{
+    using namespace std::chrono;
+    static const auto start = steady_clock::now();
+    return (
+        duration_cast<microseconds>(steady_clock::now() - start).count()
+        + hostClockOffset);
+}
+
+inline uint32_t millis(void)
+{
+    return (micros() / 1000);
+}
@@ -0,0 +1,198 @@
+/**
+ * @file ArduinoJson.h
+ *
+ * @brief Placeholder of the ArduinoJson interface used by the controller
+ *  sources. It does not parse JSON: documents hold no values and
+ *  deserializeJson() always fails, so the JSON parsers of the model
+ *  build on the host but report an error when they are run.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#define JSON_OBJECT_SIZE(n) ((n)*16)
+#define JSON_ARRAY_SIZE(n) ((n)*8)
+
+class JsonVariant
+{
+public:
+    template <class T>
+    T as(void) const
+    {
+        return (T());
+    }
+
+    template <class T>
+    bool is(void) const
+    {
+        return (false);
+    }
+
+    template <class T>
+    operator T(void) const
+    {
+        return (T());
+    }
+
+    template <class T>
+    T operator|(T defaultValue) const
+    {
+        return (defaultValue);
+    }
+
+    template <class T>
+    JsonVariant &operator=(const T &)
+    {
+        return (*this);
+    }
+
+    template <class T>
+    bool set(const T &)
+    {
+        return (false);
+    }
+
+    JsonVariant operator[](const char *) const
+    {
+        return (JsonVariant());
+    }
+
+    JsonVariant operator[](int) const
+    {
+        return (JsonVariant());
+    }
+
+    bool operator!(void) const
+    {
+        return (true);
+    }
+
+    bool isNull(void) const
+    {
+        return (true);
+    }
+
+    bool containsKey(const char *) const
+    {
+        return (false);
+    }
+
+    size_t size(void) const
+    {
+        return (0);
+    }
+
+    const JsonVariant *begin(void) const
+    {
+        return (nullptr);
+    }
+
+    const JsonVariant *end(void) const
+    {
+        return (nullptr);
+    }
+};
+
+class JsonArray : public JsonVariant
+{
+};
+
+class JsonObject : public JsonVariant
+{
+};
+
+class JsonDocument : public JsonVariant
+{
+public:
+    void clear(void)
+    {
+    }
+};
+
+template <size_t Capacity>
+class StaticJsonDocument : public JsonDocument
+{
+};
+
+class DynamicJsonDocument : public JsonDocument
+{
+public:
+    explicit DynamicJsonDocument(size_t)
+    {
+    }
+};
+
+class DeserializationError
+{
+public:
+    enum Code {
+        Ok,
+        EmptyInput,
+        IncompleteInput,
+        InvalidInput,
+        NoMemory,
+        TooDeep
+    };
+
+    DeserializationError(Code newCode) : errorCode(newCode)
+    {
+    }
+
+    Code code(void) const
+    {
+        return (errorCode);
+    }
+
+    const char *c_str(void) const
+    {
+        return ("IncompleteInput");
+    }
+
+    explicit operator bool(void) const
+    {
+        return (errorCode != Ok);
+    }
+
+    bool operator==(Code otherCode) const
+    {
+        return (errorCode == otherCode);
+    }
+
+    bool operator!=(Code otherCode) const
+    {
+        return (errorCode != otherCode);
+    }
+
+private:
+    Code errorCode;
+};
+
+struct DeserializationOption {
+    struct Option {
+    };
+
+    static Option Filter(const JsonDocument &)
+    {
+        return (Option());
+    }
+
+    static Option NestingLimit(int)
+    {
+        return (Option());
+    }
+};
+
+template <class Input>
+DeserializationError deserializeJson(JsonDocument &, Input &)
+{
+    return (DeserializationError::IncompleteInput);
+}
+
+template <class Input>
+DeserializationError deserializeJson(JsonDocument &,
+                                     Input &,
+                                     DeserializationOption::Option)
+{
+    return (DeserializationError::IncompleteInput);
+}
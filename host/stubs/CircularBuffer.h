@@ -0,0 +1,50 @@
+/**
+ * @file CircularBuffer.h
+ *
+ * @brief Host replacement of the fixed size circular buffer. The oldest
+ *  item is overwritten when the buffer is full.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+
+template <class T, size_t S>
+class CircularBuffer
+{
+public:
+    bool push(const T &item)
+    {
+        if (items.size() == S) {
+            items.pop_front();
+        }
+        items.push_back(item);
+        return (items.size() < S);
+    }
+
+    T shift(void)
+    {
+        T item = items.front();
+        items.pop_front();
+        return (item);
+    }
+
+    bool isEmpty(void) const
+    {
+        return (items.empty());
+    }
+
+    size_t size(void) const
+    {
+        return (items.size());
+    }
+
+    void clear(void)
+    {
+        items.clear();
+    }
+
+private:
+    std::deque<T> items;
+};
@@ -0,0 +1,27 @@
+/**
+ * @file Colours.h
+ *
+ * @brief Host replacement of the Electra colour helpers.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+struct Colours565 {
+    static constexpr uint32_t white = 0xFFFF;
+
+    static uint32_t fromString(const char *colour)
+    {
+        return (colour ? strtoul(colour, nullptr, 16) : white);
+    }
+};
+
+struct Colours888 {
+    static uint16_t toRGB565(uint32_t colour)
+    {
+        return (((colour >> 8) & 0xF800) | ((colour >> 5) & 0x07E0)
+                | ((colour >> 3) & 0x001F));
+    }
+};
@@ -0,0 +1,39 @@
+/**
+ * @file Component.h
+ *
+ * @brief Host replacement of the Electra GUI component. The model keeps
+ *  pointers to components, which are never created on the host.
+ */
+
+#pragma once
+
+#include "Rectangle.h"
+#include <cstdint>
+
+class Component
+{
+public:
+    virtual ~Component() = default;
+
+    virtual void repaint(void)
+    {
+    }
+
+    uint16_t getId(void) const
+    {
+        return (id);
+    }
+
+    Component *findChildById(uint16_t)
+    {
+        return (nullptr);
+    }
+
+    bool isVisible(void) const
+    {
+        return (false);
+    }
+
+private:
+    uint16_t id = 0;
+};
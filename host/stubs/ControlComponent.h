@@ -0,0 +1,23 @@
+/**
+ * @file ControlComponent.h
+ *
+ * @brief Host replacement of the component that displays a control.
+ */
+
+#pragma once
+
+#include "Component.h"
+#include "ControlValue.h"
+
+class ControlComponent : public Component
+{
+public:
+    const char *getName(void) const
+    {
+        return ("");
+    }
+
+    virtual void onMidiValueChange(const ControlValue &, int16_t, uint8_t)
+    {
+    }
+};
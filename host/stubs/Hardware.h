@@ -0,0 +1,213 @@
+/**
+ * @file Hardware.h
+ *
+ * @brief Host replacement of the Electra hardware. The SD card is
+ *  a directory of the host file system, the current directory unless
+ *  Hardware::sdcard.setRoot() selects another one.
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+
+#define MAX_FILENAME_LENGTH 255
+#define MAX_DIRNAME_LENGTH 255
+#define FILE_READ O_RDONLY
+#define FILE_WRITE (O_RDWR | O_CREAT)
+
+class File
+{
+public:
+    File() = default;
+
+    explicit File(FILE *newStream)
+        : stream(newStream, [](FILE *s) { fclose(s); })
+    {
+    }
+
+    explicit operator bool(void) const
+    {
+        return (stream != nullptr);
+    }
+
+    void close(void)
+    {
+        stream.reset();
+    }
+
+    int read(void)
+    {
+        return (stream ? fgetc(stream.get()) : -1);
+    }
+
+    size_t read(void *buffer, size_t length)
+    {
+        return (stream ? fread(buffer, 1, length, stream.get()) : 0);
+    }
+
+    int peek(void)
+    {
+        int c = read();
+
+        if (c >= 0) {
+            ungetc(c, stream.get());
+        }
+        return (c);
+    }
+
+    int available(void)
+    {
+        return (size() - position());
+    }
+
+    size_t write(uint8_t byte)
+    {
+        return (write(&byte, 1));
+    }
+
+    size_t write(const uint8_t *buffer, size_t length)
+    {
+        return (stream ? fwrite(buffer, 1, length, stream.get()) : 0);
+    }
+
+    size_t print(const char *text)
+    {
+        return (write((const uint8_t *)text, strlen(text)));
+    }
+
+    size_t print(long value)
+    {
+        return (print(std::to_string(value).c_str()));
+    }
+
+    bool seek(uint32_t newPosition)
+    {
+        return (stream && (fseek(stream.get(), newPosition, SEEK_SET) == 0));
+    }
+
+    uint32_t position(void)
+    {
+        return (stream ? ftell(stream.get()) : 0);
+    }
+
+    uint32_t size(void)
+    {
+        struct stat status;
+
+        if (!stream || (fstat(fileno(stream.get()), &status) != 0)) {
+            return (0);
+        }
+        return (status.st_size);
+    }
+
+    void setTimeout(unsigned long)
+    {
+    }
+
+    // Reads up to the target, false when the terminator or the end is hit
+    bool findUntil(const char *target, const char *terminator)
+    {
+        size_t targetLength = strlen(target);
+        size_t terminatorLength = strlen(terminator);
+        size_t targetIndex = 0;
+        size_t terminatorIndex = 0;
+        int c;
+
+        while ((c = read()) >= 0) {
+            targetIndex = (c == target[targetIndex]) ? targetIndex + 1
+                                                     : (c == target[0]);
+            if (targetIndex == targetLength) {
+                return (true);
+            }
+            terminatorIndex = (c == terminator[terminatorIndex])
+                                  ? terminatorIndex + 1
+                                  : (c == terminator[0]);
+            if (terminatorIndex == terminatorLength) {
+                return (false);
+            }
+        }
+        return (false);
+    }
+
+private:
+    std::shared_ptr<FILE> stream;
+};
+
+class Sdcard
+{
+public:
+    void setRoot(const char *newRoot)
+    {
+        root = newRoot;
+    }
+
+    File createInputStream(const char *filename)
+    {
+        return (open(filename, "rb"));
+    }
+
+    File createOutputStream(const char *filename, int flags)
+    {
+        if ((flags & O_TRUNC) || !exists(filename)) {
+            return (open(filename, "w+b"));
+        }
+
+        File file = open(filename, "r+b");
+        file.seek(file.size());
+        return (file);
+    }
+
+    bool exists(const char *filename)
+    {
+        struct stat status;
+        return (stat(getPath(filename).c_str(), &status) == 0);
+    }
+
+    bool directoryExists(const char *dirname)
+    {
+        struct stat status;
+        return ((stat(getPath(dirname).c_str(), &status) == 0)
+                && S_ISDIR(status.st_mode));
+    }
+
+    bool createDirectory(const char *dirname)
+    {
+        return (mkdir(getPath(dirname).c_str(), 0755) == 0);
+    }
+
+    bool deleteFile(const char *filename)
+    {
+        return (remove(getPath(filename).c_str()) == 0);
+    }
+
+    bool renameFile(const char *from, const char *to)
+    {
+        // SdFat does not replace an existing file
+        return (!exists(to)
+                && (rename(getPath(from).c_str(), getPath(to).c_str()) == 0));
+    }
+
+private:
+    std::string getPath(const char *filename) const
+    {
+        return (root + "/" + filename);
+    }
+
+    File open(const char *filename, const char *mode)
+    {
+        FILE *stream = fopen(getPath(filename).c_str(), mode);
+        return (stream ? File(stream) : File());
+    }
+
+    std::string root = ".";
+};
+
+struct Hardware {
+    static inline Sdcard sdcard;
+};
@@ -0,0 +1,26 @@
+/**
+ * @file InstanceCallback.h
+ *
+ * @brief Host replacement of the framework adapter of member functions
+ *  to plain callbacks.
+ */
+
+#pragma once
+
+#include <functional>
+
+typedef void (*TaskCallback)(void);
+
+template <typename T>
+struct InstanceCallback;
+
+template <typename Ret, typename... Params>
+struct InstanceCallback<Ret(Params...)> {
+    template <typename... Args>
+    static Ret callback(Args... args)
+    {
+        return (callbackFunction(args...));
+    }
+
+    static inline std::function<Ret(Params...)> callbackFunction;
+};
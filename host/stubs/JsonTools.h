@@ -0,0 +1,22 @@
+/**
+ * @file JsonTools.h
+ *
+ * @brief Host replacement of the framework JSON file helpers. Like the
+ *  ArduinoJson placeholder, they never find anything.
+ */
+
+#pragma once
+
+#include "Hardware.h"
+
+enum ElementType { ELEMENT, OBJECT, ARRAY };
+
+inline bool findElement(File &, const char *, ElementType, size_t = 0)
+{
+    return (false);
+}
+
+inline bool isElementEmpty(File &)
+{
+    return (true);
+}
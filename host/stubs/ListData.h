@@ -0,0 +1,96 @@
+/**
+ * @file ListData.h
+ *
+ * @brief Host replacement of the Electra list data with the linear
+ *  lookups of the original.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ListDataItem
+{
+public:
+    ListDataItem(int16_t newValue, const char *newLabel)
+        : value(newValue), label(newLabel ? newLabel : "")
+    {
+    }
+
+    int16_t getValue(void) const
+    {
+        return (value);
+    }
+
+    const char *getLabel(void) const
+    {
+        return (label.c_str());
+    }
+
+    bool isBitmapEmpty(void) const
+    {
+        return (true);
+    }
+
+private:
+    int16_t value;
+    std::string label;
+};
+
+class ListData
+{
+public:
+    explicit ListData(uint8_t newId) : id(newId)
+    {
+    }
+
+    uint8_t getId(void) const
+    {
+        return (id);
+    }
+
+    void addItem(int16_t value, const char *label, const char *)
+    {
+        items.emplace_back(value, label);
+    }
+
+    uint16_t getNumItems(void) const
+    {
+        return (items.size());
+    }
+
+    uint16_t getMaxIndex(void) const
+    {
+        return (items.empty() ? 0 : items.size() - 1);
+    }
+
+    int16_t getValueByIndex(uint16_t index) const
+    {
+        return (items[index].getValue());
+    }
+
+    const ListDataItem &getByIndex(uint16_t index) const
+    {
+        return (items[index]);
+    }
+
+    int16_t getIndexByValue(int16_t value) const
+    {
+        for (uint16_t i = 0; i < items.size(); i++) {
+            if (items[i].getValue() == value) {
+                return (i);
+            }
+        }
+        return (-1);
+    }
+
+    void print(void) const
+    {
+    }
+
+private:
+    uint8_t id;
+    std::vector<ListDataItem> items;
+};
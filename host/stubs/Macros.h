@@ -0,0 +1,10 @@
+/**
+ * @file Macros.h
+ *
+ * @brief Host replacement of the framework macros used by the controller
+ *  sources.
+ */
+
+#pragma once
+
+#define NOT_SET -1
@@ -0,0 +1,173 @@
+/**
+ * @file MidiMessage.h
+ *
+ * @brief Host replacement of the Electra MIDI message and input. Channels
+ *  are numbered from 1, like in the framework.
+ */
+
+#pragma once
+
+#include "SysexBlock.h"
+#include <cstdint>
+
+struct MidiInterface {
+    enum class Type { MidiAll, MidiIo, MidiUsbDev, MidiUsbHost };
+};
+
+class MidiInput
+{
+public:
+    MidiInput(MidiInterface::Type newInterfaceType, uint8_t newPort)
+        : interfaceType(newInterfaceType), port(newPort)
+    {
+    }
+
+    MidiInterface::Type getInterfaceType(void) const
+    {
+        return (interfaceType);
+    }
+
+    uint8_t getPort(void) const
+    {
+        return (port);
+    }
+
+private:
+    MidiInterface::Type interfaceType;
+    uint8_t port;
+};
+
+class MidiMessage
+{
+public:
+    enum class Type : uint8_t {
+        NoteOff = 0x80,
+        NoteOn = 0x90,
+        AfterTouchPoly = 0xA0,
+        ControlChange = 0xB0,
+        ProgramChange = 0xC0,
+        AfterTouchChannel = 0xD0,
+        PitchBend = 0xE0,
+        SystemExclusive = 0xF0,
+        TimeCodeQuarterFrame = 0xF1,
+        SongPosition = 0xF2,
+        SongSelect = 0xF3,
+        TuneRequest = 0xF6,
+        Clock = 0xF8,
+        Start = 0xFA,
+        Continue = 0xFB,
+        Stop = 0xFC,
+        ActiveSensing = 0xFE,
+        SystemReset = 0xFF
+    };
+
+    // A channel or system message from its status and data bytes
+    MidiMessage(uint8_t status, uint8_t newData1 = 0, uint8_t newData2 = 0)
+        : type((status < 0xF0) ? (Type)(status & 0xF0) : (Type)status),
+          channel((status < 0xF0) ? (status & 0x0F) + 1 : 0),
+          data1(newData1),
+          data2(newData2)
+    {
+    }
+
+    explicit MidiMessage(const SysexBlock &newSysexBlock)
+        : type(Type::SystemExclusive),
+          channel(0),
+          data1(0),
+          data2(0),
+          sysexBlock(newSysexBlock)
+    {
+    }
+
+    Type getType(void) const
+    {
+        return (type);
+    }
+
+    uint8_t getChannel(void) const
+    {
+        return (channel);
+    }
+
+    uint8_t getData1(void) const
+    {
+        return (data1);
+    }
+
+    uint8_t getData2(void) const
+    {
+        return (data2);
+    }
+
+    SysexBlock getSysExBlock(void) const
+    {
+        return (sysexBlock);
+    }
+
+    bool isController(void) const
+    {
+        return (type == Type::ControlChange);
+    }
+
+    bool isBankSelect(void) const
+    {
+        return (isController() && ((data1 == 0) || (data1 == 32)));
+    }
+
+    bool isNote(void) const
+    {
+        return ((type == Type::NoteOn) || (type == Type::NoteOff));
+    }
+
+    bool isProgramChange(void) const
+    {
+        return (type == Type::ProgramChange);
+    }
+
+    bool isAftertouch(void) const
+    {
+        return (type == Type::AfterTouchPoly);
+    }
+
+    bool isChannelPressure(void) const
+    {
+        return (type == Type::AfterTouchChannel);
+    }
+
+    bool isPitchWheel(void) const
+    {
+        return (type == Type::PitchBend);
+    }
+
+    bool isSysEx(void) const
+    {
+        return (type == Type::SystemExclusive);
+    }
+
+    bool isMidiStart(void) const
+    {
+        return (type == Type::Start);
+    }
+
+    bool isMidiStop(void) const
+    {
+        return (type == Type::Stop);
+    }
+
+    bool isMidiTuneRequest(void) const
+    {
+        return (type == Type::TuneRequest);
+    }
+
+    bool isSongPositionPointer(void) const
+    {
+        return (type == Type::SongPosition);
+    }
+
+private:
+    Type type;
+    uint8_t channel;
+    uint8_t data1;
+    uint8_t data2;
+    SysexBlock sysexBlock;
+};
@@ -0,0 +1,271 @@
+/**
+ * @file MidiOutput.h
+ *
+ * @brief Host replacement of the Electra MIDI output. The bytes of all
+ *  sent messages are appended to MidiOutput::sentBytes.
+ */
+
+#pragma once
+
+#include "CircularBuffer.h"
+#include "MidiMessage.h"
+#include "SysexBlock.h"
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <vector>
+
+namespace ElectraCommand
+{
+enum class Object : uint8_t {
+    PresetList = 0x04,
+    SnapshotList = 0x05,
+};
+}
+
+class MidiOutput
+{
+public:
+    MidiOutput() : port(0), channel(0), rate(0)
+    {
+    }
+
+    MidiOutput(MidiInterface::Type,
+               uint8_t newPort,
+               uint8_t newChannel,
+               uint16_t newRate)
+        : port(newPort), channel(newChannel), rate(newRate)
+    {
+    }
+
+    uint8_t getPort(void) const
+    {
+        return (port);
+    }
+
+    void setPort(uint8_t newPort)
+    {
+        port = newPort;
+    }
+
+    uint8_t getChannel(void) const
+    {
+        return (channel);
+    }
+
+    void setChannel(uint8_t newChannel)
+    {
+        channel = newChannel;
+    }
+
+    uint16_t getRate(void) const
+    {
+        return (rate);
+    }
+
+    void setRate(uint16_t newRate)
+    {
+        rate = newRate;
+    }
+
+    static void sendControlChange(MidiInterface::Type,
+                                  uint8_t,
+                                  uint8_t channel,
+                                  uint8_t parameterNumber,
+                                  uint8_t value)
+    {
+        send({ status(0xB0, channel), parameterNumber, value });
+    }
+
+    static void sendControlChange14Bit(MidiInterface::Type interface,
+                                       uint8_t port,
+                                       uint8_t channel,
+                                       uint16_t parameterNumber,
+                                       uint16_t midiValue,
+                                       bool lsbFirst)
+    {
+        uint8_t msb = (midiValue >> 7) & 0x7F;
+        uint8_t lsb = midiValue & 0x7F;
+
+        if (lsbFirst) {
+            sendControlChange(
+                interface, port, channel, parameterNumber + 32, lsb);
+        }
+        sendControlChange(interface, port, channel, parameterNumber, msb);
+        if (!lsbFirst) {
+            sendControlChange(
+                interface, port, channel, parameterNumber + 32, lsb);
+        }
+    }
+
+    static void sendNrpn(MidiInterface::Type interface,
+                         uint8_t port,
+                         uint8_t channel,
+                         uint16_t parameterNumber,
+                         uint16_t midiValue,
+                         bool lsbFirst,
+                         bool resetRpn)
+    {
+        sendParameter(interface,
+                      port,
+                      channel,
+                      99,
+                      parameterNumber,
+                      midiValue,
+                      lsbFirst);
+
+        if (resetRpn) {
+            sendControlChange(interface, port, channel, 101, 127);
+            sendControlChange(interface, port, channel, 100, 127);
+        }
+    }
+
+    static void sendRpn(MidiInterface::Type interface,
+                        uint8_t port,
+                        uint8_t channel,
+                        uint16_t parameterNumber,
+                        uint16_t midiValue)
+    {
+        sendParameter(
+            interface, port, channel, 101, parameterNumber, midiValue, false);
+    }
+
+    static void sendProgramChange(MidiInterface::Type,
+                                  uint8_t,
+                                  uint8_t channel,
+                                  uint8_t programNumber)
+    {
+        send({ status(0xC0, channel), programNumber });
+    }
+
+    static void sendNoteOn(MidiInterface::Type,
+                           uint8_t,
+                           uint8_t channel,
+                           uint8_t noteNumber,
+                           uint8_t velocity)
+    {
+        send({ status(0x90, channel), noteNumber, velocity });
+    }
+
+    static void sendNoteOff(MidiInterface::Type,
+                            uint8_t,
+                            uint8_t channel,
+                            uint8_t noteNumber,
+                            uint8_t velocity)
+    {
+        send({ status(0x80, channel), noteNumber, velocity });
+    }
+
+    static void sendStart(MidiInterface::Type, uint8_t)
+    {
+        send({ 0xFA });
+    }
+
+    static void sendStop(MidiInterface::Type, uint8_t)
+    {
+        send({ 0xFC });
+    }
+
+    static void sendTuneRequest(MidiInterface::Type, uint8_t)
+    {
+        send({ 0xF6 });
+    }
+
+    static void sendSysEx(MidiInterface::Type,
+                          uint8_t,
+                          const uint8_t *data,
+                          uint16_t length)
+    {
+        sentBytes.insert(sentBytes.end(), data, data + length);
+    }
+
+    static void sendSysEx(MidiInterface::Type interface,
+                          uint8_t port,
+                          SysexBlock &sysexBlock)
+    {
+        sendSysEx(
+            interface, port, sysexBlock.getData(), sysexBlock.getLength());
+    }
+
+    static void sendAfterTouchChannel(MidiInterface::Type,
+                                      uint8_t,
+                                      uint8_t channel,
+                                      uint8_t pressure)
+    {
+        send({ status(0xD0, channel), pressure });
+    }
+
+    static void sendAfterTouchPoly(MidiInterface::Type,
+                                   uint8_t,
+                                   uint8_t channel,
+                                   uint8_t noteNumber,
+                                   uint8_t pressure)
+    {
+        send({ status(0xA0, channel), noteNumber, pressure });
+    }
+
+    static void sendPitchBend(MidiInterface::Type,
+                              uint8_t,
+                              uint8_t channel,
+                              uint16_t value)
+    {
+        send({ status(0xE0, channel),
+               (uint8_t)(value & 0x7F),
+               (uint8_t)((value >> 7) & 0x7F) });
+    }
+
+    static void sendSongPosition(MidiInterface::Type, uint8_t, uint16_t beats)
+    {
+        send({ 0xF2,
+               (uint8_t)(beats & 0x7F),
+               (uint8_t)((beats >> 7) & 0x7F) });
+    }
+
+    static void sendSysExPartial(MidiInterface::Type,
+                                 uint8_t,
+                                 const uint8_t *data,
+                                 uint16_t length,
+                                 bool)
+    {
+        sentBytes.insert(sentBytes.end(), data, data + length);
+        numTransfers++;
+    }
+
+    static inline std::vector<uint8_t> sentBytes;
+    static inline uint32_t numTransfers = 0;
+
+private:
+    static uint8_t status(uint8_t type, uint8_t channel)
+    {
+        return (type | ((channel - 1) & 0x0F));
+    }
+
+    static void send(std::initializer_list<uint8_t> bytes)
+    {
+        sentBytes.insert(sentBytes.end(), bytes);
+    }
+
+    // The NRPN or RPN select, followed by the data entry
+    static void sendParameter(MidiInterface::Type interface,
+                              uint8_t port,
+                              uint8_t channel,
+                              uint8_t selectMsb,
+                              uint16_t parameterNumber,
+                              uint16_t midiValue,
+                              bool lsbFirst)
+    {
+        sendControlChange(interface,
+                          port,
+                          channel,
+                          selectMsb,
+                          (parameterNumber >> 7) & 0x7F);
+        sendControlChange(
+            interface, port, channel, selectMsb - 1, parameterNumber & 0x7F);
+        sendControlChange14Bit(
+            interface, port, channel, 6, midiValue, lsbFirst);
+    }
+
+    uint8_t port;
+    uint8_t channel;
+    uint16_t rate;
+};
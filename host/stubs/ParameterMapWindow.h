@@ -0,0 +1,24 @@
+/**
+ * @file ParameterMapWindow.h
+ *
+ * @brief Host replacement of the windows that display parameter values.
+ *  No window is ever registered on the host.
+ */
+
+#pragma once
+
+#include "Component.h"
+
+class ParameterMapWindow
+{
+public:
+    const char *getName(void) const
+    {
+        return ("");
+    }
+
+    Component *getOwnedContent(void) const
+    {
+        return (nullptr);
+    }
+};
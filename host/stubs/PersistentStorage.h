@@ -0,0 +1,9 @@
+/**
+ * @file PersistentStorage.h
+ *
+ * @brief Host replacement of the Electra persistent storage header.
+ */
+
+#pragma once
+
+#include "Hardware.h"
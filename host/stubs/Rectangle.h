@@ -0,0 +1,67 @@
+/**
+ * @file Rectangle.h
+ *
+ * @brief Host replacement of the Electra GUI rectangle.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+class Rectangle
+{
+public:
+    Rectangle() : x(0), y(0), width(0), height(0)
+    {
+    }
+
+    Rectangle(int16_t newX, int16_t newY, uint16_t newWidth, uint16_t newHeight)
+        : x(newX), y(newY), width(newWidth), height(newHeight)
+    {
+    }
+
+    int16_t getX(void) const
+    {
+        return (x);
+    }
+
+    int16_t getY(void) const
+    {
+        return (y);
+    }
+
+    uint16_t getWidth(void) const
+    {
+        return (width);
+    }
+
+    uint16_t getHeight(void) const
+    {
+        return (height);
+    }
+
+    void setX(int16_t newX)
+    {
+        x = newX;
+    }
+
+    void setY(int16_t newY)
+    {
+        y = newY;
+    }
+
+    void setWidth(uint16_t newWidth)
+    {
+        width = newWidth;
+    }
+
+    void setHeight(uint16_t newHeight)
+    {
+        height = newHeight;
+    }
+
+    int16_t x;
+    int16_t y;
+    uint16_t width;
+    uint16_t height;
+};
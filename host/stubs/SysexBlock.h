@@ -0,0 +1,65 @@
+/**
+ * @file SysexBlock.h
+ *
+ * @brief Host replacement of the Electra SysEx memory block. The bytes
+ *  are kept in a vector shared by the copies of the block.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+typedef std::shared_ptr<std::vector<uint8_t>> MemoryBlock;
+
+class SysexBlock
+{
+public:
+    SysexBlock() = default;
+
+    explicit SysexBlock(MemoryBlock newBlock) : block(newBlock)
+    {
+    }
+
+    bool isEmpty(void) const
+    {
+        return (!block || block->empty());
+    }
+
+    uint32_t getLength(void) const
+    {
+        return (block ? block->size() : 0);
+    }
+
+    uint8_t peek(uint32_t index) const
+    {
+        return ((index < getLength()) ? (*block)[index] : 0);
+    }
+
+    const uint8_t *getData(void) const
+    {
+        return (block ? block->data() : nullptr);
+    }
+
+    void writeBytes(const uint8_t *data, uint32_t length)
+    {
+        if (block) {
+            block->insert(block->end(), data, data + length);
+        }
+    }
+
+    void close(void)
+    {
+    }
+
+private:
+    MemoryBlock block;
+};
+
+struct SysexPool {
+    MemoryBlock openMemoryBlock(void)
+    {
+        return (std::make_shared<std::vector<uint8_t>>());
+    }
+};
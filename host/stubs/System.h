@@ -0,0 +1,94 @@
+/**
+ * @file System.h
+ *
+ * @brief Host replacement of the Electra System services. The logger
+ *  formats the messages like the firmware one does, but discards them.
+ *  Tasks are never run.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "Hardware.h"
+#include "InstanceCallback.h"
+#include "helpers.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define LOG_NONE 0
+#define LOG_ERROR 1
+#define LOG_INFO 2
+#define LOG_WARNING 3
+#define LOG_TRACE 4
+
+class Logger
+{
+public:
+    void write(uint8_t, const char *format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+    }
+
+    char buffer[256];
+};
+
+#define TASK_FOREVER (-1)
+
+class Task
+{
+public:
+    void set(unsigned long, long, void (*)(void))
+    {
+    }
+
+    void enable(void)
+    {
+    }
+
+    void disable(void)
+    {
+    }
+};
+
+class Scheduler
+{
+public:
+    void addTask(Task &)
+    {
+    }
+
+    void deleteTask(Task &)
+    {
+    }
+
+    void enableRepaintGraphics(void)
+    {
+    }
+
+    void disableRepaintGraphics(void)
+    {
+    }
+
+    void clearRepaintGraphics(void)
+    {
+    }
+};
+
+struct System {
+    static inline Logger logger;
+    static inline Scheduler tasks;
+};
+
+inline void copyString(char *destination, const char *source, size_t maxLength)
+{
+    strncpy(destination, source ? source : "", maxLength);
+    destination[maxLength] = '\0';
+}
@@ -0,0 +1,40 @@
+/**
+ * @file helpers.h
+ *
+ * @brief Host replacement of the framework helpers used by the value
+ *  translation, the SysEx templates and the control layout.
+ */
+
+#pragma once
+
+#include "Rectangle.h"
+#include <cstdint>
+
+inline uint16_t getRange(uint8_t bitWidth)
+{
+    return (1 << bitWidth);
+}
+
+inline uint16_t createMask(uint8_t bitPosition, uint8_t size)
+{
+    return (((1 << size) - 1) << bitPosition);
+}
+
+inline uint8_t getShift(uint16_t mask)
+{
+    uint8_t shift = 0;
+
+    while (mask && !(mask & 1)) {
+        mask >>= 1;
+        shift++;
+    }
+    return (shift);
+}
+
+// Bounds of a control slot in the grid of six columns
+inline Rectangle controlSlotToBounds(uint8_t slot)
+{
+    uint8_t index = (slot > 0) ? slot - 1 : 0;
+
+    return (Rectangle((index % 6) * 170, (index / 6) * 88, 146, 56));
+}
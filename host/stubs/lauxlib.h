@@ -0,0 +1,10 @@
+#pragma once
+
+#include "lua.h"
+
+typedef int (*lua_CFunction)(lua_State *L);
+
+typedef struct luaL_Reg {
+    const char *name;
+    lua_CFunction func;
+} luaL_Reg;
@@ -0,0 +1,6 @@
+#pragma once
+
+typedef struct lua_State lua_State;
+
+#define LUA_NOREF (-2)
+#define LUA_REFNIL (-1)
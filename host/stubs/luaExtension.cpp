@@ -0,0 +1,41 @@
+/**
+ * @file luaExtension.cpp
+ *
+ * @brief Host definitions of the Lua state and of the hooks called by
+ *  the controller sources. None of them is reached while L is nullptr.
+ */
+
+#include "luaExtension.h"
+
+lua_State *L = nullptr;
+Preset *luaPreset = nullptr;
+
+void runFormatter(uint8_t, const void *, int16_t, char *buffer, int)
+{
+    *buffer = '\0';
+}
+
+void runFunction(uint8_t, const void *, int16_t)
+{
+}
+
+uint8_t runTemplateFunction(uint8_t, const void *, int16_t)
+{
+    return (0);
+}
+
+void runOnResponse(const Device &, uint8_t, SysexBlock &)
+{
+}
+
+void runOnRequest(const Device &)
+{
+}
+
+void parameterMap_onChange(LookupEntry *, Origin)
+{
+}
+
+void preset_onReady(void)
+{
+}
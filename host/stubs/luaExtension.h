@@ -0,0 +1,18 @@
+/**
+ * @file luaExtension.h
+ *
+ * @brief Host replacement of the Lua extension. No script is loaded on
+ *  the host, L and luaPreset stay nullptr and the hooks do nothing.
+ */
+
+#pragma once
+
+#include "Preset.h"
+#include "ParameterMap.h"
+#include "luaHooks.h"
+#include "luaPatch.h"
+
+extern Preset *luaPreset;
+
+void parameterMap_onChange(LookupEntry *entry, Origin origin);
+void preset_onReady(void);
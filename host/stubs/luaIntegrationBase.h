@@ -0,0 +1,6 @@
+#pragma once
+
+#include "lua.h"
+
+// No Lua state is ever created on the host
+extern lua_State *L;
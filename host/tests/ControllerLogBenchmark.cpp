@@ -0,0 +1,122 @@
+/**
+ * @file ControllerLogBenchmark.cpp
+ *
+ * @brief Measures the per-message logging cost of the MIDI input path
+ *  before and after ControllerLog.
+ *
+ * Before, every incoming CC was formatted with System::logger.write() at
+ * LOG_ERROR. Now it is counted and the trace message is compiled out at
+ * the default release level. The host logger formats the messages but
+ * does not transmit them, so the figure for the former path is a lower
+ * bound of its cost on the controller.
+ *
+ * The timer histogram is checked with known durations, the percentiles
+ * are the upper bounds of the power-of-two buckets, capped by the maximum.
+ */
+
+#include "ControllerLog.h"
+#include <cstdio>
+
+static_assert(!ControllerLog::isEnabled(ControllerLog::midi,
+                                        ControllerLog::trace),
+              "per-message traces must be compiled out by default");
+
+// The former Midi::processCc logging
+static void __attribute__((noinline))
+    logBefore(uint8_t midiParameterId, uint8_t midiValue)
+{
+    System::logger.write(LOG_ERROR,
+                         "ElectraMidi: processMidi: Control change midi "
+                         "message: parameter=%d, value=%d",
+                         midiParameterId,
+                         midiValue);
+}
+
+// The current Midi::processCc logging
+static void __attribute__((noinline))
+    logAfter(uint8_t midiParameterId, uint8_t midiValue)
+{
+    COUNT_EVENT(midiCc);
+    LOG_TRACE_IN(
+        midi,
+        "Midi::processMidi: Control change midi message: parameter=%d, value=%d",
+        midiParameterId,
+        midiValue);
+}
+
+static bool checkPercentile(uint8_t percentile, uint32_t expected)
+{
+    uint32_t duration =
+        ControllerLog::getPercentile(ControllerLog::midiProcess, percentile);
+
+    if (duration != expected) {
+        printf("FAIL: p%d: %lu, expected %lu\n",
+               percentile,
+               (unsigned long)duration,
+               (unsigned long)expected);
+        return (false);
+    }
+    return (true);
+}
+
+static bool checkTimer(void)
+{
+    ControllerLog::resetCounters();
+
+    if (!checkPercentile(50, 0)) {
+        return (false);
+    }
+
+    for (uint32_t duration = 1; duration <= 1000; duration++) {
+        RECORD_TIME(midiProcess, duration);
+    }
+
+    // 500 falls in 256 - 511us, 900 and 990 in 512 - 1023us, capped at 1000
+    bool passed = checkPercentile(50, 511);
+    passed = checkPercentile(90, 1000) && passed;
+    passed = checkPercentile(99, 1000) && passed;
+
+    // durations of 0us have a bucket of their own
+    ControllerLog::resetCounters();
+    RECORD_TIME(midiProcess, 0);
+    passed = checkPercentile(100, 0) && passed;
+
+    return (passed);
+}
+
+int main(void)
+{
+    const uint32_t numMessages = 1000000;
+
+    uint32_t startTime = micros();
+    for (uint32_t i = 0; i < numMessages; i++) {
+        logBefore(i % 128, (i >> 7) % 128);
+    }
+    uint32_t beforeTime = micros() - startTime;
+
+    ControllerLog::resetCounters();
+    startTime = micros();
+    for (uint32_t i = 0; i < numMessages; i++) {
+        logAfter(i % 128, (i >> 7) % 128);
+    }
+    uint32_t afterTime = micros() - startTime;
+
+    printf("before: %6.1f ns/message\n", beforeTime * 1000.0 / numMessages);
+    printf("after:  %6.1f ns/message\n", afterTime * 1000.0 / numMessages);
+
+    if (ControllerLog::getCount(ControllerLog::midiCc) != numMessages) {
+        printf("FAIL: midiCc counter: %lu\n",
+               (unsigned long)ControllerLog::getCount(ControllerLog::midiCc));
+        return (1);
+    }
+
+    ControllerLog::printCounters();
+    ControllerLog::resetCounters();
+
+    if (ControllerLog::getCount(ControllerLog::midiCc) != 0) {
+        printf("FAIL: counters were not reset\n");
+        return (1);
+    }
+
+    return (checkTimer() ? 0 : 1);
+}
@@ -0,0 +1,44 @@
+/**
+ * @file HeapCounter.h
+ *
+ * @brief Counts heap allocations of a host test. Include it in exactly
+ *  one translation unit of the test executable.
+ */
+
+#pragma once
+
+#include <cstdlib>
+#include <new>
+
+namespace HeapCounter
+{
+inline size_t numAllocations = 0;
+inline size_t allocatedBytes = 0;
+
+inline void reset(void)
+{
+    numAllocations = 0;
+    allocatedBytes = 0;
+}
+} // namespace HeapCounter
+
+void *operator new(size_t size)
+{
+    HeapCounter::numAllocations++;
+    HeapCounter::allocatedBytes += size;
+
+    if (void *memory = malloc(size ? size : 1)) {
+        return (memory);
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file LookupTableBenchmark.cpp
+ *
+ * @brief Compares LookupTable with the std::map it replaced.
+ *
+ * The tables hold the parameters of a 432-control preset. 100k mixed
+ * CC, NRPN and SysEx parameter lookups are replayed against both of them.
+ * The test fails when the tables disagree.
+ */
+
+#include "HeapCounter.h"
+#include "LookupTable.h"
+#include <cstdio>
+#include <map>
+#include <random>
+
+static uint32_t calculateHash(uint8_t deviceId,
+                              Message::Type type,
+                              uint16_t parameterNumber)
+{
+    return (parameterNumber + ((uint32_t)type << 16)
+            + ((uint32_t)deviceId << 24));
+}
+
+int main(void)
+{
+    const uint16_t numControls = 432;
+    const uint32_t numLookups = 100000;
+    std::mt19937 random(1);
+    std::vector<uint32_t> presetHashes;
+
+    // 3 devices, CCs, NRPNs and SysEx parameters like a large preset
+    for (uint16_t i = 0; i < numControls; i++) {
+        uint8_t deviceId = 1 + i % 3;
+
+        if (i % 3 == 0) {
+            presetHashes.push_back(
+                calculateHash(deviceId, Message::Type::cc7, i % 128));
+        } else if (i % 3 == 1) {
+            presetHashes.push_back(
+                calculateHash(deviceId, Message::Type::nrpn, i * 37 % 16384));
+        } else {
+            presetHashes.push_back(
+                calculateHash(deviceId, Message::Type::sysex, i));
+        }
+    }
+
+    // most lookups hit the preset, some come from unmapped parameters
+    std::vector<uint32_t> lookups;
+    for (uint32_t i = 0; i < numLookups; i++) {
+        if (random() % 8) {
+            lookups.push_back(presetHashes[random() % presetHashes.size()]);
+        } else {
+            lookups.push_back(
+                calculateHash(4, Message::Type::cc7, random() % 128));
+        }
+    }
+
+    HeapCounter::reset();
+    std::map<uint32_t, LookupEntry> map;
+    for (auto hash : presetHashes) {
+        map[hash];
+    }
+    size_t mapBytes = HeapCounter::allocatedBytes;
+    size_t mapAllocations = HeapCounter::numAllocations;
+
+    HeapCounter::reset();
+    LookupTable table;
+    for (auto hash : presetHashes) {
+        table.emplace(hash);
+    }
+    size_t tableBytes = HeapCounter::allocatedBytes;
+    size_t tableAllocations = HeapCounter::numAllocations;
+
+    uint32_t mapHits = 0;
+    uint32_t tableHits = 0;
+    const int rounds = 20;
+
+    uint32_t startTime = micros();
+    for (int round = 0; round < rounds; round++) {
+        for (auto hash : lookups) {
+            auto it = map.find(hash);
+            mapHits += (it != map.end());
+        }
+    }
+    uint32_t mapTime = micros() - startTime;
+
+    startTime = micros();
+    for (int round = 0; round < rounds; round++) {
+        for (auto hash : lookups) {
+            LookupEntry *entry = table.find(hash);
+            tableHits += (entry != nullptr);
+        }
+    }
+    uint32_t tableTime = micros() - startTime;
+
+    for (auto hash : lookups) {
+        if ((map.find(hash) != map.end()) != (table.find(hash) != nullptr)) {
+            printf("FAIL: tables disagree: hash=%08x\n", hash);
+            return (1);
+        }
+    }
+
+    printf("entries: %zu\n", table.size());
+    printf("std::map:    %6.1f ns/lookup, %zu bytes in %zu allocations\n",
+           mapTime * 1000.0 / (numLookups * rounds),
+           mapBytes,
+           mapAllocations);
+    printf("LookupTable: %6.1f ns/lookup, %zu bytes in %zu allocations\n",
+           tableTime * 1000.0 / (numLookups * rounds),
+           tableBytes,
+           tableAllocations);
+
+    return ((mapHits == tableHits) ? 0 : 1);
+}
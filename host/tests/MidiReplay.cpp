@@ -0,0 +1,564 @@
+/**
+ * @file MidiReplay.cpp
+ *
+ * @brief Replays a timestamped MIDI capture through the controller model.
+ *
+ * The preset is loaded with Preset::load() and its values are registered
+ * in the parameter map as Presets::loadPreset() does. Received messages
+ * go through Midi::process(), timed as in
+ * Controller::handleIncomingMidiMessage(), and update the parameter map.
+ * Changes made on the controller are applied with ParameterMap::setValue()
+ * and transmitted by the onChange callback of ControllerApp through
+ * Midi::sendMessage(). The host clock is advanced to the timestamps of
+ * the capture; the output and repaint queues are flushed in between as
+ * the firmware tasks do.
+ *
+ * JSON is not parsed on the host, a preset is restored from the .epc
+ * image the firmware wrote next to the .epr file. Without arguments,
+ * a built-in preset is saved as an image and loaded the same way, and
+ * a built-in capture of CC, 14-bit CC, NRPN, SysEx responses, clock and
+ * controller changes is replayed and its results are checked.
+ *
+ * Usage: MidiReplay [preset.epr [capture.txt]]
+ *
+ * Capture lines are "<time us> in <port> <hex bytes>" for received
+ * messages and "<time us> set <control id> <midi value>" for changes
+ * made on the controller.
+ */
+
+#include "App.h"
+#include "HeapCounter.h"
+#include "Midi.h"
+#include "ParameterMap.h"
+#include "PresetCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct ReplayEvent {
+    uint32_t time;
+    bool received;
+    uint8_t port;
+    MidiMessage midiMessage;
+    uint16_t controlId;
+    uint16_t midiValue;
+};
+
+static const uint8_t SynthId = 1;
+static const uint8_t EffectsId = 2;
+static const uint16_t EffectsRate = 20;
+static const uint8_t ResponseHeader[] = { 0xF0, 0x43, 0x10, 0x7F };
+static const uint16_t NumResponseValues = 16;
+
+static uint32_t numFailed = 0;
+
+static uint64_t nanos(void)
+{
+    using namespace std::chrono;
+    return (
+        duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+            .count());
+}
+
+static void addControl(Preset &preset,
+                       uint16_t id,
+                       uint8_t deviceId,
+                       Message::Type type,
+                       uint16_t parameterNumber,
+                       uint16_t midiMax)
+{
+    uint8_t bitWidth = (midiMax > 127) ? 14 : 7;
+
+    preset.controls[id] = Control(id,
+                                  1,
+                                  "Control",
+                                  controlSlotToBounds(id - 1),
+                                  Control::Type::Fader,
+                                  Control::Mode::Default,
+                                  Colours565::white,
+                                  0,
+                                  Control::Variant::Default,
+                                  true);
+
+    Control &control = preset.controls[id];
+
+    control.values.push_back(ControlValue(&control,
+                                          "value",
+                                          0,
+                                          0,
+                                          0,
+                                          midiMax,
+                                          0,
+                                          Message(deviceId,
+                                                  type,
+                                                  parameterNumber,
+                                                  0,
+                                                  midiMax,
+                                                  0,
+                                                  nullptr,
+                                                  false,
+                                                  false,
+                                                  SignMode::noSign,
+                                                  bitWidth,
+                                                  false,
+                                                  RelativeMode::twosComplement,
+                                                  false),
+                                          0,
+                                          0,
+                                          nullptr));
+    control.values[0].message.setControlValue(&control.values[0]);
+}
+
+/*
+ * A synth on channel 1 sends CC 40-55, 14-bit CC 1-4, NRPN 1000-1007 and
+ * SysEx dumps of CC 40-55. An effects unit on channel 2 is rate limited.
+ */
+static void createPreset(Preset &preset)
+{
+    preset.pages[1] = Page(1, "Replay", 0, false);
+    preset.devices.emplace(SynthId, Device(SynthId, "Synth", 0, 1, 0));
+    preset.devices.emplace(EffectsId,
+                           Device(EffectsId, "Effects", 0, 2, EffectsRate));
+
+    Response response;
+
+    response.setId(1);
+    response.headers.assign(ResponseHeader,
+                            ResponseHeader + sizeof(ResponseHeader));
+
+    for (uint16_t i = 0; i < NumResponseValues; i++) {
+        response.rules.push_back(Rule(Message::Type::cc7, 40 + i, i, 0, 0, 7));
+    }
+    preset.devices[SynthId].responses.push_back(response);
+    preset.responseIndex.build(preset.devices);
+
+    uint16_t id = 1;
+
+    for (uint16_t i = 0; i < 16; i++) {
+        addControl(preset, id++, SynthId, Message::Type::cc7, 40 + i, 127);
+    }
+    for (uint16_t i = 1; i <= 4; i++) {
+        addControl(preset, id++, SynthId, Message::Type::cc14, i, 16383);
+    }
+    for (uint16_t i = 0; i < 8; i++) {
+        addControl(preset, id++, SynthId, Message::Type::nrpn, 1000 + i, 16383);
+    }
+    for (uint16_t i = 0; i < 8; i++) {
+        addControl(preset, id++, EffectsId, Message::Type::cc7, 20 + i, 127);
+    }
+}
+
+// Saves the built-in preset as an image next to a placeholder .epr file
+static bool savePreset(const char *filename)
+{
+    Preset preset;
+
+    createPreset(preset);
+
+    File file = Hardware::sdcard.createOutputStream(
+        filename, FILE_WRITE | O_CREAT | O_TRUNC);
+
+    if (!file) {
+        return (false);
+    }
+    file.print("{}");
+    file.close();
+
+    return (PresetCache::save(preset, {}, filename));
+}
+
+static void addInput(std::vector<ReplayEvent> &events,
+                     uint32_t time,
+                     uint8_t status,
+                     uint8_t data1 = 0,
+                     uint8_t data2 = 0)
+{
+    events.push_back(ReplayEvent{
+        time, true, 0, MidiMessage(status, data1, data2), 0, 0 });
+}
+
+static void
+    addSysex(std::vector<ReplayEvent> &events, uint32_t time, uint8_t seed)
+{
+    MemoryBlock block = App::get()->sysexPool.openMemoryBlock();
+    SysexBlock sysexBlock(block);
+
+    sysexBlock.writeBytes(ResponseHeader, sizeof(ResponseHeader));
+
+    for (uint16_t i = 0; i < NumResponseValues; i++) {
+        uint8_t value = (seed + i * 8) & 0x7F;
+        sysexBlock.writeBytes(&value, 1);
+    }
+
+    uint8_t end = 0xF7;
+    sysexBlock.writeBytes(&end, 1);
+    sysexBlock.close();
+
+    events.push_back(
+        ReplayEvent{ time, true, 0, MidiMessage(sysexBlock), 0, 0 });
+}
+
+static void addNrpn(std::vector<ReplayEvent> &events,
+                    uint32_t time,
+                    uint16_t parameterNumber,
+                    uint16_t midiValue)
+{
+    addInput(events, time, 0xB0, 99, parameterNumber >> 7);
+    addInput(events, time, 0xB0, 98, parameterNumber & 0x7F);
+    addInput(events, time, 0xB0, 6, midiValue >> 7);
+    addInput(events, time, 0xB0, 38, midiValue & 0x7F);
+}
+
+static void addChange(std::vector<ReplayEvent> &events,
+                      uint32_t time,
+                      uint16_t midiValue)
+{
+    // Controls 29-36 are the effects parameters
+    events.push_back(ReplayEvent{ time,
+                                  false,
+                                  0,
+                                  MidiMessage(0),
+                                  (uint16_t)(29 + (time / 250000) % 8),
+                                  midiValue });
+}
+
+/*
+ * Four seconds of a synth edited on the controller while the sequencer
+ * runs: clock at 120 BPM, CC every 2 ms, 14-bit CC every 10 ms, NRPN
+ * every 25 ms and a SysEx dump every 100 ms. The effects unit is tweaked
+ * every millisecond, faster than its rate.
+ */
+static std::vector<ReplayEvent> createCapture(void)
+{
+    const uint32_t duration = 4000000;
+    std::vector<ReplayEvent> events;
+
+    addInput(events, 0, 0xFA);
+
+    for (uint32_t time = 0; time < duration; time += 1000) {
+        uint32_t step = time / 1000;
+
+        if (time % 20833 < 1000) {
+            addInput(events, time, 0xF8);
+        }
+        if (step % 2 == 0) {
+            addInput(events, time, 0xB0, 40 + step % 16, step % 128);
+        }
+        if (step % 10 == 0) {
+            uint16_t value = (step * 37) & 0x3FFF;
+            uint8_t parameterNumber = 1 + (step / 10) % 4;
+
+            addInput(events, time, 0xB0, parameterNumber, value >> 7);
+            addInput(events, time, 0xB0, parameterNumber + 32, value & 0x7F);
+        }
+        if (step % 25 == 0) {
+            addNrpn(
+                events, time, 1000 + (step / 25) % 8, (step * 101) & 0x3FFF);
+        }
+        if (step % 100 == 0) {
+            addSysex(events, time, step & 0x7F);
+        }
+        addChange(events, time, step % 128);
+    }
+
+    // Known final values, checked after the replay
+    addSysex(events, duration, 3);
+    addInput(events, duration, 0xB0, 40, 99);
+    addInput(events, duration, 0xB0, 1, 0x24);
+    addInput(events, duration, 0xB0, 33, 0x34);
+    addNrpn(events, duration, 1000, 5000);
+    events.push_back(ReplayEvent{ duration, false, 0, MidiMessage(0), 29, 77 });
+    addInput(events, duration, 0xFC);
+
+    return (events);
+}
+
+static std::vector<ReplayEvent> readCapture(const char *filename)
+{
+    std::vector<ReplayEvent> events;
+    FILE *file = fopen(filename, "r");
+    char line[1024];
+
+    if (!file) {
+        printf("cannot open capture: %s\n", filename);
+        return (events);
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        char *next = line;
+        uint32_t time = strtoul(next, &next, 10);
+
+        while (*next == ' ') {
+            next++;
+        }
+
+        if (strncmp(next, "set", 3) == 0) {
+            uint16_t controlId = strtoul(next + 3, &next, 10);
+            uint16_t midiValue = strtoul(next, &next, 10);
+
+            events.push_back(ReplayEvent{
+                time, false, 0, MidiMessage(0), controlId, midiValue });
+        } else if (strncmp(next, "in", 2) == 0) {
+            uint8_t port = strtoul(next + 2, &next, 10);
+            std::vector<uint8_t> bytes;
+            char *end;
+
+            for (long byte; (byte = strtol(next, &end, 16)), end != next;
+                 next = end) {
+                bytes.push_back(byte);
+            }
+
+            if (bytes.empty()) {
+                continue;
+            }
+            if (bytes[0] == 0xF0) {
+                SysexBlock sysexBlock(App::get()->sysexPool.openMemoryBlock());
+                sysexBlock.writeBytes(bytes.data(), bytes.size());
+                events.push_back(ReplayEvent{
+                    time, true, port, MidiMessage(sysexBlock), 0, 0 });
+            } else {
+                bytes.resize(3);
+                events.push_back(ReplayEvent{
+                    time,
+                    true,
+                    port,
+                    MidiMessage(bytes[0], bytes[1], bytes[2]),
+                    0,
+                    0 });
+            }
+        }
+    }
+    fclose(file);
+
+    return (events);
+}
+
+// Registers the values as Presets::loadPreset() and the ControllerApp do
+static void enablePreset(Preset &preset, Midi &midi)
+{
+    for (auto &[id, control] : preset.controls) {
+        for (auto &value : control.values) {
+            control.setDefaultValue(value, false);
+        }
+    }
+    parameterMap.enable(true);
+
+    parameterMap.onChange = [&midi](LookupEntry *entry, Origin origin) {
+        if (entry) {
+            if (origin != Origin::midi && origin != Origin::file) {
+                Message message = entry->getMessage();
+                message.setValue(entry->getMidiValue());
+                midi.sendMessage(message);
+            }
+        }
+    };
+}
+
+static uint64_t getPercentile(std::vector<uint32_t> &latencies, double rank)
+{
+    if (latencies.empty()) {
+        return (0);
+    }
+
+    size_t index = std::min(latencies.size() - 1,
+                            (size_t)(latencies.size() * rank));
+    std::nth_element(
+        latencies.begin(), latencies.begin() + index, latencies.end());
+    return (latencies[index]);
+}
+
+static void report(const char *label, std::vector<uint32_t> &latencies)
+{
+    printf("%s: %lu, p50=%lu ns, p90=%lu ns, p99=%lu ns, max=%lu ns\n",
+           label,
+           (unsigned long)latencies.size(),
+           (unsigned long)getPercentile(latencies, 0.5),
+           (unsigned long)getPercentile(latencies, 0.9),
+           (unsigned long)getPercentile(latencies, 0.99),
+           (unsigned long)getPercentile(latencies, 1.0));
+}
+
+static void expect(const char *label,
+                   uint8_t deviceId,
+                   Message::Type type,
+                   uint16_t parameterNumber,
+                   uint16_t expectedValue)
+{
+    uint16_t value = parameterMap.getValue(deviceId, type, parameterNumber);
+
+    if (value != expectedValue) {
+        printf("FAIL: %s: parameterNumber=%u, value=%u, expected=%u\n",
+               label,
+               parameterNumber,
+               value,
+               expectedValue);
+        numFailed++;
+    }
+}
+
+static void replay(Preset &preset, const std::vector<ReplayEvent> &events)
+{
+    const uint32_t repaintPeriod = 25000;
+    std::vector<uint32_t> processLatencies;
+    std::vector<uint32_t> changeLatencies;
+    Midi midi(preset);
+
+    enablePreset(preset, midi);
+
+    processLatencies.reserve(events.size());
+    changeLatencies.reserve(events.size());
+    MidiOutput::sentBytes.clear();
+    MidiOutput::sentBytes.reserve(1 << 20);
+
+    uint32_t startTime = micros();
+    uint32_t lastRepaint = startTime;
+    uint64_t replayStartTime = nanos();
+
+    HeapCounter::reset();
+
+    for (const auto &event : events) {
+        int32_t idleTime = (startTime + event.time) - micros();
+
+        if (idleTime > 0) {
+            hostClockOffset += idleTime;
+        }
+
+        if (event.received) {
+            MidiInput midiInput(MidiInterface::Type::MidiIo, event.port);
+            uint64_t processStartTime = nanos();
+
+            midi.process(midiInput, event.midiMessage);
+            processLatencies.push_back(nanos() - processStartTime);
+        } else {
+            const Control &control = preset.getControl(event.controlId);
+
+            if (control.values.empty()) {
+                continue;
+            }
+
+            const Message &message = control.values[0].message;
+            uint64_t changeStartTime = nanos();
+
+            parameterMap.setValue(message.getDeviceId(),
+                                  message.getType(),
+                                  message.getParameterNumber(),
+                                  event.midiValue,
+                                  Origin::internal);
+            changeLatencies.push_back(nanos() - changeStartTime);
+        }
+
+        midi.flushOutput();
+
+        if (micros() - lastRepaint >= repaintPeriod) {
+            InstanceCallback<void(void)>::callback();
+            lastRepaint = micros();
+        }
+    }
+
+    // Let the rate limited messages out, one per device and period
+    for (int round = 0; round < 8; round++) {
+        hostClockOffset += EffectsRate * 1000;
+        midi.flushOutput();
+    }
+    InstanceCallback<void(void)>::callback();
+
+    size_t numAllocations = HeapCounter::numAllocations;
+    size_t allocatedBytes = HeapCounter::allocatedBytes;
+    uint64_t replayTime = nanos() - replayStartTime;
+
+    printf("%lu events replayed in %.1f ms\n",
+           (unsigned long)events.size(),
+           replayTime / 1e6);
+    report("received messages", processLatencies);
+    report("controller changes", changeLatencies);
+    printf("allocations: %lu, %lu bytes, %.2f per event\n",
+           (unsigned long)numAllocations,
+           (unsigned long)allocatedBytes,
+           events.empty() ? 0.0 : (double)numAllocations / events.size());
+    printf("output: %lu bytes\n", (unsigned long)MidiOutput::sentBytes.size());
+}
+
+static void checkReplay(void)
+{
+    const std::vector<uint8_t> &sentBytes = MidiOutput::sentBytes;
+
+    expect("sysex", SynthId, Message::Type::cc7, 41, 3 + 8);
+    expect("sysex", SynthId, Message::Type::cc7, 55, 3 + 15 * 8);
+    expect("cc7", SynthId, Message::Type::cc7, 40, 99);
+    expect("cc14", SynthId, Message::Type::cc14, 1, (0x24 << 7) | 0x34);
+    expect("nrpn", SynthId, Message::Type::nrpn, 1000, 5000);
+    expect("change", EffectsId, Message::Type::cc7, 20, 77);
+
+    // Received messages are not echoed, the effects changes are coalesced
+    uint32_t maxMessages = 4000 / EffectsRate + 2;
+
+    if (sentBytes.empty() || (sentBytes.size() > maxMessages * 3)) {
+        printf("FAIL: output: %lu bytes, expected 1 to %lu messages\n",
+               (unsigned long)sentBytes.size(),
+               (unsigned long)maxMessages);
+        numFailed++;
+    } else if ((sentBytes[sentBytes.size() - 3] != 0xB1)
+               || (sentBytes[sentBytes.size() - 2] != 20)
+               || (sentBytes[sentBytes.size() - 1] != 77)) {
+        printf("FAIL: output: last change not sent\n");
+        numFailed++;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string presetPath = (argc > 1) ? argv[1] : "";
+    std::vector<ReplayEvent> events =
+        (argc > 2) ? readCapture(argv[2]) : createCapture();
+    char directory[] = "/tmp/MidiReplayXXXXXX";
+    const char *presetFilename = "replay.epr";
+
+    if (presetPath.empty()) {
+        if (!mkdtemp(directory)) {
+            printf("cannot create a directory\n");
+            return (1);
+        }
+        Hardware::sdcard.setRoot(directory);
+
+        if (!savePreset(presetFilename)) {
+            printf("cannot save the preset image\n");
+            return (1);
+        }
+    } else {
+        size_t separator = presetPath.find_last_of('/');
+
+        if (separator != std::string::npos) {
+            Hardware::sdcard.setRoot(presetPath.substr(0, separator).c_str());
+            presetPath = presetPath.substr(separator + 1);
+        }
+        presetFilename = presetPath.c_str();
+    }
+
+    Preset preset;
+
+    if (!preset.load(presetFilename)) {
+        printf("cannot load preset: %s (the .epc image is required)\n",
+               presetFilename);
+        return (1);
+    }
+
+    printf("preset: %lu devices, %lu controls\n",
+           (unsigned long)preset.devices.size(),
+           (unsigned long)preset.controls.size());
+
+    replay(preset, events);
+
+    if (argc == 1) {
+        checkReplay();
+
+        PresetCache::invalidate(presetFilename);
+        Hardware::sdcard.deleteFile(presetFilename);
+        rmdir(directory);
+    }
+
+    return ((numFailed == 0) ? 0 : 1);
+}
@@ -0,0 +1,239 @@
+/**
+ * @file OutputQueueReplay.cpp
+ *
+ * @brief Replays knob sweeps through the per-device output queue.
+ *
+ * The sender below follows Midi::sendMessage(), Midi::flushDevice() and
+ * Midi::flushOutput(), with the transmission replaced by a log of the
+ * messages sent to every device. The test checks that the last value of
+ * every parameter reaches the device, that the devices receive no more
+ * messages than their rate allows and that a program change is never
+ * sent ahead of the parameter values queued before it. Heap allocations
+ * of the sender are counted during the sweep, the log of sent messages
+ * is reserved in advance so that it does not contribute.
+ */
+
+#include "HeapCounter.h"
+#include "OutputQueue.h"
+#include <cstdio>
+#include <map>
+
+struct TestDevice {
+    uint8_t id;
+    uint16_t rate;
+};
+
+class Sender
+{
+public:
+    explicit Sender(const std::vector<TestDevice> &newDevices)
+        : devices(newDevices)
+    {
+    }
+
+    void sendMessage(const Message &message, uint32_t now)
+    {
+        const TestDevice &device = getDevice(message.getDeviceId());
+
+        if (!OutputQueue::isCoalescable(message.getType())) {
+            flushDevice(device, now);
+            outputQueue.markSent(device.id, now);
+            transmitMessage(message);
+            return;
+        }
+
+        if (!outputQueue.hasPending(device.id)
+            && outputQueue.isDue(device.id, device.rate, now)) {
+            outputQueue.markSent(device.id, now);
+            transmitMessage(message);
+            return;
+        }
+
+        if (!outputQueue.push(message)) {
+            Message oldest;
+
+            outputQueue.pop(device.id, oldest);
+            outputQueue.markSent(device.id, now);
+            transmitMessage(oldest);
+            outputQueue.push(message);
+        }
+    }
+
+    void flushOutput(uint32_t now)
+    {
+        outputQueue.getPendingDevices(pendingDevices);
+
+        for (const auto &deviceId : pendingDevices) {
+            const TestDevice &device = getDevice(deviceId);
+
+            if (outputQueue.isDue(deviceId, device.rate, now)) {
+                Message message;
+
+                if (outputQueue.pop(deviceId, message)) {
+                    outputQueue.markSent(deviceId, now);
+                    transmitMessage(message);
+                }
+            }
+        }
+    }
+
+    std::map<uint8_t, std::vector<Message>> sent;
+
+private:
+    const TestDevice &getDevice(uint8_t deviceId) const
+    {
+        for (const auto &device : devices) {
+            if (device.id == deviceId) {
+                return (device);
+            }
+        }
+        return (devices.front());
+    }
+
+    void flushDevice(const TestDevice &device, uint32_t now)
+    {
+        Message message;
+
+        while (outputQueue.pop(device.id, message)) {
+            outputQueue.markSent(device.id, now);
+            transmitMessage(message);
+        }
+    }
+
+    void transmitMessage(const Message &message)
+    {
+        sent[message.getDeviceId()].push_back(message);
+    }
+
+    std::vector<TestDevice> devices;
+    OutputQueue outputQueue;
+    std::vector<uint8_t> pendingDevices;
+};
+
+static Message createMessage(uint8_t deviceId,
+                             Message::Type type,
+                             uint16_t parameterNumber,
+                             uint16_t value)
+{
+    Message message;
+
+    message.setDeviceId(deviceId);
+    message.setType(type);
+    message.setParameterNumber(parameterNumber);
+    message.setValue(value);
+
+    return (message);
+}
+
+static uint16_t getLastValue(const std::vector<Message> &messages,
+                             Message::Type type,
+                             uint16_t parameterNumber)
+{
+    uint16_t value = 0xFFFF;
+
+    for (const auto &message : messages) {
+        if ((message.getType() == type)
+            && (message.getParameterNumber() == parameterNumber)) {
+            value = message.getValue();
+        }
+    }
+    return (value);
+}
+
+static bool replaySweep(void)
+{
+    const std::vector<TestDevice> devices = { { 1, 0 }, { 2, 10 }, { 3, 20 } };
+    const uint32_t duration = 1000;
+    Sender sender(devices);
+
+    for (const auto &device : devices) {
+        sender.sent[device.id].reserve(2 * duration);
+    }
+    HeapCounter::reset();
+
+    // Two knobs turned at the same time, every knob emits one value per ms
+    for (uint32_t now = 0; now < duration; now++) {
+        for (const auto &device : devices) {
+            sender.sendMessage(
+                createMessage(device.id, Message::Type::nrpn, 300, now),
+                now);
+            sender.sendMessage(
+                createMessage(device.id, Message::Type::cc7, 7, now % 128),
+                now);
+        }
+        sender.flushOutput(now);
+    }
+    for (uint32_t now = duration; now < duration + 100; now++) {
+        sender.flushOutput(now);
+    }
+
+    printf("sweep: %zu heap allocations, %zu bytes\n",
+           HeapCounter::numAllocations,
+           HeapCounter::allocatedBytes);
+
+    bool passed = true;
+
+    // The queue grows once per device, not with the number of messages
+    if (HeapCounter::numAllocations > 8 * devices.size()) {
+        printf("FAIL: sweep allocates per message\n");
+        passed = false;
+    }
+
+    for (const auto &device : devices) {
+        const auto &messages = sender.sent[device.id];
+        uint32_t maxMessages =
+            device.rate ? (duration + 100) / device.rate + 1 : 2 * duration;
+
+        printf("device %d, rate=%3dms: %4zu of %lu messages sent\n",
+               device.id,
+               device.rate,
+               messages.size(),
+               (unsigned long)(2 * duration));
+
+        if (messages.size() > maxMessages) {
+            printf("FAIL: device %d: rate exceeded\n", device.id);
+            passed = false;
+        }
+        if ((getLastValue(messages, Message::Type::nrpn, 300) != duration - 1)
+            || (getLastValue(messages, Message::Type::cc7, 7)
+                != (duration - 1) % 128)) {
+            printf("FAIL: device %d: final value not sent\n", device.id);
+            passed = false;
+        }
+    }
+    return (passed);
+}
+
+static bool replayProgramChange(void)
+{
+    Sender sender({ { 1, 50 } });
+
+    for (uint16_t value = 0; value < 10; value++) {
+        sender.sendMessage(createMessage(1, Message::Type::nrpn, 300, value),
+                           value);
+        sender.sendMessage(createMessage(1, Message::Type::cc7, 7, value),
+                           value);
+    }
+    sender.sendMessage(createMessage(1, Message::Type::program, 0, 5), 10);
+
+    const auto &messages = sender.sent[1];
+
+    if (messages.empty()
+        || (messages.back().getType() != Message::Type::program)
+        || (getLastValue(messages, Message::Type::nrpn, 300) != 9)
+        || (getLastValue(messages, Message::Type::cc7, 7) != 9)) {
+        printf("FAIL: program change overtook queued parameter values\n");
+        return (false);
+    }
+    printf("program change: sent after %zu queued messages\n",
+           messages.size() - 1);
+    return (true);
+}
+
+int main(void)
+{
+    bool passed = replaySweep();
+    passed = replayProgramChange() && passed;
+
+    return (passed ? 0 : 1);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file OverlayBenchmark.cpp
+ *
+ * @brief Compares the overlay value index with the linear ListData search.
+ *
+ * Random overlays with 7-bit, wide and negative values check that
+ * findIndexByValue() returns the same index as the linear search, before
+ * and after the index is built, and after items were added to an indexed
+ * overlay. A 512-item overlay is then used to time both lookups over
+ * hits and misses.
+ */
+
+#include "Arduino.h"
+#include "Overlay.h"
+#include <cstdio>
+#include <random>
+
+static uint32_t numFailed = 0;
+
+static void compareLookups(const Overlay &overlay)
+{
+    for (int16_t value = -200; value < 4200; value++) {
+        if (overlay.findIndexByValue(value)
+            != overlay.getIndexByValue(value)) {
+            if (numFailed++ < 10) {
+                printf("FAIL: overlay of %u items: value=%d\n",
+                       overlay.getNumItems(),
+                       value);
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    std::mt19937 random(1);
+
+    for (int trial = 0; trial < 200; trial++) {
+        Overlay overlay(1);
+        uint16_t numItems = random() % 600 + 1;
+        int16_t span = (trial % 2) ? 128 : 4000;
+        int16_t offset = (trial % 4 == 3) ? -100 : 0;
+
+        for (uint16_t i = 0; i < numItems; i++) {
+            overlay.addItem(random() % span + offset, "", nullptr);
+        }
+        compareLookups(overlay);
+
+        overlay.buildIndex();
+        compareLookups(overlay);
+
+        overlay.addItem(random() % span + offset, "", nullptr);
+        compareLookups(overlay);
+    }
+
+    const uint16_t numItems = 512;
+    const int16_t maxValue = numItems * 3;
+    const int rounds = 2000;
+    volatile int32_t sum = 0;
+    Overlay overlay(1);
+
+    for (uint16_t i = 0; i < numItems; i++) {
+        overlay.addItem(i * 3, "", nullptr);
+    }
+
+    uint32_t startTime = micros();
+    for (int round = 0; round < rounds; round++) {
+        for (int16_t value = 0; value < maxValue; value++) {
+            sum += overlay.getIndexByValue(value);
+        }
+    }
+    uint32_t linearTime = micros() - startTime;
+
+    overlay.buildIndex();
+
+    startTime = micros();
+    for (int round = 0; round < rounds; round++) {
+        for (int16_t value = 0; value < maxValue; value++) {
+            sum += overlay.findIndexByValue(value);
+        }
+    }
+    uint32_t indexedTime = micros() - startTime;
+
+    printf("%u items, lookups of %d values, one in three found\n",
+           numItems,
+           maxValue);
+    printf("linear:  %6.1f ns/lookup\n",
+           linearTime * 1000.0 / ((double)maxValue * rounds));
+    printf("indexed: %6.1f ns/lookup\n",
+           indexedTime * 1000.0 / ((double)maxValue * rounds));
+
+    return ((numFailed == 0) ? 0 : 1);
+}
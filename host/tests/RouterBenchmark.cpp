@@ -0,0 +1,171 @@
+/**
+ * @file RouterBenchmark.cpp
+ *
+ * @brief Measures the per-message routing decision of MidiRouter.
+ *
+ * The former routeMessage walked an if-chain over the route flags for
+ * every message, it is replicated below. The current one looks up the
+ * compiled route mask of the source interface and applies the message
+ * filters. Both return the destination mask; the sending itself is not
+ * part of the measurement. The test fails when the two disagree with
+ * the filters disabled, or when the filters let a dropped message pass.
+ */
+
+#include "Arduino.h"
+#include "Config/Router.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+struct TestMessage {
+    Router::Interface source;
+    uint8_t status;
+    uint8_t channel;
+};
+
+// The former MidiRouter::routeMessage branches
+static uint8_t __attribute__((noinline))
+    routeBefore(const Router &router, const TestMessage &message)
+{
+    uint8_t destinations = 0;
+
+    if (message.source == Router::UsbDev) {
+        if (router.usbDevToMidiIo) {
+            destinations |= (1 << Router::MidiIo);
+        }
+        if (router.usbDevToUsbHost) {
+            destinations |= (1 << Router::UsbHost);
+        }
+    }
+
+    if (message.source == Router::MidiIo) {
+        if (router.midiIoToUsbDev) {
+            destinations |= (1 << Router::UsbDev);
+        }
+        if (router.midiIoToUsbHost) {
+            destinations |= (1 << Router::UsbHost);
+        }
+    }
+
+    if (message.source == Router::UsbHost) {
+        if (router.usbHostToMidiIo) {
+            destinations |= (1 << Router::MidiIo);
+        }
+        if (router.usbHostToUsbDev) {
+            destinations |= (1 << Router::UsbDev);
+        }
+    }
+
+    return (destinations);
+}
+
+// The current MidiRouter::routeMessage decision
+static uint8_t __attribute__((noinline))
+    routeAfter(const Router &router, const TestMessage &message)
+{
+    uint8_t routes = router.getRoutes(message.source);
+
+    if ((routes == 0) || !router.isAllowed(message.status, message.channel)) {
+        return (0);
+    }
+    return (routes);
+}
+
+static std::vector<TestMessage> createTraffic(uint32_t numMessages)
+{
+    static const uint8_t statuses[] = { 0x90, 0x80, 0xB0, 0xB0, 0xB0,
+                                        0xE0, 0xF8, 0xF8, 0xF8, 0xFE };
+    std::mt19937 random(1);
+    std::vector<TestMessage> messages;
+
+    messages.reserve(numMessages);
+
+    for (uint32_t i = 0; i < numMessages; i++) {
+        messages.push_back(
+            TestMessage{ (Router::Interface)(random() % Router::NumInterfaces),
+                         statuses[random() % sizeof(statuses)],
+                         (uint8_t)(random() % 16 + 1) });
+    }
+    return (messages);
+}
+
+static uint32_t measure(uint8_t (*route)(const Router &, const TestMessage &),
+                        const Router &router,
+                        const std::vector<TestMessage> &messages,
+                        uint32_t &numRouted)
+{
+    const int rounds = 20;
+    uint32_t startTime = micros();
+
+    numRouted = 0;
+
+    for (int round = 0; round < rounds; round++) {
+        for (const auto &message : messages) {
+            numRouted += (route(router, message) != 0);
+        }
+    }
+    return (micros() - startTime);
+}
+
+int main(void)
+{
+    const uint32_t numMessages = 100000;
+    const int rounds = 20;
+    std::vector<TestMessage> messages = createTraffic(numMessages);
+    bool passed = true;
+
+    Router router;
+    router.midiIoToUsbHost = false;
+    router.compile();
+
+    for (const auto &message : messages) {
+        if (routeBefore(router, message) != routeAfter(router, message)) {
+            printf("FAIL: routes differ: source=%d, status=%02X\n",
+                   message.source,
+                   message.status);
+            passed = false;
+            break;
+        }
+    }
+
+    uint32_t routedBefore = 0;
+    uint32_t routedAfter = 0;
+    uint32_t timeBefore = measure(routeBefore, router, messages, routedBefore);
+    uint32_t timeAfter = measure(routeAfter, router, messages, routedAfter);
+
+    printf("if-chain:       %5.1f ns/message, %lu routed\n",
+           timeBefore * 1000.0 / ((double)numMessages * rounds),
+           (unsigned long)routedBefore);
+    printf("compiled table: %5.1f ns/message, %lu routed\n",
+           timeAfter * 1000.0 / ((double)numMessages * rounds),
+           (unsigned long)routedAfter);
+
+    // Thru traffic without clock and limited to channels 1 and 10
+    router.dropClock = true;
+    router.dropActiveSensing = true;
+    router.channelMask = (1 << 0) | (1 << 9);
+
+    uint32_t routedFiltered = 0;
+    uint32_t timeFiltered =
+        measure(routeAfter, router, messages, routedFiltered);
+
+    printf("with filters:   %5.1f ns/message, %lu routed\n",
+           timeFiltered * 1000.0 / ((double)numMessages * rounds),
+           (unsigned long)routedFiltered);
+
+    for (const auto &message : messages) {
+        bool dropped = (message.status == Router::StatusClock)
+                       || (message.status == Router::StatusActiveSensing)
+                       || ((message.channel != 1) && (message.channel != 10));
+
+        if (dropped && routeAfter(router, message)) {
+            printf("FAIL: filtered message routed: status=%02X, channel=%d\n",
+                   message.status,
+                   message.channel);
+            passed = false;
+            break;
+        }
+    }
+
+    return (passed ? 0 : 1);
+}
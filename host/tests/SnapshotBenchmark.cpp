@@ -0,0 +1,184 @@
+/**
+ * @file SnapshotBenchmark.cpp
+ *
+ * @brief Measures the snapshot save and recall of ParameterMap.
+ *
+ * A map of CC, 14-bit CC and NRPN parameters of several devices is saved
+ * with saveSnapshot() and recalled with loadChanges(), as Snapshots does,
+ * in a temporary directory standing in for the SD card. The recall must
+ * restore every value and report each changed entry once. The JSON form
+ * sent to the editor is timed with exportSnapshot(); JSON snapshots are
+ * not parsed on the host, so the former recall is not measured.
+ */
+
+#include "HeapCounter.h"
+#include "ParameterMap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct Parameter {
+    uint8_t deviceId;
+    Message::Type type;
+    uint16_t parameterNumber;
+};
+
+static uint32_t numFailed = 0;
+
+static std::vector<Parameter> createParameters(void)
+{
+    std::vector<Parameter> parameters;
+
+    for (uint8_t deviceId = 1; deviceId <= 8; deviceId++) {
+        for (uint16_t i = 0; i < 128; i++) {
+            parameters.push_back(Parameter{ deviceId, Message::Type::cc7, i });
+        }
+        for (uint16_t i = 0; i < 32; i++) {
+            parameters.push_back(Parameter{ deviceId, Message::Type::cc14, i });
+        }
+        for (uint16_t i = 0; i < 96; i++) {
+            parameters.push_back(
+                Parameter{ deviceId, Message::Type::nrpn, (uint16_t)(i * 7) });
+        }
+    }
+    return (parameters);
+}
+
+static uint16_t getMidiValue(const Parameter &parameter, uint16_t seed)
+{
+    uint16_t maxValue = (parameter.type == Message::Type::cc7) ? 127 : 16383;
+    return ((parameter.parameterNumber * 31 + parameter.deviceId + seed)
+            % (maxValue + 1));
+}
+
+static void setValues(const std::vector<Parameter> &parameters, uint16_t seed)
+{
+    for (const auto &parameter : parameters) {
+        LookupEntry *entry = parameterMap.getOrCreate(
+            parameter.deviceId, parameter.type, parameter.parameterNumber);
+
+        parameterMap.setValue(
+            entry, getMidiValue(parameter, seed), Origin::internal);
+    }
+}
+
+static void checkValues(const std::vector<Parameter> &parameters,
+                        uint16_t seed)
+{
+    for (const auto &parameter : parameters) {
+        uint16_t value = parameterMap.getValue(
+            parameter.deviceId, parameter.type, parameter.parameterNumber);
+
+        if (value != getMidiValue(parameter, seed)) {
+            if (numFailed++ < 10) {
+                printf("FAIL: not recalled: device=%u, type=%u, "
+                       "parameterNumber=%u, value=%u\n",
+                       parameter.deviceId,
+                       (unsigned)parameter.type,
+                       parameter.parameterNumber,
+                       value);
+            }
+        }
+    }
+}
+
+static long getFileSize(const char *directory, const char *filename)
+{
+    std::string path = std::string(directory) + "/" + filename;
+    FILE *file = fopen(path.c_str(), "rb");
+    long size = -1;
+
+    if (file) {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fclose(file);
+    }
+    return (size);
+}
+
+int main(void)
+{
+    const int rounds = 200;
+    const char *snapshotFilename = "snapshot.snp";
+    const char *jsonFilename = "snapshot.json";
+    char directory[] = "/tmp/SnapshotBenchmarkXXXXXX";
+    std::vector<Parameter> parameters = createParameters();
+    std::vector<LookupEntry *> changedEntries;
+
+    if (!mkdtemp(directory)) {
+        printf("cannot create a directory\n");
+        return (1);
+    }
+    Hardware::sdcard.setRoot(directory);
+
+    parameterMap.setProjectId("benchmark");
+    setValues(parameters, 0);
+
+    if (!parameterMap.saveSnapshot(snapshotFilename)
+        || !ParameterMap::isSnapshotImage(snapshotFilename)) {
+        printf("FAIL: snapshot not saved\n");
+        return (1);
+    }
+
+    // Every value differs from the snapshot before the recall
+    setValues(parameters, 1);
+    changedEntries.reserve(parameters.size());
+
+    uint16_t numEntries =
+        parameterMap.loadChanges(snapshotFilename, changedEntries);
+    checkValues(parameters, 0);
+
+    if ((numEntries != parameters.size())
+        || (changedEntries.size() != parameters.size())) {
+        printf("FAIL: recall: %u entries, %lu changed, expected %lu\n",
+               numEntries,
+               (unsigned long)changedEntries.size(),
+               (unsigned long)parameters.size());
+        numFailed++;
+    }
+
+    HeapCounter::reset();
+    uint32_t startTime = micros();
+
+    for (int round = 0; round < rounds; round++) {
+        parameterMap.saveSnapshot(snapshotFilename);
+    }
+    uint32_t saveTime = micros() - startTime;
+    size_t saveAllocations = HeapCounter::numAllocations;
+
+    HeapCounter::reset();
+    startTime = micros();
+
+    for (int round = 0; round < rounds; round++) {
+        parameterMap.loadChanges(snapshotFilename, changedEntries);
+    }
+    uint32_t recallTime = micros() - startTime;
+    size_t recallAllocations = HeapCounter::numAllocations;
+
+    startTime = micros();
+
+    for (int round = 0; round < rounds; round++) {
+        ParameterMap::exportSnapshot(snapshotFilename, jsonFilename);
+    }
+    uint32_t exportTime = micros() - startTime;
+
+    printf("%lu parameters, snapshot of %ld bytes, JSON of %ld bytes\n",
+           (unsigned long)parameters.size(),
+           getFileSize(directory, snapshotFilename),
+           getFileSize(directory, jsonFilename));
+    printf("save:        %7.1f us, %lu allocations\n",
+           (double)saveTime / rounds,
+           (unsigned long)(saveAllocations / rounds));
+    printf("recall:      %7.1f us, %lu allocations\n",
+           (double)recallTime / rounds,
+           (unsigned long)(recallAllocations / rounds));
+    printf("JSON export: %7.1f us\n", (double)exportTime / rounds);
+
+    Hardware::sdcard.deleteFile(snapshotFilename);
+    Hardware::sdcard.deleteFile(jsonFilename);
+    rmdir(directory);
+
+    return ((numFailed == 0) ? 0 : 1);
+}
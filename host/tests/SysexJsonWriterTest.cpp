@@ -0,0 +1,87 @@
+/**
+ * @file SysexJsonWriterTest.cpp
+ *
+ * @brief Streams a full snapshot list through SysexJsonWriter.
+ *
+ * The list is written the way Snapshots::sendList writes it, for all 432
+ * snapshot slots. The test checks the SysEx framing, that every data byte
+ * is 7-bit and that the message goes out in full buffers. The former
+ * sendList sent one transfer per record.
+ */
+
+#include "SysexJsonWriter.h"
+#include <cstdio>
+#include <string>
+
+int main(void)
+{
+    const uint16_t numSnapshots = 432;
+    SysexJsonWriter writer(0, ElectraCommand::Object::SnapshotList);
+
+    writer.write("{\"version\":1,\"projectId\":");
+    writer.writeString("host-test");
+    writer.write(",\"snapshots\":[");
+
+    for (uint16_t i = 0; i < numSnapshots; i++) {
+        writer.write((i == 0) ? "{\"slot\":" : ",{\"slot\":");
+        writer.writeInteger(i % 36);
+        writer.write(",\"bankNumber\":");
+        writer.writeInteger(i / 36);
+        writer.write(",\"name\":");
+        // quotes, backslashes, control and 8-bit characters are escaped
+        writer.writeString("Snap \"1\" \\\x01\xe9");
+        writer.write(",\"color\":\"");
+        writer.writeHex(0xF45C51, 6);
+        writer.write("\"}");
+    }
+
+    writer.write("]}");
+    writer.end();
+
+    const auto &bytes = MidiOutput::sentBytes;
+    bool passed = true;
+
+    printf("records: %d, length: %lu bytes, transfers: %d (was %d)\n",
+           numSnapshots,
+           (unsigned long)writer.getLength(),
+           writer.getNumTransfers(),
+           numSnapshots + 2);
+
+    if ((bytes.size() != writer.getLength())
+        || (writer.getNumTransfers() != MidiOutput::numTransfers)) {
+        printf("FAIL: writer statistics do not match the output\n");
+        passed = false;
+    }
+
+    if ((bytes.size() < 8) || (bytes.front() != 0xf0)
+        || (bytes.back() != 0xf7)) {
+        printf("FAIL: invalid SysEx framing\n");
+        return (1);
+    }
+
+    for (size_t i = 1; i < bytes.size() - 1; i++) {
+        if (bytes[i] & 0x80) {
+            printf("FAIL: 8-bit data byte at %zu\n", i);
+            passed = false;
+            break;
+        }
+    }
+
+    std::string json(bytes.begin() + 6, bytes.end() - 1);
+
+    if (json.find("\"name\":\"Snap \\\"1\\\" \\\\\\u0001?\"")
+        == std::string::npos) {
+        printf("FAIL: string not escaped: %s\n", json.substr(0, 120).c_str());
+        passed = false;
+    }
+
+    uint32_t maxTransfers = (writer.getLength() + 383) / 384;
+
+    if (writer.getNumTransfers() > maxTransfers) {
+        printf("FAIL: more transfers than full buffers: %d\n",
+               writer.getNumTransfers());
+        passed = false;
+    }
+
+    return (passed ? 0 : 1);
+}
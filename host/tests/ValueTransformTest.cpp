@@ -0,0 +1,164 @@
+/**
+ * @file ValueTransformTest.cpp
+ *
+ * @brief Compares ValueTransform with the float value translation.
+ *
+ * Every transform must return exactly the values of
+ * translateMidiValueToValue() and translateValueToMidiValue(), including
+ * for the values just outside of the ranges. The ranges cover the offset
+ * and the lookup table translations as well as the float fallback.
+ * Shared transforms are checked past the limit of the lookup tables.
+ */
+
+#include "ValueTransform.h"
+#include <cstdio>
+
+static uint32_t numChecked = 0;
+static uint32_t numFailed = 0;
+
+static void reportFailure(const char *direction,
+                          SignMode signMode,
+                          int16_t minValue,
+                          int16_t maxValue,
+                          uint16_t midiMin,
+                          uint16_t midiMax,
+                          int32_t input)
+{
+    if (numFailed++ < 10) {
+        printf("FAIL: %s: signMode=%d, range=%d..%d, midi=%u..%u, in=%ld\n",
+               direction,
+               (int)signMode,
+               minValue,
+               maxValue,
+               midiMin,
+               midiMax,
+               (long)input);
+    }
+}
+
+static void check(SignMode signMode,
+                  uint8_t bitWidth,
+                  int16_t minValue,
+                  int16_t maxValue,
+                  uint16_t midiMin,
+                  uint16_t midiMax)
+{
+    ValueTransform transform(
+        signMode, bitWidth, minValue, maxValue, midiMin, midiMax);
+
+    for (int32_t midiValue = (midiMin > 2) ? midiMin - 2 : 0;
+         midiValue <= midiMax + 2;
+         midiValue++) {
+        numChecked++;
+
+        if (transform.toValue(midiValue)
+            != translateMidiValueToValue(signMode,
+                                         bitWidth,
+                                         midiValue,
+                                         midiMin,
+                                         midiMax,
+                                         minValue,
+                                         maxValue)) {
+            reportFailure("toValue",
+                          signMode,
+                          minValue,
+                          maxValue,
+                          midiMin,
+                          midiMax,
+                          midiValue);
+        }
+    }
+
+    for (int32_t value = minValue - 2; value <= maxValue + 2; value++) {
+        numChecked++;
+
+        if (transform.toMidiValue(value)
+            != translateValueToMidiValue(signMode,
+                                         bitWidth,
+                                         value,
+                                         minValue,
+                                         maxValue,
+                                         midiMin,
+                                         midiMax)) {
+            reportFailure("toMidiValue",
+                          signMode,
+                          minValue,
+                          maxValue,
+                          midiMin,
+                          midiMax,
+                          value);
+        }
+    }
+}
+
+int main(void)
+{
+    // Small ranges, translated with offsets and lookup tables
+    for (int16_t minValue = -70; minValue <= 10; minValue += 3) {
+        for (int16_t maxValue = minValue + 1; maxValue <= minValue + 150;
+             maxValue++) {
+            for (uint16_t midiMin = 0; midiMin <= 4; midiMin += 2) {
+                for (uint16_t midiMax = midiMin + 1; midiMax <= 150;
+                     midiMax += 3) {
+                    check(SignMode::noSign,
+                          7,
+                          minValue,
+                          maxValue,
+                          midiMin,
+                          midiMax);
+                }
+            }
+        }
+    }
+
+    // 14-bit ranges and ranges left to the float translation
+    check(SignMode::noSign, 14, 0, 16383, 0, 16383);
+    check(SignMode::noSign, 14, -8192, 8191, 0, 16383);
+    check(SignMode::noSign, 14, 0, 127, 0, 16383);
+    check(SignMode::noSign, 14, 0, 16383, 0, 127);
+    check(SignMode::noSign, 14, -100, 100, 0, 16383);
+    check(SignMode::noSign, 14, -1000, 1000, 0, 8000);
+
+    // Signed values are never scaled
+    check(SignMode::twosComplement, 7, -64, 63, 0, 127);
+    check(SignMode::signBit, 7, -63, 63, 0, 127);
+    check(SignMode::twosComplement, 14, -8192, 8191, 0, 16383);
+
+    // Transforms past the table limit are still created and shared
+    ValueTransform::clear();
+
+    for (int16_t maxValue = 1; maxValue <= 100; maxValue++) {
+        const ValueTransform *transform =
+            ValueTransform::get(SignMode::noSign, 7, 0, maxValue, 0, 127);
+
+        if (!transform
+            || (ValueTransform::get(SignMode::noSign, 7, 0, maxValue, 0, 127)
+                != transform)) {
+            printf("FAIL: transform not shared: maxValue=%d\n", maxValue);
+            numFailed++;
+            continue;
+        }
+
+        for (uint16_t midiValue = 0; midiValue <= 127; midiValue++) {
+            numChecked++;
+
+            if (transform->toValue(midiValue)
+                != translateMidiValueToValue(
+                    SignMode::noSign, 7, midiValue, 0, 127, 0, maxValue)) {
+                reportFailure("shared toValue",
+                              SignMode::noSign,
+                              0,
+                              maxValue,
+                              0,
+                              127,
+                              midiValue);
+            }
+        }
+    }
+
+    printf("%lu translations checked, %lu differ\n",
+           (unsigned long)numChecked,
+           (unsigned long)numFailed);
+
+    return ((numFailed == 0) ? 0 : 1);
+}
@@ -3,6 +3,7 @@
 #include "ArduinoJson.h"
 #include "MidiOutput.h"
 #include "SubscribedEvents.h"
+#include "ControllerLog.h"
 
 SysexApi::SysexApi(MainDelegate &newDelegate) : delegate(newDelegate)
 {
@@ -87,6 +88,7 @@ bool SysexApi::process(uint8_t port, const SysexBlock &sysexBlock)
     } else if (cmd.isSystemCall()) {
         System::logger.write(LOG_ERROR,
                              "SysexApi::process: application system call");
+        runSystemCall(port, cmd.getByte1());
     } else {
         System::logger.write(LOG_ERROR,
                              "SysexApi::process: unknown sysex request");
@@ -198,6 +200,23 @@ void SysexApi::switchPreset(uint8_t port, uint8_t bankNumber, uint8_t slot)
     MidiOutput::sendAck(MidiInterface::Type::MidiUsbDev, port);
 }
 
+void SysexApi::runSystemCall(uint8_t port, uint8_t call)
+{
+    if (call == SystemCall::PrintCounters) {
+        ControllerLog::printCounters();
+    } else if (call == SystemCall::ResetCounters) {
+        ControllerLog::printCounters();
+        ControllerLog::resetCounters();
+    } else {
+        System::logger.write(LOG_ERROR,
+                             "SysexApi::runSystemCall: unknown call: %d",
+                             call);
+        MidiOutput::sendNack(MidiInterface::Type::MidiUsbDev, port);
+        return;
+    }
+    MidiOutput::sendAck(MidiInterface::Type::MidiUsbDev, port);
+}
+
 void SysexApi::switchPage(uint8_t port, uint8_t pageNumber)
 {
     System::logger.write(LOG_ERROR,
@@ -14,6 +14,9 @@ public:
         process(uint8_t port, LocalFile &file, ElectraCommand::Object fileType);
 
 private:
+    // Application system calls, selected by the first byte of the command
+    enum SystemCall : uint8_t { PrintCounters = 0, ResetCounters = 1 };
+
     bool loadPreset(uint8_t port, LocalFile &file);
     bool loadLua(uint8_t port, LocalFile &file);
     bool loadConfig(uint8_t port, LocalFile &file);
@@ -44,6 +47,7 @@ private:
     void setControlPort(uint8_t port, uint8_t newControlPort);
     void subscribeEvents(uint8_t port, uint8_t newEvents);
     uint8_t getControlPort(void);
+    void runSystemCall(uint8_t port, uint8_t call);
 
     MainDelegate &delegate;
 };
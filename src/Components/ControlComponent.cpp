@@ -250,12 +250,6 @@ uint16_t ControlComponent::calculateAbsoluteMidiValue(int16_t newDisplayValue,
 {
     uint16_t midiValue = 0;
     newDisplayValue = constrain(newDisplayValue, cv.getMin(), cv.getMax());
-    midiValue = translateValueToMidiValue(cv.message.getSignMode(),
-                                          cv.message.getBitWidth(),
-                                          newDisplayValue,
-                                          cv.getMin(),
-                                          cv.getMax(),
-                                          cv.message.getMidiMin(),
-                                          cv.message.getMidiMax());
+    midiValue = cv.translateToMidiValue(newDisplayValue);
     return (midiValue);
 }
\ No newline at end of file
@@ -27,7 +27,6 @@ FaderControl::FaderControl(const Control &control, MainDelegate &newDelegate)
 
     setMinimum(controlValue.getMin());
     setMaximum(controlValue.getMax());
-    list.assignListData(controlValue.getOverlay());
     updateValueFromParameterMap();
 }
 
@@ -36,7 +35,6 @@ void FaderControl::syncComponentProperties(void)
     const auto &controlValue = control.getValue(0);
     setMinimum(controlValue.getMin());
     setMaximum(controlValue.getMax());
-    list.assignListData(controlValue.getOverlay());
     setNumValues(controlValue.getNumSteps());
     ControlComponent::syncComponentProperties();
 }
@@ -115,7 +113,7 @@ void FaderControl::paint(Graphics &g)
                value.getMin(),
                value.getMax(),
                value.get(),
-               list.getList(),
+               control.getValue(0).getOverlay(),
                control.getMode(),
                control.getVariant());
 
@@ -135,7 +133,7 @@ void FaderControl::paintFader(Graphics &g,
                               int16_t min,
                               int16_t max,
                               int16_t val,
-                              const ListData *items,
+                              const Overlay *items,
                               Control::Mode mode,
                               Control::Variant variant)
 {
@@ -218,21 +216,27 @@ void FaderControl::paintValueFixed(Graphics &g,
                                    const Rectangle &bounds,
                                    uint32_t colour,
                                    int16_t val,
-                                   const ListData *items,
+                                   const Overlay *items,
                                    [[maybe_unused]] Control::Mode mode,
                                    [[maybe_unused]] Control::Variant variant)
 {
     uint16_t labelYPosition = 0;
+    int16_t index = -1;
+
+    // Look the value up once, through the overlay index
+    if (items) {
+        index = items->findIndexByValue(val);
+    }
 
     // Print the label text / Bitmap if exists
-    if (items && !items->getByValue(val).isBitmapEmpty()) {
+    if ((index >= 0) && !items->getByIndex(index).isBitmapEmpty()) {
         uint16_t paddingBitmap = ((bounds.getWidth() - BITMAP_WIDTH)) / 2 - 1;
-        items->getByValue(val).paintBitmap(paddingBitmap, 0, colour);
-    } else if (items && !items->getByValue(val).isLabelEmpty()) {
+        items->getByIndex(index).paintBitmap(paddingBitmap, 0, colour);
+    } else if ((index >= 0) && !items->getByIndex(index).isLabelEmpty()) {
         g.setColour(Colours565::white);
         g.printText(0,
                     0,
-                    items->getByValue(val).getLabel(),
+                    items->getByIndex(index).getLabel(),
                     TextStyle::mediumTransparent,
                     bounds.getWidth(),
                     TextAlign::center);
@@ -261,7 +265,7 @@ void FaderControl::paintValueFloating(Graphics &g,
                                       [[maybe_unused]] uint32_t colour,
                                       uint16_t x,
                                       int16_t val,
-                                      [[maybe_unused]] const ListData *items,
+                                      [[maybe_unused]] const Overlay *items,
                                       [[maybe_unused]] Control::Mode mode,
                                       [[maybe_unused]] Control::Variant variant)
 {
@@ -31,7 +31,6 @@
 #include "Control.h"
 #include "ControlComponent.h"
 #include "BarHorizontal.h"
-#include "AssignableList.h"
 
 class FaderControl : public ControlComponent, public BarHorizontal
 {
@@ -50,8 +49,6 @@ public:
                                    uint8_t handle = 0) override;
     void paint(Graphics &g) override;
 
-    AssignableList list;
-
 private:
     void paintFader(Graphics &g,
                     const Rectangle &bounds,
@@ -59,7 +56,7 @@ private:
                     int16_t min,
                     int16_t max,
                     int16_t val,
-                    const ListData *items,
+                    const Overlay *items,
                     Control::Mode mode,
                     Control::Variant variant);
 
@@ -67,7 +64,7 @@ private:
                          const Rectangle &bounds,
                          uint32_t colour,
                          int16_t val,
-                         const ListData *items,
+                         const Overlay *items,
                          Control::Mode mode,
                          Control::Variant variant);
 
@@ -76,7 +73,7 @@ private:
                             uint32_t colour,
                             uint16_t x,
                             int16_t val,
-                            const ListData *items,
+                            const Overlay *items,
                             Control::Mode mode,
                             Control::Variant variant);
     bool isColorTooBright(uint16_t color, float brightnessThreshold);
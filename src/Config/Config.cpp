@@ -3,12 +3,14 @@
 #include "Hardware.h"
 #include "System.h"
 #include "JsonTools.h"
+#include "JsonStream.h"
+#include <algorithm>
 
 /** Config contructor
  *  an object that keeps information about the Electra base system settings that
  *  can be adjusted by the user
  */
-Config::Config()
+Config::Config() : loadedSections(0)
 {
 }
 
@@ -19,10 +21,32 @@ bool Config::load(void)
 
 bool Config::load(const char *filename)
 {
-    File file;
-
     System::logger.write(LOG_INFO, "Config::load: file: filename=%s", filename);
 
+    bool changeSet = false;
+
+    return (open(filename, false, changeSet));
+}
+
+/** Load an uploaded configuration.
+ *  An upload whose first root member is "merge": true is a change set,
+ *  only the sections present in it are replaced. Other uploads are
+ *  complete configurations and replace the current one.
+ */
+bool Config::loadUpload(const char *filename, bool &changeSet)
+{
+    System::logger.write(
+        LOG_INFO, "Config::loadUpload: file: filename=%s", filename);
+
+    return (open(filename, true, changeSet));
+}
+
+bool Config::open(const char *filename,
+                  bool acceptChangeSet,
+                  bool &changeSet)
+{
+    File file;
+
     file = Hardware::sdcard.createInputStream(filename);
 
     if (!file) {
@@ -33,7 +57,7 @@ bool Config::load(const char *filename)
 
     file.setTimeout(100);
 
-    if (!parse(file)) {
+    if (!parse(file, acceptChangeSet, changeSet)) {
         System::logger.write(LOG_ERROR,
                              "Config::load: cannot parse setup: filename=%s",
                              filename);
@@ -46,13 +70,69 @@ bool Config::load(const char *filename)
     return (true);
 }
 
-bool Config::parse(File &file)
+/** Parse the configuration in one pass over its root object.
+ *  When acceptChangeSet is set and the first member marks the file as
+ *  a change set, sections missing in the file keep their current values.
+ *  Otherwise they are reset to the defaults.
+ */
+bool Config::parse(File &file, bool acceptChangeSet, bool &changeSet)
 {
-    parseRouter(file);
-    parsePresetBanks(file);
-    parseUsbHostAssigments(file);
-    parseMidiControl(file);
-    parseUiFeatures(file);
+    char key[MaxKeyLength + 1];
+
+    loadedSections = 0;
+    changeSet = false;
+
+    if (file.seek(0) == false) {
+        System::logger.write(LOG_ERROR, "Config::parse: cannot rewind the file");
+        return (false);
+    }
+
+    bool hasKey = JsonStream::readKey(file, key, MaxKeyLength);
+
+    if (acceptChangeSet && hasKey && (strcmp(key, ChangeSetKey) == 0)) {
+        changeSet = JsonStream::readBoolean(file);
+        hasKey = JsonStream::readKey(file, key, MaxKeyLength);
+    }
+
+    if (!changeSet) {
+        router = Router();
+        resetPresetBanks();
+        usbHostAssigments.clear();
+        midiControls.clear();
+        resetUiFeatures();
+    }
+
+    for (; hasKey; hasKey = JsonStream::readKey(file, key, MaxKeyLength)) {
+        uint8_t section = translateSection(key);
+        bool success = true;
+
+        if (section == SectionRouter) {
+            success = parseRouter(file);
+        } else if (section == SectionPresetBanks) {
+            success = parsePresetBanks(file);
+        } else if (section == SectionUsbHostAssigments) {
+            success = parseUsbHostAssigments(file);
+        } else if (section == SectionMidiControl) {
+            success = parseMidiControl(file);
+        } else if (section == SectionUiFeatures) {
+            success = parseUiFeatures(file);
+        } else {
+            success = JsonStream::skipValue(file);
+        }
+
+        if (!success) {
+            System::logger.write(
+                LOG_ERROR, "Config::parse: parsing of %s failed", key);
+            return (false);
+        }
+
+        loadedSections |= section;
+    }
+
+    if (!changeSet && !(loadedSections & SectionRouter)) {
+        System::logger.write(LOG_WARNING,
+                             "Config::parse: no router definition found");
+    }
 
     return (true);
 }
@@ -60,20 +140,9 @@ bool Config::parse(File &file)
 bool Config::parseRouter(File &file)
 {
     const size_t capacityRouter = JSON_OBJECT_SIZE(1) + 1000;
-    const size_t capacityFilter = JSON_OBJECT_SIZE(1) + 100;
     StaticJsonDocument<capacityRouter> doc;
-    StaticJsonDocument<capacityFilter> filter;
-
-    filter["router"] = true;
 
-    if (file.seek(0) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Config::parseRouter: cannot rewind the file");
-        return (false);
-    }
-
-    DeserializationError err =
-        deserializeJson(doc, file, DeserializationOption::Filter(filter));
+    DeserializationError err = deserializeJson(doc, file);
 
     if (err) {
         System::logger.write(
@@ -81,85 +150,98 @@ bool Config::parseRouter(File &file)
         return (false);
     }
 
-    if (doc["router"]) {
-        router.usbDevToUsbHost = doc["router"]["usbDevToUsbHost"].as<bool>();
-        router.usbDevToMidiIo = doc["router"]["usbDevToMidiIo"].as<bool>();
-        router.usbDevToMidiControl =
-            doc["router"]["usbDevToMidiControl"] | true;
-        router.usbHostToUsbDev = doc["router"]["usbHostToUsbDev"].as<bool>();
-        router.usbHostToMidiIo = doc["router"]["usbHostToMidiIo"].as<bool>();
-        router.midiIoToUsbDev = doc["router"]["midiIoToUsbDev"].as<bool>();
-        router.midiIoToUsbHost = doc["router"]["midiIoToUsbHost"].as<bool>();
-        router.midiIo1Thru = doc["router"]["midiIo1Thru"].as<bool>();
-        router.midiIo2Thru = doc["router"]["midiIo2Thru"].as<bool>();
-
-        router.midiControlPort = doc["router"]["midiControlPort"] | 2;
-        router.midiControlChannel = doc["router"]["midiControlChannel"] | 0;
-        router.midiControlDrop = doc["router"]["midiControlDrop"] | true;
-
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: usbDevToUsbHost=%d",
-                             router.usbDevToUsbHost);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: usbDevToMidiIo=%d",
-                             router.usbDevToMidiIo);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: usbDevToMidiControl=%d",
-                             router.usbDevToMidiControl);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: usbHostToUsbDev=%d",
-                             router.usbHostToUsbDev);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: usbHostToMidiIo=%d",
-                             router.usbHostToMidiIo);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: midiIoToUsbDev=%d",
-                             router.midiIoToUsbDev);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: midiIoToUsbHost=%d",
-                             router.midiIoToUsbHost);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: midiIo1Thru=%d",
-                             router.midiIo1Thru);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: midiIo2Thru=%d",
-                             router.midiIo2Thru);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: midiControlPort=%d",
-                             router.midiControlPort);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: midiControlChannel=%d",
-                             router.midiControlChannel);
-        System::logger.write(LOG_TRACE,
-                             "Config::parseRouter: midiControlDrop=%d",
-                             router.midiControlDrop);
-    } else {
-        System::logger.write(LOG_WARNING,
-                             "Config::parseRouter: no router definition found");
+    JsonObject jRouter = doc.as<JsonObject>();
+
+    router.usbDevToUsbHost = jRouter["usbDevToUsbHost"].as<bool>();
+    router.usbDevToMidiIo = jRouter["usbDevToMidiIo"].as<bool>();
+    router.usbDevToMidiControl = jRouter["usbDevToMidiControl"] | true;
+    router.usbHostToUsbDev = jRouter["usbHostToUsbDev"].as<bool>();
+    router.usbHostToMidiIo = jRouter["usbHostToMidiIo"].as<bool>();
+    router.midiIoToUsbDev = jRouter["midiIoToUsbDev"].as<bool>();
+    router.midiIoToUsbHost = jRouter["midiIoToUsbHost"].as<bool>();
+    router.midiIo1Thru = jRouter["midiIo1Thru"].as<bool>();
+    router.midiIo2Thru = jRouter["midiIo2Thru"].as<bool>();
+
+    router.midiControlPort = jRouter["midiControlPort"] | 2;
+    router.midiControlChannel = jRouter["midiControlChannel"] | 0;
+    router.midiControlDrop = jRouter["midiControlDrop"] | true;
+
+    router.dropClock = jRouter["dropClock"] | false;
+    router.dropActiveSensing = jRouter["dropActiveSensing"] | false;
+    router.channelMask = Router::AllChannels;
+
+    if (JsonArray jChannels = jRouter["channels"]) {
+        router.channelMask = 0;
+
+        for (uint8_t channel : jChannels) {
+            if ((1 <= channel) && (channel <= 16)) {
+                router.channelMask |= (1 << (channel - 1));
+            }
+        }
+
+        // A list without valid channels would drop all channel messages
+        if (router.channelMask == 0) {
+            System::logger.write(LOG_WARNING,
+                                 "Config::parseRouter: no valid channels, "
+                                 "routing all channels");
+            router.channelMask = Router::AllChannels;
+        }
     }
 
+    router.compile();
+
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: usbDevToUsbHost=%d",
+                         router.usbDevToUsbHost);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: usbDevToMidiIo=%d",
+                         router.usbDevToMidiIo);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: usbDevToMidiControl=%d",
+                         router.usbDevToMidiControl);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: usbHostToUsbDev=%d",
+                         router.usbHostToUsbDev);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: usbHostToMidiIo=%d",
+                         router.usbHostToMidiIo);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: midiIoToUsbDev=%d",
+                         router.midiIoToUsbDev);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: midiIoToUsbHost=%d",
+                         router.midiIoToUsbHost);
+    System::logger.write(
+        LOG_TRACE, "Config::parseRouter: midiIo1Thru=%d", router.midiIo1Thru);
+    System::logger.write(
+        LOG_TRACE, "Config::parseRouter: midiIo2Thru=%d", router.midiIo2Thru);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: midiControlPort=%d",
+                         router.midiControlPort);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: midiControlChannel=%d",
+                         router.midiControlChannel);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: midiControlDrop=%d",
+                         router.midiControlDrop);
+    System::logger.write(LOG_TRACE,
+                         "Config::parseRouter: dropClock=%d, "
+                         "dropActiveSensing=%d, channelMask=%04X",
+                         router.dropClock,
+                         router.dropActiveSensing,
+                         router.channelMask);
+
     return (true);
 }
 
 bool Config::parsePresetBanks(File &file)
 {
     const size_t capacityPresetBanks = JSON_OBJECT_SIZE(1) + 2000;
-    const size_t capacityFilter = JSON_OBJECT_SIZE(1) + 100;
     StaticJsonDocument<capacityPresetBanks> doc;
-    StaticJsonDocument<capacityFilter> filter;
-
-    filter["presetBanks"] = true;
 
     resetPresetBanks();
 
-    if (file.seek(0) == false) {
-        System::logger.write(
-            LOG_ERROR, "Config::parsePresetBanks: cannot rewind the file");
-        return (false);
-    }
-
-    DeserializationError err =
-        deserializeJson(doc, file, DeserializationOption::Filter(filter));
+    DeserializationError err = deserializeJson(doc, file);
 
     if (err) {
         System::logger.write(LOG_ERROR,
@@ -168,29 +250,27 @@ bool Config::parsePresetBanks(File &file)
         return (false);
     }
 
-    JsonArray jPresetBanks = doc["presetBanks"];
-
-    if (doc["presetBanks"]) {
-        for (JsonVariant jPresetBank : jPresetBanks) {
-            uint8_t id = jPresetBank["id"];
-            const char *name = jPresetBank["name"];
-            const char *colourRGB888 = jPresetBank["color"];
+    JsonArray jPresetBanks = doc.as<JsonArray>();
 
-            uint32_t colour = Colours565::fromString(colourRGB888);
-            presetBanks[id - 1] = PresetBank(id, name, colour);
+    for (JsonVariant jPresetBank : jPresetBanks) {
+        uint8_t id = jPresetBank["id"];
+        const char *name = jPresetBank["name"];
+        const char *colourRGB888 = jPresetBank["color"];
 
-            System::logger.write(
-                LOG_TRACE,
-                "Config::parsePresetBanks: preset bank: id=%d, name=%s, "
-                "colour=%s",
-                id,
-                name,
-                colourRGB888);
+        if ((id < 1) || (id > numPresetBanks)) {
+            continue;
         }
-    } else {
+
+        uint32_t colour = Colours565::fromString(colourRGB888);
+        presetBanks[id - 1] = PresetBank(id, name, colour);
+
         System::logger.write(
-            LOG_WARNING,
-            "Config::parsePresetBanks: no presetBanks definition found");
+            LOG_TRACE,
+            "Config::parsePresetBanks: preset bank: id=%d, name=%s, "
+            "colour=%s",
+            id,
+            name,
+            colourRGB888);
     }
 
     return (true);
@@ -199,24 +279,12 @@ bool Config::parsePresetBanks(File &file)
 bool Config::parseUsbHostAssigments(File &file)
 {
     const size_t capacityAssigments = JSON_OBJECT_SIZE(1) + 1000;
-    const size_t capacityFilter = JSON_OBJECT_SIZE(1) + 100;
     StaticJsonDocument<capacityAssigments> doc;
-    StaticJsonDocument<capacityFilter> filter;
-
-    filter["usbHostAssigments"] = true;
 
     // any previous USB host assigments
     usbHostAssigments.clear();
 
-    if (file.seek(0) == false) {
-        System::logger.write(
-            LOG_ERROR,
-            "Config::parseUsbHostAssigments: cannot rewind the file");
-        return (false);
-    }
-
-    DeserializationError err =
-        deserializeJson(doc, file, DeserializationOption::Filter(filter));
+    DeserializationError err = deserializeJson(doc, file);
 
     if (err) {
         System::logger.write(
@@ -226,35 +294,27 @@ bool Config::parseUsbHostAssigments(File &file)
         return (false);
     }
 
-    JsonArray jAssigments = doc["usbHostAssigments"];
-
-    if (jAssigments) {
-        usbHostAssigments = std::vector<UsbHostAssigment>();
-
-        for (JsonVariant jAssigment : jAssigments) {
-            const char *pattern = jAssigment["pattern"].as<char *>();
-            uint8_t port = jAssigment["port"].as<uint8_t>();
+    JsonArray jAssigments = doc.as<JsonArray>();
 
-            if (port > 0) {
-                port--;
-            }
+    for (JsonVariant jAssigment : jAssigments) {
+        const char *pattern = jAssigment["pattern"].as<char *>();
+        uint8_t port = jAssigment["port"].as<uint8_t>();
 
-            if (port > 2) {
-                port = 0;
-            }
+        if (port > 0) {
+            port--;
+        }
 
-            usbHostAssigments.push_back(UsbHostAssigment(pattern, port));
-            System::logger.write(
-                LOG_TRACE,
-                "Config::parseUsbHostAssigments: usb assigment: pattern=%s, "
-                "port=%d",
-                pattern,
-                port);
+        if (port > 2) {
+            port = 0;
         }
-    } else {
+
+        usbHostAssigments.push_back(UsbHostAssigment(pattern, port));
         System::logger.write(
-            LOG_WARNING,
-            "Config::parseUsbHostAssigments:: no usbHostAssigments definition found");
+            LOG_TRACE,
+            "Config::parseUsbHostAssigments: usb assigment: pattern=%s, "
+            "port=%d",
+            pattern,
+            port);
     }
 
     return (true);
@@ -263,26 +323,12 @@ bool Config::parseUsbHostAssigments(File &file)
 bool Config::parseMidiControl(File &file)
 {
     const size_t capacityMidiControls = JSON_OBJECT_SIZE(1) + 3000;
-    const size_t capacityFilter = JSON_OBJECT_SIZE(1) + 200;
     StaticJsonDocument<capacityMidiControls> doc;
-    StaticJsonDocument<capacityFilter> filter;
 
     // clear any previous MIDI Controls
     midiControls.clear();
 
-    if (file.seek(0) == false) {
-        System::logger.write(
-            LOG_ERROR, "Config::parseMidiControl: cannot rewind the file");
-        return (false);
-    }
-
-    if (findElement(file, "\"midiControl\"", ARRAY) == false) {
-        System::logger.write(
-            LOG_ERROR, "Config::parseMidiControl: midiControl array not found");
-        return (true);
-    }
-
-    if (isElementEmpty(file)) {
+    if (!JsonStream::enterArray(file)) {
         System::logger.write(
             LOG_INFO, "Config::parseMidiControl: no midiControl defined");
         return (true);
@@ -301,80 +347,7 @@ bool Config::parseMidiControl(File &file)
         JsonObject jMidiControl = doc.as<JsonObject>();
 
         if (jMidiControl) {
-            const char *midiMessage = jMidiControl["midiMessage"].as<char *>();
-            uint8_t parameterNumber =
-                jMidiControl["parameterNumber"].as<uint8_t>();
-
-            if (jMidiControl["command"]) {
-                const char *event =
-                    jMidiControl["command"]["type"].as<char *>();
-                uint8_t eventParameter1 =
-                    jMidiControl["command"]["pageId"].as<uint8_t>();
-                uint8_t eventParameter2 =
-                    jMidiControl["command"]["controlSetId"].as<uint8_t>();
-
-                if (eventParameter1 > 12) {
-                    eventParameter1 = 0;
-                }
-
-                if (eventParameter2 > 3) {
-                    eventParameter2 = 3;
-                }
-
-                if (parameterNumber > 127) {
-                    parameterNumber = 0;
-                }
-
-                AppEventType eventType = translateAppEventType(event);
-                MidiMessage::Type midiMessageType =
-                    MidiMessage::translateType(midiMessage);
-
-                midiControls.push_back(MidiControl(eventType,
-                                                   eventParameter1,
-                                                   eventParameter2,
-                                                   midiMessageType,
-                                                   parameterNumber));
-                System::logger.write(
-                    LOG_TRACE,
-                    "Config::parseMidiControl: midi control assigment: "
-                    "event=%s (%d), eventParameter1=%d, eventParameter2=%d, "
-                    "midiMessage=%s (%d), parameterNumber=%d",
-                    event,
-                    eventType,
-                    eventParameter1,
-                    eventParameter2,
-                    midiMessage,
-                    midiMessageType,
-                    parameterNumber);
-            } else {
-                const char *event = jMidiControl["event"].as<char *>();
-                uint8_t eventParameter =
-                    jMidiControl["eventParameter"].as<uint8_t>();
-
-                if (parameterNumber > 127) {
-                    parameterNumber = 0;
-                }
-
-                AppEventType eventType = translateAppEventType(event);
-                MidiMessage::Type midiMessageType =
-                    MidiMessage::translateType(midiMessage);
-
-                midiControls.push_back(MidiControl(eventType,
-                                                   eventParameter,
-                                                   midiMessageType,
-                                                   parameterNumber));
-                System::logger.write(
-                    LOG_TRACE,
-                    "Config::parseMidiControl: midi control assigment: "
-                    "event=%s (%d), eventParameter=%d, midiMessage=%s (%d), "
-                    "parameterNumber=%d",
-                    event,
-                    eventType,
-                    eventParameter,
-                    midiMessage,
-                    midiMessageType,
-                    parameterNumber);
-            }
+            parseMidiControl(jMidiControl);
         } else {
             System::logger.write(
                 LOG_WARNING,
@@ -385,23 +358,79 @@ bool Config::parseMidiControl(File &file)
     return (true);
 }
 
-bool Config::parseUiFeatures(File &file)
+void Config::parseMidiControl(JsonObject jMidiControl)
 {
-    const size_t capacityUiFeatures = JSON_OBJECT_SIZE(1) + 1000;
-    const size_t capacityFilter = JSON_OBJECT_SIZE(1) + 100;
-    StaticJsonDocument<capacityUiFeatures> doc;
-    StaticJsonDocument<capacityFilter> filter;
+    const char *midiMessage = jMidiControl["midiMessage"].as<char *>();
+    uint8_t parameterNumber = jMidiControl["parameterNumber"].as<uint8_t>();
 
-    filter["uiFeatures"] = true;
+    if (parameterNumber > 127) {
+        parameterNumber = 0;
+    }
 
-    if (file.seek(0) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Config::parseUiFeatures: cannot rewind the file");
-        return (false);
+    MidiMessage::Type midiMessageType = MidiMessage::translateType(midiMessage);
+
+    if (jMidiControl["command"]) {
+        const char *event = jMidiControl["command"]["type"].as<char *>();
+        uint8_t eventParameter1 =
+            jMidiControl["command"]["pageId"].as<uint8_t>();
+        uint8_t eventParameter2 =
+            jMidiControl["command"]["controlSetId"].as<uint8_t>();
+
+        if (eventParameter1 > 12) {
+            eventParameter1 = 0;
+        }
+
+        if (eventParameter2 > 3) {
+            eventParameter2 = 3;
+        }
+
+        AppEventType eventType = translateAppEventType(event);
+
+        midiControls.push_back(MidiControl(eventType,
+                                           eventParameter1,
+                                           eventParameter2,
+                                           midiMessageType,
+                                           parameterNumber));
+        System::logger.write(
+            LOG_TRACE,
+            "Config::parseMidiControl: midi control assigment: "
+            "event=%s (%d), eventParameter1=%d, eventParameter2=%d, "
+            "midiMessage=%s (%d), parameterNumber=%d",
+            event,
+            eventType,
+            eventParameter1,
+            eventParameter2,
+            midiMessage,
+            midiMessageType,
+            parameterNumber);
+    } else {
+        const char *event = jMidiControl["event"].as<char *>();
+        uint8_t eventParameter = jMidiControl["eventParameter"].as<uint8_t>();
+
+        AppEventType eventType = translateAppEventType(event);
+
+        midiControls.push_back(MidiControl(
+            eventType, eventParameter, midiMessageType, parameterNumber));
+        System::logger.write(
+            LOG_TRACE,
+            "Config::parseMidiControl: midi control assigment: "
+            "event=%s (%d), eventParameter=%d, midiMessage=%s (%d), "
+            "parameterNumber=%d",
+            event,
+            eventType,
+            eventParameter,
+            midiMessage,
+            midiMessageType,
+            parameterNumber);
     }
+}
+
+bool Config::parseUiFeatures(File &file)
+{
+    const size_t capacityUiFeatures = JSON_OBJECT_SIZE(1) + 1000;
+    StaticJsonDocument<capacityUiFeatures> doc;
 
-    DeserializationError err =
-        deserializeJson(doc, file, DeserializationOption::Filter(filter));
+    DeserializationError err = deserializeJson(doc, file);
 
     if (err) {
         System::logger.write(LOG_ERROR,
@@ -410,44 +439,163 @@ bool Config::parseUiFeatures(File &file)
         return (false);
     }
 
-    if (doc["uiFeatures"]) {
-        uiFeatures.touchSwitchControlSets =
-            doc["uiFeatures"]["touchSwitchControlSets"].as<bool>();
-        System::logger.write(
-            LOG_TRACE,
-            "Config::parseUiFeatures: touchSwitchControlSets=%d",
-            uiFeatures.touchSwitchControlSets);
-        uiFeatures.resetActiveControlSet =
-            doc["uiFeatures"]["resetActiveControlSet"].as<bool>();
-        System::logger.write(
-            LOG_TRACE,
-            "Config::parseUiFeatures: resetActiveControlSet=%d",
-            uiFeatures.resetActiveControlSet);
-        uiFeatures.activeControlSetType = translateControlSetType(
-            doc["uiFeatures"]["activeControlSetType"].as<char *>());
-        System::logger.write(LOG_TRACE,
-                             "Config::parseUiFeatures: activeControlSetType=%d",
-                             uiFeatures.activeControlSetType);
-        uiFeatures.keepPresetState =
-            doc["uiFeatures"]["keepPresetState"].as<bool>();
-        System::logger.write(LOG_TRACE,
-                             "Config::parseUiFeatures: keepPresetState=%d",
-                             uiFeatures.keepPresetState);
-        uiFeatures.loadPresetStateOnStartup =
-            doc["uiFeatures"]["loadPresetStateOnStartup"].as<bool>();
+    JsonObject jUiFeatures = doc.as<JsonObject>();
+
+    uiFeatures.touchSwitchControlSets =
+        jUiFeatures["touchSwitchControlSets"].as<bool>();
+    System::logger.write(LOG_TRACE,
+                         "Config::parseUiFeatures: touchSwitchControlSets=%d",
+                         uiFeatures.touchSwitchControlSets);
+    uiFeatures.resetActiveControlSet =
+        jUiFeatures["resetActiveControlSet"].as<bool>();
+    System::logger.write(LOG_TRACE,
+                         "Config::parseUiFeatures: resetActiveControlSet=%d",
+                         uiFeatures.resetActiveControlSet);
+    uiFeatures.activeControlSetType = translateControlSetType(
+        jUiFeatures["activeControlSetType"].as<char *>());
+    System::logger.write(LOG_TRACE,
+                         "Config::parseUiFeatures: activeControlSetType=%d",
+                         uiFeatures.activeControlSetType);
+    uiFeatures.keepPresetState = jUiFeatures["keepPresetState"].as<bool>();
+    System::logger.write(LOG_TRACE,
+                         "Config::parseUiFeatures: keepPresetState=%d",
+                         uiFeatures.keepPresetState);
+    uiFeatures.loadPresetStateOnStartup =
+        jUiFeatures["loadPresetStateOnStartup"].as<bool>();
+    System::logger.write(LOG_TRACE,
+                         "Config::parseUiFeatures: loadPresetStateOnStartup=%d",
+                         uiFeatures.loadPresetStateOnStartup);
+
+    return (true);
+}
+
+/** Write the merged configuration to the output file.
+ *  All members of the changes file are copied first, followed by
+ *  the members of the current configuration that were not changed.
+ */
+bool Config::merge(const char *changesFilename,
+                   const char *configFilename,
+                   const char *mergedFilename)
+{
+    File changesFile = Hardware::sdcard.createInputStream(changesFilename);
+
+    if (!changesFile) {
         System::logger.write(
-            LOG_TRACE,
-            "Config::parseUiFeatures: loadPresetStateOnStartup=%d",
-            uiFeatures.loadPresetStateOnStartup);
-    } else {
+            LOG_ERROR, "Config::merge: cannot open file: %s", changesFilename);
+        return (false);
+    }
+
+    File mergedFile = Hardware::sdcard.createOutputStream(
+        mergedFilename, FILE_WRITE | O_CREAT | O_TRUNC);
+
+    if (!mergedFile) {
         System::logger.write(
-            LOG_TRACE,
-            "Config::parseUiFeatures: no UiFeatures definition found");
+            LOG_ERROR, "Config::merge: cannot open file: %s", mergedFilename);
+        changesFile.close();
+        return (false);
+    }
+
+    std::vector<std::string> changedKeys;
+    char key[MaxKeyLength + 1];
+    bool status = true;
+
+    mergedFile.write('{');
+
+    while (status && JsonStream::readKey(changesFile, key, MaxKeyLength)) {
+        if (strcmp(key, ChangeSetKey) == 0) {
+            status = JsonStream::skipValue(changesFile);
+            continue;
+        }
+        status = copyMember(changesFile, mergedFile, key, changedKeys.empty());
+        changedKeys.push_back(key);
+    }
+    changesFile.close();
+
+    if (status && Hardware::sdcard.exists(configFilename)) {
+        if (File configFile = Hardware::sdcard.createInputStream(configFilename)) {
+            while (status
+                   && JsonStream::readKey(configFile, key, MaxKeyLength)) {
+                if (std::find(changedKeys.begin(), changedKeys.end(), key)
+                    != changedKeys.end()) {
+                    status = JsonStream::skipValue(configFile);
+                } else {
+                    status = copyMember(
+                        configFile, mergedFile, key, changedKeys.empty());
+                    changedKeys.push_back(key);
+                }
+            }
+            configFile.close();
+        }
+    }
+
+    mergedFile.write('}');
+    mergedFile.close();
+
+    if (!status) {
+        System::logger.write(LOG_ERROR,
+                             "Config::merge: cannot merge configuration: %s",
+                             changesFilename);
+        Hardware::sdcard.deleteFile(mergedFilename);
+    }
+
+    return (status);
+}
+
+/** Copy the raw value of a member from one file to another.
+ *  The input file is expected to be positioned at the value.
+ */
+bool Config::copyMember(File &input, File &output, const char *key, bool first)
+{
+    size_t startPosition = input.position();
+
+    if (!JsonStream::skipValue(input)) {
+        return (false);
+    }
+
+    size_t endPosition = input.position();
+
+    if (!first) {
+        output.write(',');
+    }
+    output.write('"');
+    output.write((const uint8_t *)key, strlen(key));
+    output.write("\":", 2);
+
+    if (!input.seek(startPosition)) {
+        return (false);
+    }
+
+    uint8_t buffer[64];
+
+    while (startPosition < endPosition) {
+        size_t length = std::min(sizeof(buffer), endPosition - startPosition);
+
+        if (input.read(buffer, length) != (int)length) {
+            return (false);
+        }
+        output.write(buffer, length);
+        startPosition += length;
     }
 
     return (true);
 }
 
+uint8_t Config::translateSection(const char *key)
+{
+    if (strcmp(key, "router") == 0) {
+        return (SectionRouter);
+    } else if (strcmp(key, "presetBanks") == 0) {
+        return (SectionPresetBanks);
+    } else if (strcmp(key, "usbHostAssigments") == 0) {
+        return (SectionUsbHostAssigments);
+    } else if (strcmp(key, "midiControl") == 0) {
+        return (SectionMidiControl);
+    } else if (strcmp(key, "uiFeatures") == 0) {
+        return (SectionUiFeatures);
+    }
+    return (0);
+}
+
 void Config::resetPresetBanks(void)
 {
     presetBanks[0] = PresetBank(1, "BANK #1", Colours565::white);
@@ -9,6 +9,7 @@
 #include <ArduinoJson.h>
 #include <vector>
 #include <array>
+#include <string>
 
 class Config
 {
@@ -17,6 +18,10 @@ public:
 
     bool load(void);
     bool load(const char *filename);
+    bool loadUpload(const char *filename, bool &changeSet);
+    static bool merge(const char *changesFilename,
+                      const char *configFilename,
+                      const char *mergedFilename);
     void useDefault(void);
     void resetPresetBanks(void);
     void resetUiFeatures(void);
@@ -31,14 +36,31 @@ public:
     UiFeatures uiFeatures;
 
 private:
-    bool parse(File &file);
+    static constexpr uint8_t MaxKeyLength = 20;
+    // First root member that marks an upload as a set of changes to merge
+    static constexpr const char *ChangeSetKey = "merge";
+
+    static constexpr uint8_t SectionRouter = 0x01;
+    static constexpr uint8_t SectionPresetBanks = 0x02;
+    static constexpr uint8_t SectionUsbHostAssigments = 0x04;
+    static constexpr uint8_t SectionMidiControl = 0x08;
+    static constexpr uint8_t SectionUiFeatures = 0x10;
+
+    bool open(const char *filename, bool acceptChangeSet, bool &changeSet);
+    bool parse(File &file, bool acceptChangeSet, bool &changeSet);
     bool parseRouter(File &file);
     bool parsePresetBanks(File &file);
     bool parseUsbHostAssigments(File &file);
     bool parseMidiControl(File &file);
+    void parseMidiControl(JsonObject jMidiControl);
     bool parseUiFeatures(File &file);
 
+    static bool
+        copyMember(File &input, File &output, const char *key, bool first);
+    static uint8_t translateSection(const char *key);
     static const char *translatePresetBankColour(uint32_t rgb888);
+
+    uint8_t loadedSections;
 };
 
 typedef std::vector<UsbHostAssigment> UsbHostAssigments;
@@ -15,8 +15,54 @@ struct Router {
           midiIo2Thru(false),
           midiControlPort(2),
           midiControlChannel(0),
-          midiControlDrop(true)
+          midiControlDrop(true),
+          dropClock(false),
+          dropActiveSensing(false),
+          channelMask(AllChannels)
     {
+        compile();
+    }
+
+    // Interfaces the routes are compiled for, used as bits of a route mask
+    enum Interface : uint8_t { UsbDev = 0, MidiIo, UsbHost, NumInterfaces };
+
+    static constexpr uint16_t AllChannels = 0xFFFF;
+    static constexpr uint8_t StatusClock = 0xF8;
+    static constexpr uint8_t StatusActiveSensing = 0xFE;
+
+    /** Translates the route flags to the per-interface route masks.
+     *  Must be called whenever the flags are changed.
+     */
+    void compile(void)
+    {
+        routes[UsbDev] = getRoute(MidiIo, usbDevToMidiIo)
+                         | getRoute(UsbHost, usbDevToUsbHost);
+        routes[MidiIo] = getRoute(UsbDev, midiIoToUsbDev)
+                         | getRoute(UsbHost, midiIoToUsbHost);
+        routes[UsbHost] = getRoute(MidiIo, usbHostToMidiIo)
+                          | getRoute(UsbDev, usbHostToUsbDev);
+    }
+
+    uint8_t getRoutes(Interface source) const
+    {
+        return (routes[source]);
+    }
+
+    /** Returns true when a routed message passes the message filters.
+     *  SysEx messages are not filtered.
+     */
+    bool isAllowed(uint8_t status, uint8_t channel) const
+    {
+        if (status < 0xF0) {
+            return (channelMask & (1 << ((channel - 1) & 0x0F)));
+        }
+        if (status == StatusClock) {
+            return (!dropClock);
+        }
+        if (status == StatusActiveSensing) {
+            return (!dropActiveSensing);
+        }
+        return (true);
     }
 
     bool usbDevToMidiIo;
@@ -31,4 +77,15 @@ struct Router {
     uint8_t midiControlPort;
     uint8_t midiControlChannel;
     bool midiControlDrop;
+    bool dropClock;
+    bool dropActiveSensing;
+    uint16_t channelMask;
+
+private:
+    static uint8_t getRoute(Interface destination, bool enabled)
+    {
+        return (enabled ? (1 << destination) : 0);
+    }
+
+    uint8_t routes[NumInterfaces];
 };
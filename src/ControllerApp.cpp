@@ -1,5 +1,6 @@
 #include "ControllerApp.h"
 #include "luaExtension.h"
+#include "ControllerLog.h"
 
 void Controller::initialise(void)
 {
@@ -97,11 +98,15 @@ void Controller::handleIncomingMidiMessage(const MidiInput &midiInput,
         }
     }
 
+    uint32_t startTime = micros();
+
     if (System::context.getMidiLearn()) {
         midiLearn.process(midiInput, midiMessage);
     } else {
         midi.process(midiInput, midiMessage);
     }
+
+    RECORD_TIME(midiProcess, micros() - startTime);
 }
 
 /** Incoming file received handler.
@@ -117,10 +122,14 @@ bool Controller::handleCtrlFileReceived(uint8_t port,
     if (fileType == ElectraCommand::Object::FileConfig) {
         status = applyChangesToConfig(file);
     } else {
+        if (fileType == ElectraCommand::Object::FilePreset) {
+            PresetCache::invalidate(file.getFilepath());
+        }
+
         status = sysexApi.process(port, file, fileType);
 
         if (fileType == ElectraCommand::Object::FilePreset) {
-            model.presets.assignPresetNames();
+            model.presets.updatePresetName(file.getFilepath());
         }
     }
 
@@ -137,12 +146,16 @@ bool Controller::handleCtrlFileRemoved(uint8_t bankNumber,
 {
     uint8_t currentPreset = model.presets.getCurrentSlot();
     uint8_t currentPresetBank = model.presets.getCurrentBankNumber();
-    uint8_t slotId =
-        currentPresetBank * Presets::NumPresetsInBank + currentPreset;
-
-    model.presets.removePreset(slotId);
+    uint8_t slotId = bankNumber * Presets::NumPresetsInBank + slot;
 
     if (fileType == ElectraCommand::Object::FilePreset) {
+        model.presets.removePreset(slotId);
+
+        char presetFilename[MAX_FILENAME_LENGTH + 1];
+        System::context.formatPresetFilename(
+            presetFilename, MAX_FILENAME_LENGTH, slotId);
+        PresetCache::invalidate(presetFilename);
+
         // If it is a current preset, reload it
         if ((currentPresetBank == bankNumber) && (currentPreset == slot)) {
             delegate.switchPreset(currentPresetBank, currentPreset);
@@ -161,12 +174,19 @@ void Controller::handleElectraSysex(uint8_t port, const SysexBlock &sysexBlock)
 }
 
 /** User configurable task
- * Currently misused for sending Patch request messages.
+ * Currently misused for sending Patch request, queued MIDI messages
+ * and writing the kept ParameterMap state.
  */
 void Controller::runUserTask(void)
 {
     PatchRequest request;
 
+    // Release queued parameter changes at the rate of their devices
+    midi.flushOutput();
+
+    // Write the kept ParameterMap state to the SD card in chunks
+    parameterMap.flushKeep();
+
     if (patchRequests.isEmpty() != true) {
         request = patchRequests.shift();
         Device device = model.currentPreset.getDevice(request.deviceId);
@@ -184,24 +204,57 @@ void Controller::runUserTask(void)
 
 /** Apply configuation change.
  *
- * Loads config from a (temp) file, merges it with existing, and writes
- * the new config file to the standard location
+ * An uploaded configuration replaces the current one. Uploads marked as
+ * change sets are merged with the existing config instead, the merged
+ * file is written to the standard location.
  */
 bool Controller::applyChangesToConfig(LocalFile file)
 {
-    if (appConfig.load(file.getFilepath())) {
-        configureApp();
-        delegate.displayPage();
-        Hardware::sdcard.deleteFile(System::context.getCurrentConfigFile());
-        if (!file.rename(System::context.getCurrentConfigFile())) {
+    const char *configFilename = System::context.getCurrentConfigFile();
+    bool changeSet = false;
+
+    if (!appConfig.loadUpload(file.getFilepath(), changeSet)) {
+        return (false);
+    }
+
+    configureApp();
+    delegate.displayPage();
+
+    if (!changeSet) {
+        Hardware::sdcard.deleteFile(configFilename);
+        if (!file.rename(configFilename)) {
             System::logger.write(
                 LOG_ERROR,
                 "applyChangesToConfig: failed to update config: %s",
-                System::context.getCurrentConfigFile());
+                configFilename);
         }
         return (true);
     }
-    return (false);
+
+    // Keep the sections that were not part of the upload
+    char mergedFilename[MAX_FILENAME_LENGTH + 1];
+    snprintf(mergedFilename, MAX_FILENAME_LENGTH, "%s.tmp", configFilename);
+
+    if (Config::merge(file.getFilepath(), configFilename, mergedFilename)) {
+        Hardware::sdcard.deleteFile(configFilename);
+        Hardware::sdcard.deleteFile(file.getFilepath());
+
+        if (!Hardware::sdcard.renameFile(mergedFilename, configFilename)) {
+            System::logger.write(
+                LOG_ERROR,
+                "applyChangesToConfig: failed to update config: %s",
+                configFilename);
+        }
+    } else {
+        System::logger.write(
+            LOG_ERROR,
+            "applyChangesToConfig: merge failed, reloading config: %s",
+            configFilename);
+        loadConfig();
+        Hardware::sdcard.deleteFile(file.getFilepath());
+        return (false);
+    }
+    return (true);
 }
 
 /** Load configuration.
@@ -22,7 +22,7 @@ public:
           sysexApi(mainWindow),
           midiApi(appConfig.midiControls, mainWindow),
           midiLearn(model.currentPreset),
-          midiRouter(appConfig.router)
+          midiRouter(appConfig.router, midi)
     {
     }
 
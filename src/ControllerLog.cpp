@@ -0,0 +1,113 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+#include "ControllerLog.h"
+
+const char *ControllerLog::counterNames[NumCounters] = {
+    "midiIn",       "midiCc",         "midiRpn",        "midiCc14",
+    "midiNote",     "midiProgram",    "midiAfterTouch", "midiPitchBend",
+    "midiRealtime", "midiOther",      "sysexIn",        "sysexMatched",
+    "responseMatched", "rulesApplied", "routedMessages", "droppedMessages",
+    "routedSysex",  "ctrlPortMessages", "outputSent",   "outputQueued",
+    "outputCoalesced", "outputOverflow", "outputElided"
+};
+
+uint32_t ControllerLog::counters[NumCounters] = {};
+
+const char *ControllerLog::timerNames[NumTimers] = { "midiProcess" };
+
+ControllerLog::Histogram ControllerLog::timers[NumTimers] = {};
+
+void ControllerLog::record(Timer timer, uint32_t duration)
+{
+    Histogram &histogram = timers[timer];
+    uint8_t bucket = 0;
+
+    while ((duration >> bucket) && (bucket < NumTimerBuckets - 1)) {
+        bucket++;
+    }
+
+    histogram.buckets[bucket]++;
+    histogram.count++;
+
+    if (duration > histogram.max) {
+        histogram.max = duration;
+    }
+}
+
+uint32_t ControllerLog::getPercentile(Timer timer, uint8_t percentile)
+{
+    const Histogram &histogram = timers[timer];
+    uint32_t rank = ((uint64_t)histogram.count * percentile + 99) / 100;
+    uint32_t total = 0;
+
+    if (histogram.count == 0) {
+        return (0);
+    }
+
+    // the last bucket is open, its durations are bounded by the maximum
+    for (uint8_t i = 0; i < NumTimerBuckets - 1; i++) {
+        total += histogram.buckets[i];
+
+        if (total >= rank) {
+            uint32_t upperBound = (1UL << i) - 1;
+            return ((upperBound < histogram.max) ? upperBound : histogram.max);
+        }
+    }
+
+    return (histogram.max);
+}
+
+void ControllerLog::resetCounters(void)
+{
+    for (uint8_t i = 0; i < NumCounters; i++) {
+        counters[i] = 0;
+    }
+    for (uint8_t i = 0; i < NumTimers; i++) {
+        timers[i] = Histogram{};
+    }
+}
+
+void ControllerLog::printCounters(uint8_t logLevel)
+{
+    System::logger.write(logLevel,
+                         "--[Diagnostic counters]--------------------------");
+    for (uint8_t i = 0; i < NumCounters; i++) {
+        System::logger.write(logLevel,
+                             "%s: %lu",
+                             counterNames[i],
+                             (unsigned long)counters[i]);
+    }
+    for (uint8_t i = 0; i < NumTimers; i++) {
+        Timer timer = (Timer)i;
+
+        System::logger.write(logLevel,
+                             "%s: count=%lu, p50=%luus, p90=%luus, "
+                             "p99=%luus, max=%luus",
+                             timerNames[i],
+                             (unsigned long)timers[i].count,
+                             (unsigned long)getPercentile(timer, 50),
+                             (unsigned long)getPercentile(timer, 90),
+                             (unsigned long)getPercentile(timer, 99),
+                             (unsigned long)timers[i].max);
+    }
+    System::logger.write(logLevel, "--");
+}
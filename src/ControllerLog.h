@@ -0,0 +1,208 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+/**
+ * @file ControllerLog.h
+ *
+ * @brief Implements compile-time gated logging, diagnostic counters and
+ *  timing histograms for the hot paths of the controller.
+ *
+ * Every category has its own log level threshold. Messages above the
+ * threshold are removed by the compiler, including the evaluation of their
+ * arguments. The thresholds can be set with CONTROLLER_LOG_LEVEL and
+ * overridden per category, eg. -DCONTROLLER_LOG_LEVEL_MIDI=4.
+ *
+ * Levels: 0 = none, 1 = error, 2 = info, 3 = debug, 4 = trace
+ */
+
+#pragma once
+
+#include "System.h"
+#include <cstdint>
+
+#ifndef CONTROLLER_LOG_LEVEL
+#ifdef DEBUG
+#define CONTROLLER_LOG_LEVEL 4
+#else
+#define CONTROLLER_LOG_LEVEL 2
+#endif
+#endif
+
+#ifndef CONTROLLER_LOG_LEVEL_MIDI
+#define CONTROLLER_LOG_LEVEL_MIDI CONTROLLER_LOG_LEVEL
+#endif
+
+#ifndef CONTROLLER_LOG_LEVEL_ROUTER
+#define CONTROLLER_LOG_LEVEL_ROUTER CONTROLLER_LOG_LEVEL
+#endif
+
+#ifndef CONTROLLER_LOG_LEVEL_LEARN
+#define CONTROLLER_LOG_LEVEL_LEARN CONTROLLER_LOG_LEVEL
+#endif
+
+#ifndef CONTROLLER_LOG_LEVEL_SYSEX
+#define CONTROLLER_LOG_LEVEL_SYSEX CONTROLLER_LOG_LEVEL
+#endif
+
+class ControllerLog
+{
+public:
+    enum Level : uint8_t { none = 0, error = 1, info = 2, debug = 3, trace = 4 };
+
+    enum Category : uint8_t { midi = 0, router, learn, sysex, NumCategories };
+
+    enum Counter : uint8_t {
+        midiIn = 0,
+        midiCc,
+        midiRpn,
+        midiCc14,
+        midiNote,
+        midiProgram,
+        midiAfterTouch,
+        midiPitchBend,
+        midiRealtime,
+        midiOther,
+        sysexIn,
+        sysexMatched,
+        responseMatched,
+        rulesApplied,
+        routedMessages,
+        droppedMessages,
+        routedSysex,
+        ctrlPortMessages,
+        outputSent,
+        outputQueued,
+        outputCoalesced,
+        outputOverflow,
+        outputElided,
+        NumCounters
+    };
+
+    enum Timer : uint8_t { midiProcess = 0, NumTimers };
+
+    /**
+     * @brief Returns true when messages of the level are compiled in
+     *  for the category
+     *
+     * @param category subsystem of the message
+     * @param level level of the message
+     * @return true when the message is to be logged
+     */
+    static constexpr bool isEnabled(Category category, Level level)
+    {
+        return (level <= thresholds[category]);
+    }
+
+    /**
+     * @brief Increments a diagnostic counter
+     *
+     * @param counter identifier of the counter
+     */
+    static void count(Counter counter)
+    {
+        counters[counter]++;
+    }
+
+    /**
+     * @brief Returns the current value of a diagnostic counter
+     *
+     * @param counter identifier of the counter
+     * @return uint32_t the number of counted events
+     */
+    static uint32_t getCount(Counter counter)
+    {
+        return (counters[counter]);
+    }
+
+    /**
+     * @brief Adds a duration to the histogram of a timer
+     *
+     * @param timer identifier of the timer
+     * @param duration measured duration in microseconds
+     */
+    static void record(Timer timer, uint32_t duration);
+
+    /**
+     * @brief Returns an upper estimate of a percentile of recorded durations
+     *
+     * @param timer identifier of the timer
+     * @param percentile requested percentile, 1 - 100
+     * @return uint32_t duration in microseconds
+     */
+    static uint32_t getPercentile(Timer timer, uint8_t percentile);
+
+    /**
+     * @brief Resets all diagnostic counters and timers
+     */
+    static void resetCounters(void);
+
+    /**
+     * @brief Prints all diagnostic counters and timers to the logger output
+     *
+     * @param logLevel log level to be used for printing
+     */
+    static void printCounters(uint8_t logLevel = LOG_ERROR);
+
+private:
+    static constexpr Level thresholds[NumCategories] = {
+        (Level)CONTROLLER_LOG_LEVEL_MIDI,
+        (Level)CONTROLLER_LOG_LEVEL_ROUTER,
+        (Level)CONTROLLER_LOG_LEVEL_LEARN,
+        (Level)CONTROLLER_LOG_LEVEL_SYSEX
+    };
+
+    // Bucket n holds durations of n significant bits, ie. 2^(n-1) - 2^n-1 us
+    static constexpr uint8_t NumTimerBuckets = 21;
+
+    struct Histogram {
+        uint32_t buckets[NumTimerBuckets];
+        uint32_t count;
+        uint32_t max;
+    };
+
+    static const char *counterNames[NumCounters];
+    static uint32_t counters[NumCounters];
+    static const char *timerNames[NumTimers];
+    static Histogram timers[NumTimers];
+};
+
+#define CONTROLLER_LOG(category, level, logLevel, ...)                         \
+    do {                                                                       \
+        if constexpr (ControllerLog::isEnabled(ControllerLog::category,        \
+                                               ControllerLog::level)) {        \
+            System::logger.write(logLevel, __VA_ARGS__);                       \
+        }                                                                      \
+    } while (0)
+
+#define LOG_ERROR_IN(category, ...)                                            \
+    CONTROLLER_LOG(category, error, LOG_ERROR, __VA_ARGS__)
+#define LOG_INFO_IN(category, ...)                                             \
+    CONTROLLER_LOG(category, info, LOG_INFO, __VA_ARGS__)
+// Debug messages are written with LOG_ERROR so that they show up
+// with the default logger settings once they are compiled in
+#define LOG_DEBUG_IN(category, ...)                                            \
+    CONTROLLER_LOG(category, debug, LOG_ERROR, __VA_ARGS__)
+#define LOG_TRACE_IN(category, ...)                                            \
+    CONTROLLER_LOG(category, trace, LOG_TRACE, __VA_ARGS__)
+
+#define COUNT_EVENT(counter) ControllerLog::count(ControllerLog::counter)
+#define RECORD_TIME(timer, duration)                                           \
+    ControllerLog::record(ControllerLog::timer, duration)
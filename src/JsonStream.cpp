@@ -0,0 +1,182 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+/**
+ * @file JsonStream.cpp
+ *
+ * @brief Implements forward-only navigation of JSON objects in a file.
+ */
+
+#include "JsonStream.h"
+
+bool JsonStream::readKey(File &file, char *key, size_t maxKeyLength)
+{
+    int c = peekToken(file);
+
+    if ((c == '{') || (c == ',')) {
+        file.read();
+        c = peekToken(file);
+    }
+
+    if (c == '}') {
+        file.read();
+        return (false);
+    }
+
+    if ((c != '"') || !readString(file, key, maxKeyLength)) {
+        return (false);
+    }
+
+    if (peekToken(file) != ':') {
+        return (false);
+    }
+    file.read();
+
+    return (true);
+}
+
+bool JsonStream::readString(File &file, char *value, size_t maxLength)
+{
+    if (peekToken(file) != '"') {
+        skipValue(file);
+        return (false);
+    }
+
+    file.read();
+
+    size_t length = 0;
+    int c;
+
+    while ((c = file.read()) != -1) {
+        if (c == '"') {
+            break;
+        }
+        if (c == '\\') {
+            c = file.read();
+        }
+        if (length < maxLength) {
+            value[length++] = c;
+        }
+    }
+    value[length] = '\0';
+
+    return (c == '"');
+}
+
+bool JsonStream::enterArray(File &file)
+{
+    if (peekToken(file) != '[') {
+        skipValue(file);
+        return (false);
+    }
+
+    file.read();
+
+    if (peekToken(file) == ']') {
+        file.read();
+        return (false);
+    }
+    return (true);
+}
+
+long JsonStream::readInteger(File &file)
+{
+    int c = peekToken(file);
+
+    if ((c != '-') && ((c < '0') || (c > '9'))) {
+        skipValue(file);
+        return (0);
+    }
+
+    bool negative = (c == '-');
+    long value = 0;
+
+    if (negative) {
+        file.read();
+    }
+
+    while (((c = file.peek()) >= '0') && (c <= '9')) {
+        value = (value * 10) + (file.read() - '0');
+    }
+
+    // skip the fraction and exponent, if any
+    while ((c == '.') || (c == 'e') || (c == 'E') || (c == '+') || (c == '-')
+           || ((c >= '0') && (c <= '9'))) {
+        file.read();
+        c = file.peek();
+    }
+
+    return (negative ? -value : value);
+}
+
+bool JsonStream::readBoolean(File &file)
+{
+    if (peekToken(file) != 't') {
+        skipValue(file);
+        return (false);
+    }
+
+    int c;
+
+    while (((c = file.peek()) >= 'a') && (c <= 'z')) {
+        file.read();
+    }
+    return (true);
+}
+
+bool JsonStream::skipValue(File &file)
+{
+    int c = peekToken(file);
+
+    // Scalars are consumed here so that the following separator is kept
+    if ((c == '-') || ((c >= '0') && (c <= '9'))) {
+        readInteger(file);
+        return (true);
+    }
+
+    if ((c == 't') || (c == 'f') || (c == 'n')) {
+        while (((c = file.peek()) >= 'a') && (c <= 'z')) {
+            file.read();
+        }
+        return (true);
+    }
+
+    StaticJsonDocument<16> doc;
+    StaticJsonDocument<16> filter;
+
+    filter.set(false);
+
+    auto err =
+        deserializeJson(doc, file, DeserializationOption::Filter(filter));
+
+    return (!err);
+}
+
+int JsonStream::peekToken(File &file)
+{
+    int c;
+
+    while (((c = file.peek()) == ' ') || (c == '\n') || (c == '\r')
+           || (c == '\t')) {
+        file.read();
+    }
+    return (c);
+}
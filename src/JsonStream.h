@@ -0,0 +1,103 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+/**
+ * @file JsonStream.h
+ *
+ * @brief Implements forward-only navigation of JSON objects in a file.
+ *
+ * The functions let the parsers walk the members of an object in the
+ * order they appear in the file and hand over individual values
+ * to ArduinoJson. The file is never rewound.
+ */
+
+#pragma once
+
+#include <ArduinoJson.h>
+#include "PersistentStorage.h"
+
+class JsonStream
+{
+public:
+    /**
+     * @brief Reads the key of the next member of the current object
+     *
+     * The opening brace or a separating comma are consumed. On success,
+     * the file is positioned at the value of the member.
+     *
+     * @param file file to read from
+     * @param key buffer to store the key to
+     * @param maxKeyLength maximum length of the key
+     * @return true when a key was read, false at the end of the object
+     */
+    static bool readKey(File &file, char *key, size_t maxKeyLength);
+
+    /**
+     * @brief Reads a string value
+     *
+     * Values that are not strings are skipped and the buffer is left
+     * untouched.
+     *
+     * @param file file to read from
+     * @param value buffer to store the string to
+     * @param maxLength maximum length of the string
+     * @return true when a string was read
+     */
+    static bool readString(File &file, char *value, size_t maxLength);
+
+    /**
+     * @brief Enters an array value
+     *
+     * Values that are not arrays are skipped.
+     *
+     * @param file file to read from
+     * @return true when the file is positioned at the first element
+     *  of a non-empty array
+     */
+    static bool enterArray(File &file);
+
+    /**
+     * @brief Reads an integer value
+     *
+     * @param file file to read from
+     * @return long the value, zero when the value is not a number
+     */
+    static long readInteger(File &file);
+
+    /**
+     * @brief Reads a boolean value
+     *
+     * @param file file to read from
+     * @return true when the value is the literal true
+     */
+    static bool readBoolean(File &file);
+
+    /**
+     * @brief Skips over a value of any type
+     *
+     * @param file file to read from
+     * @return true when the value was skipped successfully
+     */
+    static bool skipValue(File &file);
+
+private:
+    static int peekToken(File &file);
+};
@@ -1,16 +1,87 @@
 #include "luaHooks.h"
 #include "System.h"
 
-void runFormatter(const char *formatter,
+/*
+ * Registry references of the preset functions, indexed by the function id.
+ * LUA_REFNIL marks an id without a function name, LUA_NOREF a function
+ * that was not defined when the script was loaded.
+ */
+static std::vector<int> functionRefs;
+static const std::vector<std::string> *functionNames = nullptr;
+
+/** Assign the function names of the preset to the function ids.
+ *  Must be called when a new Lua state is created, before any function
+ *  of the preset can be called.
+ */
+void resetLuaFunctions(const std::vector<std::string> &newFunctionNames)
+{
+    functionNames = &newFunctionNames;
+    functionRefs.assign(functionNames->size(), LUA_NOREF);
+
+    for (size_t i = 0; i < functionNames->size(); i++) {
+        if ((*functionNames)[i].empty()) {
+            functionRefs[i] = LUA_REFNIL;
+        }
+    }
+}
+
+/** Look up all functions of the preset once the script was executed.
+ *
+ */
+void resolveLuaFunctions(void)
+{
+    for (size_t i = 0; i < functionRefs.size(); i++) {
+        if (functionRefs[i] == LUA_NOREF) {
+            functionRefs[i] = resolveLuaFunction((*functionNames)[i].c_str());
+        }
+    }
+}
+
+int resolveLuaFunction(const char *name)
+{
+    lua_getglobal(L, name);
+
+    if (lua_isfunction(L, -1)) {
+        return (luaL_ref(L, LUA_REGISTRYINDEX));
+    }
+
+    lua_pop(L, 1);
+    return (LUA_NOREF);
+}
+
+/** Push the function to the Lua stack.
+ *  Functions missing at the time of loading are looked up by their name
+ *  so that functions defined later by the script are still found.
+ */
+static bool pushFunction(uint8_t functionId)
+{
+    if (functionId >= functionRefs.size()) {
+        return (false);
+    }
+
+    int &ref = functionRefs[functionId];
+
+    if (ref == LUA_NOREF) {
+        ref = resolveLuaFunction((*functionNames)[functionId].c_str());
+    }
+
+    if ((ref == LUA_NOREF) || (ref == LUA_REFNIL)) {
+        return (false);
+    }
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+    return (true);
+}
+
+void runFormatter(uint8_t formatterId,
                   const void *object,
                   int16_t value,
                   char *buffer,
                   int maxLength)
 {
     int stackSize = lua_gettop(L);
-    lua_getglobal(L, formatter);
 
-    if (lua_isfunction(L, -1)) {
+    if (pushFunction(formatterId)) {
         luaLE_pushObject(L, "ControlValue", object);
         lua_pushnumber(L, value);
 
@@ -33,19 +104,14 @@ void runFormatter(const char *formatter,
             System::logger.write(
                 LOG_LUA, "function 'runFormatter' does not return value");
         }
-    } else {
-        // Remove entry inserted with the lua_getglobal
-        lua_pop(L, 1);
     }
 
     luaLE_postFunctionCleanUp(L);
 }
 
-void runFunction(const char *function, const void *object, int16_t value)
+void runFunction(uint8_t functionId, const void *object, int16_t value)
 {
-    lua_getglobal(L, function);
-
-    if (lua_isfunction(L, -1)) {
+    if (pushFunction(functionId)) {
         luaLE_pushObject(L, "ControlValue", object);
         lua_pushnumber(L, value);
 
@@ -54,23 +120,18 @@ void runFunction(const char *function, const void *object, int16_t value)
                                  "error running function 'runFunction': %s",
                                  lua_tostring(L, -1));
         }
-    } else {
-        // Remove entry inserted with the lua_getglobal
-        lua_pop(L, 1);
     }
 
     luaLE_postFunctionCleanUp(L);
 }
 
 uint8_t
-    runTemplateFunction(const char *function, const void *object, int16_t value)
+    runTemplateFunction(uint8_t functionId, const void *object, int16_t value)
 {
     int stackSize = lua_gettop(L);
     uint8_t dataOut = 0;
 
-    lua_getglobal(L, function);
-
-    if (lua_isfunction(L, -1)) {
+    if (pushFunction(functionId)) {
         luaLE_pushObject(L, "Device", object);
         lua_pushnumber(L, value);
 
@@ -92,9 +153,6 @@ uint8_t
                 LOG_ERROR,
                 "function 'runTemplateFunction' does not return value");
         }
-    } else {
-        // Remove entry inserted with the lua_getglobal
-        lua_pop(L, 1);
     }
 
     luaLE_postFunctionCleanUp(L);
@@ -6,13 +6,19 @@ extern "C" {
 #include "lualib.h"
 }
 #include "luaIntegration.h"
+#include <string>
+#include <vector>
 
-void runFormatter(const char *formatter,
+void resetLuaFunctions(const std::vector<std::string> &newFunctionNames);
+void resolveLuaFunctions(void);
+int resolveLuaFunction(const char *name);
+
+void runFormatter(uint8_t formatterId,
                   const void *object,
                   int16_t value,
                   char *buffer,
                   int maxLength);
-void runFunction(const char *function, const void *object, int16_t value);
-uint8_t runTemplateFunction(const char *function,
+void runFunction(uint8_t functionId, const void *object, int16_t value);
+uint8_t runTemplateFunction(uint8_t functionId,
                             const void *object,
                             int16_t value);
@@ -92,6 +92,8 @@ int overlay_createNew(lua_State *L)
         lua_pop(L, 1);
     }
 
+    overlay.buildIndex();
+
     luaLE_pushObject(L, "Overlay", &overlay);
     return (1);
 }
@@ -4,6 +4,7 @@
 #include "luaHooks.h"
 #include "luaPatch.h"
 #include "ParameterMap.h"
+#include "ControllerLog.h"
 
 #include "App.h"
 
@@ -12,52 +13,217 @@ CircularBuffer<PatchRequest, 32> patchRequests;
 /** Constructor
  *
  */
-Midi::Midi(const Preset &preset) : model(preset)
+Midi::Midi(const Preset &preset) : model(preset), outputEncoderStale(false)
 {
 }
 
 /** Send Electra message to Midi outputs.
- *
+ *  Parameter values are sent at the rate of the device. When the device
+ *  is busy, the message is queued and a pending value of the same
+ *  parameter is replaced. Other messages are sent right away, after
+ *  the pending messages of the device, so that they keep their order.
  */
 void Midi::sendMessage(const Message &message)
 {
-    Device device = model.getDevice(message.getDeviceId());
+    const Device &device = model.getDevice(message.getDeviceId());
 
     if (!device.isValid()) {
         return;
     }
 
+    uint8_t deviceId = device.getId();
+    uint32_t now = millis();
+
+    if (!OutputQueue::isCoalescable(message.getType())) {
+        flushDevice(device, now);
+        outputQueue.markSent(deviceId, now);
+        transmitMessage(device, message);
+        return;
+    }
+
+    if (!outputQueue.hasPending(deviceId)
+        && outputQueue.isDue(deviceId, device.getRate(), now)) {
+        outputQueue.markSent(deviceId, now);
+        transmitMessage(device, message);
+        return;
+    }
+
+    if (!outputQueue.push(message)) {
+        // The queue is full, the oldest message is sent ahead of the rate
+        Message oldest;
+
+        outputQueue.pop(deviceId, oldest);
+        outputQueue.markSent(deviceId, now);
+        transmitMessage(device, oldest);
+        outputQueue.push(message);
+        COUNT_EVENT(outputOverflow);
+    }
+}
+
+/** Send a list of messages at the rate of their devices.
+ *  Used for bulk updates, such as a snapshot recall, that would overflow
+ *  the output queues. The messages are kept until their device is due,
+ *  devices without a rate are paced at MinPacingInterval. Every message
+ *  carries the value of its parameter at the time it is sent.
+ */
+void Midi::sendMessageList(const std::vector<Message> &messages)
+{
+    pendingList.insert(pendingList.end(), messages.begin(), messages.end());
+    flushMessageList(millis());
+}
+
+/** Send the listed messages whose devices are due.
+ *  The messages of one device are sent in the order of the list.
+ */
+void Midi::flushMessageList(uint32_t now)
+{
+    size_t numKept = 0;
+
+    for (size_t i = 0; i < pendingList.size(); i++) {
+        Message &message = pendingList[i];
+        const Device &device = model.getDevice(message.getDeviceId());
+
+        if (!device.isValid()) {
+            continue;
+        }
+
+        uint8_t deviceId = device.getId();
+        uint16_t rate = device.getRate();
+
+        if (rate < MinPacingInterval) {
+            rate = MinPacingInterval;
+        }
+
+        if (outputQueue.hasPending(deviceId)
+            || !outputQueue.isDue(deviceId, rate, now)) {
+            pendingList[numKept++] = message;
+            continue;
+        }
+
+        uint16_t midiValue = parameterMap.getValue(
+            deviceId, message.getType(), message.getParameterNumber());
+
+        if (midiValue != MIDI_VALUE_DO_NOT_SEND) {
+            message.setValue(midiValue);
+            outputQueue.markSent(deviceId, now);
+            transmitMessage(device, message);
+        }
+    }
+
+    pendingList.resize(numKept);
+}
+
+/** Send pending messages of all devices that are due.
+ *
+ */
+void Midi::flushOutput(void)
+{
+    uint32_t now = millis();
+
+    outputQueue.getPendingDevices(pendingDevices);
+
+    for (const auto &deviceId : pendingDevices) {
+        const Device &device = model.getDevice(deviceId);
+
+        if (!device.isValid()) {
+            outputQueue.discard(deviceId);
+            continue;
+        }
+
+        if (outputQueue.isDue(deviceId, device.getRate(), now)) {
+            Message message;
+
+            if (outputQueue.pop(deviceId, message)) {
+                outputQueue.markSent(deviceId, now);
+                transmitMessage(device, message);
+            }
+        }
+    }
+
+    if (!pendingList.empty()) {
+        flushMessageList(now);
+    }
+}
+
+/** Send all pending messages of the device regardless of its rate.
+ *
+ */
+void Midi::flushDevice(const Device &device, uint32_t now)
+{
+    Message message;
+
+    while (outputQueue.pop(device.getId(), message)) {
+        outputQueue.markSent(device.getId(), now);
+        transmitMessage(device, message);
+    }
+}
+
+/** Write the message to the MIDI port of the device.
+ *
+ */
+void Midi::transmitMessage(const Device &device, const Message &message)
+{
     uint8_t channel = device.getChannel();
     uint8_t port = device.getPort();
     uint16_t midiValue = message.getValue();
 
-    // Set the timestamp of device last message to current time
-    device.setTsLastMessage();
+    COUNT_EVENT(outputSent);
 
     //message.print();
 
     // Send the particular MIDI message
     if (message.getType() == Message::Type::cc7) {
+        forgetControlChange(port, channel, message.getParameterNumber());
         sendControlChange(
             port, channel, message.getParameterNumber(), midiValue);
     } else if (message.getType() == Message::Type::cc14) {
-        sendControlChange14Bit(port,
-                               channel,
-                               message.getParameterNumber(),
-                               midiValue,
-                               message.getLsbFirst());
+        if (useCompactOutput(device)) {
+            sendCompactControlChange14Bit(port,
+                                          channel,
+                                          message.getParameterNumber(),
+                                          midiValue,
+                                          message.getLsbFirst());
+        } else {
+            forgetControlChange(port, channel, message.getParameterNumber());
+            sendControlChange14Bit(port,
+                                   channel,
+                                   message.getParameterNumber(),
+                                   midiValue,
+                                   message.getLsbFirst());
+        }
     } else if (message.getType() == Message::Type::relcc) {
+        forgetControlChange(port, channel, message.getParameterNumber());
         sendControlChange(
             port, channel, message.getParameterNumber(), midiValue);
     } else if (message.getType() == Message::Type::nrpn) {
-        sendNrpn(port,
-                 channel,
-                 message.getParameterNumber(),
-                 midiValue,
-                 message.getLsbFirst(),
-                 message.getResetRpn());
+        if (useCompactOutput(device) && !message.getResetRpn()) {
+            sendCompactParameter(port,
+                                 channel,
+                                 true,
+                                 message.getParameterNumber(),
+                                 midiValue,
+                                 message.getLsbFirst());
+        } else {
+            outputEncoder.deselect(port, channel);
+            sendNrpn(port,
+                     channel,
+                     message.getParameterNumber(),
+                     midiValue,
+                     message.getLsbFirst(),
+                     message.getResetRpn());
+        }
     } else if (message.getType() == Message::Type::rpn) {
-        sendRpn(port, channel, message.getParameterNumber(), midiValue);
+        if (useCompactOutput(device)) {
+            sendCompactParameter(port,
+                                 channel,
+                                 false,
+                                 message.getParameterNumber(),
+                                 midiValue,
+                                 false);
+        } else {
+            outputEncoder.deselect(port, channel);
+            sendRpn(port, channel, message.getParameterNumber(), midiValue);
+        }
     } else if (message.getType() == Message::Type::program) {
         sendProgramChange(port, channel, midiValue);
     } else if (message.getType() == Message::Type::note) {
@@ -97,7 +263,7 @@ void Midi::sendMessage(const Message &message)
  */
 void Midi::sendTemplatedSysex(const Device &device,
                               uint16_t parameterNumber,
-                              std::vector<uint8_t> data)
+                              const DataBytes &data)
 {
     const int maxSysexSize = 512;
 
@@ -122,11 +288,14 @@ void Midi::sendTemplatedSysex(const Device &device,
 
 /** Replace substitution variables with values
  *
+ * The template is walked in place in a single pass. Every template op
+ * produces exactly one output byte, the output is never longer than
+ * the template.
  */
-uint8_t Midi::transformMessage(uint16_t parameterNumber,
-                               const Device &device,
-                               std::vector<uint8_t> data,
-                               uint8_t *dataOut)
+uint16_t Midi::transformMessage(uint16_t parameterNumber,
+                                const Device &device,
+                                const DataBytes &data,
+                                uint8_t *dataOut)
 {
     uint16_t j = 0;
 
@@ -149,7 +318,7 @@ uint8_t Midi::transformMessage(uint16_t parameterNumber,
 void Midi::runVariable(uint16_t parameterNumber,
                        uint16_t &i,
                        uint16_t &j,
-                       std::vector<uint8_t> data,
+                       const DataBytes &data,
                        uint8_t *dataOut,
                        const Device &device)
 {
@@ -163,10 +332,17 @@ void Midi::runVariable(uint16_t parameterNumber,
     uint8_t byteToSend = 0;
     uint16_t parameterValue = 0;
     uint16_t mask = 0;
+    // type, parameterId LSB and MSB, pPos, bPos, size
+    const uint8_t ruleLength = 6;
 
     i++;
 
-    while ((data[i] != VARIABLE_END) && (i < 100)) {
+    while ((i < data.size()) && (data[i] != VARIABLE_END)) {
+        if (i + ruleLength > data.size()) {
+            LOG_ERROR_IN(sysex, "runVariable: truncated rule: position=%d", i);
+            i = data.size();
+            break;
+        }
         type = data[i];
         i++;
         parameterIdLSB = data[i];
@@ -201,7 +377,7 @@ void Midi::runVariable(uint16_t parameterNumber,
 void Midi::runParameter(uint16_t parameterNumber,
                         uint16_t &i,
                         uint16_t &j,
-                        std::vector<uint8_t> data,
+                        const DataBytes &data,
                         uint8_t *dataOut,
                         const Device &device)
 {
@@ -211,10 +387,17 @@ void Midi::runParameter(uint16_t parameterNumber,
     uint8_t byteToSend = 0;
     uint16_t parameterValue = 0;
     uint16_t mask = 0;
+    // pPos, bPos, size
+    const uint8_t ruleLength = 3;
 
     i++;
 
-    while ((data[i] != VARIABLE_END) && (i < 100)) {
+    while ((i < data.size()) && (data[i] != VARIABLE_END)) {
+        if (i + ruleLength > data.size()) {
+            LOG_ERROR_IN(sysex, "runParameter: truncated rule: position=%d", i);
+            i = data.size();
+            break;
+        }
         pPos = data[i];
         i++;
         bPos = data[i];
@@ -232,7 +415,7 @@ void Midi::runParameter(uint16_t parameterNumber,
 
 void Midi::runChecksum(uint16_t &i,
                        uint16_t &j,
-                       std::vector<uint8_t> data,
+                       const DataBytes &data,
                        uint8_t *dataOut,
                        const Device &device)
 {
@@ -257,8 +440,8 @@ void Midi::runChecksum(uint16_t &i,
     dataOut[j] = checksum & 0x7F;
     j++;
 
-    System::logger.write(
-        LOG_ERROR,
+    LOG_DEBUG_IN(
+        sysex,
         "Checksum calculation: algorithm=%d, start=%d, length=%d, checksum=%d",
         algorithm,
         start,
@@ -269,7 +452,7 @@ void Midi::runChecksum(uint16_t &i,
 void Midi::runLuaFunction(uint16_t parameterNumber,
                           uint16_t &i,
                           uint16_t &j,
-                          std::vector<uint8_t> data,
+                          const DataBytes &data,
                           uint8_t *dataOut,
                           const Device &device)
 {
@@ -279,18 +462,17 @@ void Midi::runLuaFunction(uint16_t parameterNumber,
     i++;
     uint8_t functionId = data[i];
 
-    System::logger.write(LOG_ERROR,
-                         "function: %d (%s)",
-                         functionId,
-                         model.luaFunctions[functionId].c_str());
+    LOG_DEBUG_IN(sysex,
+                 "function: %d (%s)",
+                 functionId,
+                 model.luaFunctions[functionId].c_str());
 
     parameterValue = parameterMap.getValue(
         device.getId(), Message::Type::sysex, parameterNumber);
 
-    if (L && (model.luaFunctions.size() > 0)) {
-        byteToSend = runTemplateFunction(model.luaFunctions[functionId].c_str(),
-                                         (void *)&device,
-                                         parameterValue);
+    if (L) {
+        byteToSend =
+            runTemplateFunction(functionId, (void *)&device, parameterValue);
     }
 
     dataOut[j] = byteToSend & 0x7F;
@@ -299,7 +481,7 @@ void Midi::runLuaFunction(uint16_t parameterNumber,
 
 void Midi::runConstant(uint16_t &i,
                        uint16_t &j,
-                       std::vector<uint8_t> data,
+                       const DataBytes &data,
                        uint8_t *dataOut,
                        const Device &device)
 {
@@ -312,9 +494,11 @@ void Midi::runConstant(uint16_t &i,
  */
 void Midi::process(const MidiInput &midiInput, const MidiMessage &midiMessage)
 {
-    Device device =
+    const Device &device =
         model.getDevice(midiInput.getPort(), midiMessage.getChannel());
 
+    COUNT_EVENT(midiIn);
+
     // Non-Channel messages (TODO: it ignores ports)
     if (!device.isValid()) {
         if (midiMessage.isMidiStart()) {
@@ -352,28 +536,31 @@ void Midi::process(const MidiInput &midiInput, const MidiMessage &midiMessage)
             processPitchBend(
                 deviceId, midiMessage.getData1(), midiMessage.getData2());
         } else {
-            System::logger.write(
-                LOG_INFO,
-                "Midi::processMidi: other midi message. ignoring it.");
+            COUNT_EVENT(midiOther);
+            LOG_TRACE_IN(midi,
+                         "Midi::processMidi: other midi message. ignoring it.");
         }
     }
 }
 
 void Midi::processStart(void)
 {
-    System::logger.write(LOG_ERROR, "Midi::processMidi: Start midi message");
+    COUNT_EVENT(midiRealtime);
+    LOG_DEBUG_IN(midi, "Midi::processMidi: Start midi message");
     parameterMap.setValue(0xff, Message::Type::start, 0, 0, Origin::midi);
 }
 
 void Midi::processStop(void)
 {
-    System::logger.write(LOG_ERROR, "Midi::processMidi: Stop midi message");
+    COUNT_EVENT(midiRealtime);
+    LOG_DEBUG_IN(midi, "Midi::processMidi: Stop midi message");
     parameterMap.setValue(0xff, Message::Type::stop, 0, 0, Origin::midi);
 }
 
 void Midi::processTuneRequest(void)
 {
-    System::logger.write(LOG_ERROR, "Midi::processMidi: Tune midi message");
+    COUNT_EVENT(midiRealtime);
+    LOG_DEBUG_IN(midi, "Midi::processMidi: Tune midi message");
     parameterMap.setValue(0xff, Message::Type::tune, 0, 0, Origin::midi);
 }
 
@@ -381,9 +568,10 @@ void Midi::processCc(uint8_t deviceId,
                      uint8_t midiParameterId,
                      uint8_t midiValue)
 {
-    System::logger.write(
-        LOG_ERROR,
-        "ElectraMidi: processMidi: Control change midi message: parameter=%d, value=%d",
+    COUNT_EVENT(midiCc);
+    LOG_TRACE_IN(
+        midi,
+        "Midi::processMidi: Control change midi message: parameter=%d, value=%d",
         midiParameterId,
         midiValue);
 
@@ -392,13 +580,14 @@ void Midi::processCc(uint8_t deviceId,
 
     if (rpnDetector.parseControllerMessage(
             deviceId, midiParameterId, midiValue, midiRpnMessage)) {
-        System::logger.write(LOG_ERROR,
-                             "Midi::processMidi: RPN detected: parameter=%d, "
-                             "value=%d, isNrpn=%d, is14bit=%d",
-                             midiRpnMessage.parameterNumber,
-                             midiRpnMessage.value,
-                             midiRpnMessage.isNrpn,
-                             midiRpnMessage.is14BitValue);
+        COUNT_EVENT(midiRpn);
+        LOG_DEBUG_IN(midi,
+                     "Midi::processMidi: RPN detected: parameter=%d, "
+                     "value=%d, isNrpn=%d, is14bit=%d",
+                     midiRpnMessage.parameterNumber,
+                     midiRpnMessage.value,
+                     midiRpnMessage.isNrpn,
+                     midiRpnMessage.is14BitValue);
 
         Message::Type messageType =
             (midiRpnMessage.isNrpn) ? Message::Type::nrpn : Message::Type::rpn;
@@ -415,8 +604,9 @@ void Midi::processCc(uint8_t deviceId,
 
     if (cc14Detector.parseControllerMessage(
             deviceId, midiParameterId, midiValue, midiCc14Message)) {
-        System::logger.write(
-            LOG_ERROR,
+        COUNT_EVENT(midiCc14);
+        LOG_DEBUG_IN(
+            midi,
             "Midi::processMidi: CC14 detected: parameter=%d, value=%d",
             midiCc14Message.parameterNumber,
             midiCc14Message.value);
@@ -439,8 +629,9 @@ void Midi::processNote(uint8_t deviceId,
 {
     uint8_t translatedVelocity =
         (midiType == MidiMessage::Type::NoteOn) ? velocity : 0;
-    System::logger.write(
-        LOG_ERROR,
+    COUNT_EVENT(midiNote);
+    LOG_TRACE_IN(
+        midi,
         "Midi::processMidi: note message: note=%d, velocity=%d",
         noteNumber,
         translatedVelocity);
@@ -453,17 +644,19 @@ void Midi::processNote(uint8_t deviceId,
 
 void Midi::processProgramChange(uint8_t deviceId, uint8_t programNumber)
 {
-    System::logger.write(LOG_ERROR,
-                         "Midi::processMidi: program message: program=%d",
-                         programNumber);
+    COUNT_EVENT(midiProgram);
+    LOG_TRACE_IN(midi,
+                 "Midi::processMidi: program message: program=%d",
+                 programNumber);
     parameterMap.setValue(
         deviceId, Message::Type::program, 0, programNumber, Origin::midi);
 }
 
 void Midi::processAfterTouchChannel(uint8_t deviceId, uint8_t pressure)
 {
-    System::logger.write(
-        LOG_ERROR,
+    COUNT_EVENT(midiAfterTouch);
+    LOG_TRACE_IN(
+        midi,
         "Midi::processMidi: aftertouch channel message: pressure=%d",
         pressure);
     parameterMap.setValue(
@@ -474,8 +667,9 @@ void Midi::processAfterTouchPoly(uint8_t deviceId,
                                  uint8_t noteNumber,
                                  uint8_t pressure)
 {
-    System::logger.write(
-        LOG_ERROR,
+    COUNT_EVENT(midiAfterTouch);
+    LOG_TRACE_IN(
+        midi,
         "Midi::processMidi: aftertouch poly message: noteNumber=%d, pressure=%d",
         noteNumber,
         pressure);
@@ -488,9 +682,10 @@ void Midi::processPitchBend(uint8_t deviceId,
                             uint8_t valueCoarse)
 {
     uint16_t midiValue = (valueCoarse << 7) | valueFine;
-    System::logger.write(LOG_ERROR,
-                         "Midi::processMidi: pitchbend message: midiValue=%d",
-                         midiValue);
+    COUNT_EVENT(midiPitchBend);
+    LOG_TRACE_IN(midi,
+                 "Midi::processMidi: pitchbend message: midiValue=%d",
+                 midiValue);
     parameterMap.setValue(
         deviceId, Message::Type::pitchbend, 0, midiValue, Origin::midi);
 }
@@ -498,12 +693,17 @@ void Midi::processPitchBend(uint8_t deviceId,
 void Midi::processSongPosition(uint8_t valueFine, uint8_t valueCoarse)
 {
     uint16_t midiValue = (valueCoarse << 7) | valueFine;
-    System::logger.write(
-        LOG_ERROR,
+    COUNT_EVENT(midiRealtime);
+    LOG_TRACE_IN(
+        midi,
         "Midi::processMidi: song position message: midiValue=%d",
         midiValue);
     parameterMap.setValue(0xff, Message::Type::spp, 0, midiValue, Origin::midi);
-    parameterMap.print();
+
+    if constexpr (ControllerLog::isEnabled(ControllerLog::midi,
+                                           ControllerLog::trace)) {
+        parameterMap.print();
+    }
 }
 
 void Midi::processSysex(const MidiMessage &midiMessage)
@@ -514,6 +714,12 @@ void Midi::processSysex(const MidiMessage &midiMessage)
         return;
     }
 
+    COUNT_EVENT(sysexIn);
+
+    // Candidates are sorted in the order of devices and their responses
+    model.responseIndex.findCandidates(sysexBlock, responseCandidates);
+    size_t candidate = 0;
+
     for (const auto &[id, device] : model.devices) {
         for (const auto &[messageId, sysexMessage] : device.sysexMessages) {
             if (id < 100) { // only for user defined messages
@@ -523,10 +729,19 @@ void Midi::processSysex(const MidiMessage &midiMessage)
             }
         }
 
-        for (const auto &response : device.responses) {
-            if (processResponse(response, device, sysexBlock)) {
+        // Each device takes the first of its responses that matches
+        bool matched = false;
+
+        for (; candidate < responseCandidates.size(); candidate++) {
+            const ResponseIndex::Entry &entry =
+                model.responseIndex.getEntry(responseCandidates[candidate]);
+
+            if (entry.device != &device) {
                 break;
             }
+            if (!matched && processResponse(entry, sysexBlock)) {
+                matched = true;
+            }
         }
     }
 }
@@ -554,12 +769,12 @@ bool Midi::processSysexData(const DataBytes &sysexMessage,
             bPos = sysexMessage[j + 2];
             size = sysexMessage[j + 3];
             mask = createMask(bPos, size);
-            System::logger.write(LOG_TRACE,
-                                 "pPos=%d, bPos=%d, size=%d, mask=%02x",
-                                 pPos,
-                                 bPos,
-                                 size,
-                                 mask);
+            LOG_TRACE_IN(sysex,
+                         "pPos=%d, bPos=%d, size=%d, mask=%02x",
+                         pPos,
+                         bPos,
+                         size,
+                         mask);
             parameterNumber |= (((receivedByte & mask) >> bPos) << pPos);
             j += 4;
         } else if (sysexMessage[j] == VARIABLE_DATA) {
@@ -567,12 +782,12 @@ bool Midi::processSysexData(const DataBytes &sysexMessage,
             bPos = sysexMessage[j + 5];
             size = sysexMessage[j + 6];
             mask = createMask(bPos, size);
-            System::logger.write(LOG_TRACE,
-                                 "pPos=%d, bPos=%d, size=%d, mask=%02x",
-                                 pPos,
-                                 bPos,
-                                 size,
-                                 mask);
+            LOG_TRACE_IN(sysex,
+                         "pPos=%d, bPos=%d, size=%d, mask=%02x",
+                         pPos,
+                         bPos,
+                         size,
+                         mask);
             value |= (((receivedByte & mask) >> bPos) << pPos);
             j += 7;
         } else if (receivedByte == 0xF7) {
@@ -589,8 +804,9 @@ bool Midi::processSysexData(const DataBytes &sysexMessage,
                               parameterNumber,
                               value,
                               Origin::midi);
-        System::logger.write(
-            LOG_ERROR,
+        COUNT_EVENT(sysexMatched);
+        LOG_DEBUG_IN(
+            sysex,
             "Midi::processSysexData: updating parameter value: "
             "parameterNumber=%d, value=%d",
             parameterNumber,
@@ -600,43 +816,51 @@ bool Midi::processSysexData(const DataBytes &sysexMessage,
     return (false);
 }
 
-bool Midi::processResponse(const Response &response,
-                           const Device &device,
+bool Midi::processResponse(const ResponseIndex::Entry &entry,
                            SysexBlock &sysexBlock)
 {
-    // \todo this can easily overflow the buffer
-    uint8_t header[64];
-    uint8_t headerLength = 0;
-    // \todo the parameterNumber 0 does not belong here
-    headerLength = transformMessage(0, device, response.headers, header);
+    const Device &device = *entry.device;
+    const Response &response = *entry.response;
 
-    if (doesHeaderMatch(sysexBlock, header, headerLength) == true) {
-        System::logger.write(
-            LOG_ERROR,
-            "Midi::processSysex: matched response: responseId=%d",
-            response.getId());
+    // Headers with variables are rendered only when their prefix matched
+    if (!entry.isStatic) {
+        if (headerBuffer.size() < entry.headerLength) {
+            headerBuffer.resize(model.responseIndex.getMaxHeaderLength());
+        }
 
-        resetRulesValues(device, response.rules);
-        applyRulesValues(device, response.rules, sysexBlock, headerLength);
+        // \todo the parameterNumber 0 does not belong here
+        transformMessage(0, device, response.headers, headerBuffer.data());
 
-        // Run Lua onResponse function
-        if (L) {
-            runOnResponse(device, response.getId(), sysexBlock);
+        if (!doesHeaderMatch(
+                sysexBlock, headerBuffer.data(), entry.headerLength)) {
+            return (false);
         }
-        return (true);
     }
-    return (false);
+
+    COUNT_EVENT(responseMatched);
+    LOG_DEBUG_IN(sysex,
+                 "Midi::processSysex: matched response: responseId=%d",
+                 response.getId());
+
+    resetRulesValues(device, response.rules);
+    applyRulesValues(device, response.rules, sysexBlock, entry.headerLength);
+
+    // Run Lua onResponse function
+    if (L) {
+        runOnResponse(device, response.getId(), sysexBlock);
+    }
+    return (true);
 }
 
 bool Midi::doesHeaderMatch(const SysexBlock &sysexBlock,
-                           uint8_t header[],
-                           uint8_t headerLength)
+                           const uint8_t *header,
+                           uint16_t headerLength)
 {
     bool match = true;
     auto sysexLength = sysexBlock.getLength();
 
     if (sysexLength > headerLength) {
-        for (uint8_t i = 0; i < headerLength; i++) {
+        for (uint16_t i = 0; i < headerLength; i++) {
             if (header[i] != sysexBlock.peek(i)) {
                 match = false;
                 break;
@@ -681,9 +905,11 @@ void Midi::applyRulesValues(const Device &device,
                                           parameterValue,
                                           Origin::midi);
 
+            COUNT_EVENT(rulesApplied);
+
             if (entry) {
-                System::logger.write(
-                    LOG_ERROR,
+                LOG_TRACE_IN(
+                    sysex,
                     "Midi::applyRulesValues: applying extraction rule: byte=%d, "
                     "byteValue=%d, extractedValue=%d to parameterNumber=%d, type=%s "
                     "resulting in parameterValue=%d",
@@ -735,6 +961,106 @@ void Midi::sendControlChange14Bit(uint8_t port,
                                        lsbFirst);
 }
 
+/** Send NRPN or RPN value, the parameter select messages are sent only
+ *  when the parameter differs from the one selected last on the channel.
+ */
+void Midi::sendCompactParameter(uint8_t port,
+                                uint8_t channel,
+                                bool isNrpn,
+                                uint16_t parameterNumber,
+                                uint16_t midiValue,
+                                bool lsbFirst)
+{
+    if (!outputEncoder.isSelected(port, channel, isNrpn, parameterNumber)) {
+        sendControlChange(
+            port, channel, isNrpn ? 99 : 101, (parameterNumber >> 7) & 0x7F);
+        sendControlChange(
+            port, channel, isNrpn ? 98 : 100, parameterNumber & 0x7F);
+        outputEncoder.select(port, channel, isNrpn, parameterNumber);
+    } else {
+        COUNT_EVENT(outputElided);
+    }
+
+    uint8_t msb = (midiValue >> 7) & 0x7F;
+    uint8_t lsb = midiValue & 0x7F;
+
+    if (lsbFirst) {
+        sendControlChange(port, channel, 38, lsb);
+        sendControlChange(port, channel, 6, msb);
+    } else {
+        sendControlChange(port, channel, 6, msb);
+        sendControlChange(port, channel, 38, lsb);
+    }
+}
+
+/** Send 14-bit CC value, the MSB is sent only when it has changed.
+ *  Devices that expect the LSB first always get both bytes.
+ */
+void Midi::sendCompactControlChange14Bit(uint8_t port,
+                                         uint8_t channel,
+                                         uint16_t parameterNumber,
+                                         uint16_t midiValue,
+                                         bool lsbFirst)
+{
+    uint8_t msb = (midiValue >> 7) & 0x7F;
+    uint8_t lsb = midiValue & 0x7F;
+
+    if (!lsbFirst && (parameterNumber < 32)
+        && outputEncoder.isMsbSent(port, channel, parameterNumber, msb)) {
+        sendControlChange(port, channel, parameterNumber + 32, lsb);
+        COUNT_EVENT(outputElided);
+        return;
+    }
+
+    sendControlChange14Bit(port, channel, parameterNumber, midiValue, lsbFirst);
+    outputEncoder.setMsbSent(port, channel, parameterNumber, msb);
+}
+
+/** Update the output encoder state after a plain CC was sent.
+ *
+ */
+void Midi::forgetControlChange(uint8_t port,
+                               uint8_t channel,
+                               uint16_t controllerNumber)
+{
+    if ((98 <= controllerNumber) && (controllerNumber <= 101)) {
+        outputEncoder.deselect(port, channel);
+    } else if (controllerNumber < 32) {
+        outputEncoder.forgetMsb(port, channel, controllerNumber);
+    }
+}
+
+/** Returns true when redundant messages to the device can be skipped.
+ *  Lua scripts send MIDI with the midi library of the framework, which
+ *  bypasses the output encoder. The messages are therefore compacted
+ *  only while no script is loaded, the state of the receivers is
+ *  forgotten once a script has been running.
+ */
+bool Midi::useCompactOutput(const Device &device)
+{
+    if (L) {
+        outputEncoderStale = true;
+        return (false);
+    }
+
+    if (outputEncoderStale) {
+        outputEncoder.reset();
+        outputEncoderStale = false;
+    }
+
+    return (device.hasCompactOutput());
+}
+
+/** Forget the state of the receivers and all pending output.
+ *  Used when the preset, and therefore the devices, change.
+ */
+void Midi::resetOutput(void)
+{
+    outputEncoder.reset();
+    outputQueue.clear();
+    pendingList.clear();
+}
+
 void Midi::sendNrpn(uint8_t port,
                     uint8_t channel,
                     uint16_t parameterNumber,
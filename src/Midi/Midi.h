@@ -9,13 +9,15 @@
 #include "Preset.h"
 #include "Cc14Detector.h"
 #include "RpnDetector.h"
+#include "OutputQueue.h"
+#include "OutputEncoder.h"
 
 struct PatchRequest {
     PatchRequest() : port(0), deviceId(0)
     {
     }
 
-    PatchRequest(uint8_t port, uint8_t deviceId, std::vector<uint8_t> data)
+    PatchRequest(uint8_t port, uint8_t deviceId, const DataBytes &data)
         : port(port), deviceId(deviceId), data(data)
     {
     }
@@ -36,43 +38,73 @@ public:
     virtual ~Midi() = default;
 
     void sendMessage(const Message &message);
+    void sendMessageList(const std::vector<Message> &messages);
+    void flushOutput(void);
+    void resetOutput(void);
     void sendTemplatedSysex(const Device &device,
                             uint16_t parameterNumber,
-                            std::vector<uint8_t> data);
+                            const DataBytes &data);
     void process(const MidiInput &midiInput, const MidiMessage &midiMessage);
     void requestAllPatches(void);
 
+    /**
+     * @brief Forgets the output state a control change sent by another
+     *  sender than the Midi output affects
+     *
+     * @param port port the control change was sent to
+     * @param channel channel of the control change
+     * @param controllerNumber number of the controller
+     */
+    void forgetControlChange(uint8_t port,
+                             uint8_t channel,
+                             uint16_t controllerNumber);
+
 private:
-    uint8_t transformMessage(uint16_t parameterNumber,
-                             const Device &deviceId,
-                             std::vector<uint8_t> data,
-                             uint8_t *dataOut);
+    void flushDevice(const Device &device, uint32_t now);
+    void flushMessageList(uint32_t now);
+    void transmitMessage(const Device &device, const Message &message);
+    bool useCompactOutput(const Device &device);
+    void sendCompactParameter(uint8_t port,
+                              uint8_t channel,
+                              bool isNrpn,
+                              uint16_t parameterNumber,
+                              uint16_t midiValue,
+                              bool lsbFirst);
+    void sendCompactControlChange14Bit(uint8_t port,
+                                       uint8_t channel,
+                                       uint16_t parameterNumber,
+                                       uint16_t midiValue,
+                                       bool lsbFirst);
+    uint16_t transformMessage(uint16_t parameterNumber,
+                              const Device &deviceId,
+                              const DataBytes &data,
+                              uint8_t *dataOut);
     void runVariable(uint16_t parameterNumber,
                      uint16_t &i,
                      uint16_t &j,
-                     std::vector<uint8_t> data,
+                     const DataBytes &data,
                      uint8_t *dataOut,
                      const Device &device);
     void runParameter(uint16_t parameterNumber,
                       uint16_t &i,
                       uint16_t &j,
-                      std::vector<uint8_t> data,
+                      const DataBytes &data,
                       uint8_t *dataOut,
                       const Device &device);
     void runChecksum(uint16_t &i,
                      uint16_t &j,
-                     std::vector<uint8_t> data,
+                     const DataBytes &data,
                      uint8_t *dataOut,
                      const Device &device);
     void runLuaFunction(uint16_t parameterNumber,
                         uint16_t &i,
                         uint16_t &j,
-                        std::vector<uint8_t> data,
+                        const DataBytes &data,
                         uint8_t *dataOut,
                         const Device &device);
     void runConstant(uint16_t &i,
                      uint16_t &j,
-                     std::vector<uint8_t> data,
+                     const DataBytes &data,
                      uint8_t *dataOut,
                      const Device &device);
     void processStart(void);
@@ -98,13 +130,12 @@ private:
     bool processSysexData(const DataBytes &sysexMessage,
                           const Device &device,
                           SysexBlock &sysexBlock);
-    bool processResponse(const Response &response,
-                         const Device &device,
+    bool processResponse(const ResponseIndex::Entry &entry,
                          SysexBlock &sysexBlock);
 
     bool doesHeaderMatch(const SysexBlock &sysexBlock,
-                         uint8_t header[],
-                         uint8_t headerLength);
+                         const uint8_t *header,
+                         uint16_t headerLength);
     void resetRulesValues(const Device &device, const Rules rules);
     void applyRulesValues(const Device &device,
                           const Rules rules,
@@ -161,4 +192,16 @@ private:
 
     RpnDetector rpnDetector;
     Cc14Detector cc14Detector;
+
+    std::vector<uint16_t> responseCandidates;
+    std::vector<uint8_t> headerBuffer;
+
+    // Devices without a rate get at most one message per ms from a list
+    static constexpr uint16_t MinPacingInterval = 1;
+
+    OutputQueue outputQueue;
+    std::vector<Message> pendingList;
+    OutputEncoder outputEncoder;
+    bool outputEncoderStale;
+    std::vector<uint8_t> pendingDevices;
 };
@@ -2,9 +2,151 @@
 #include "luaMidi.h"
 #include "luaIntegration.h"
 #include "System.h"
+#include <cstring>
+
+/*
+ * Registry references of the Lua callbacks that are called for every
+ * incoming message. The functions are kept out of the midi table, the
+ * metatable of the table reads and assigns them through the references,
+ * so that the references follow when the script assigns other functions.
+ */
+static int onMessageRef = LUA_NOREF;
+static int onMessageDataRef = LUA_NOREF;
+static int onSysexRef = LUA_NOREF;
+
+static int *getCallbackRef(const char *function)
+{
+    if (strcmp(function, "onMessage") == 0) {
+        return (&onMessageRef);
+    } else if (strcmp(function, "onMessageData") == 0) {
+        return (&onMessageDataRef);
+    } else if (strcmp(function, "onSysex") == 0) {
+        return (&onSysexRef);
+    }
+    return (nullptr);
+}
+
+static void releaseCallbackRef(lua_State *L, int &ref)
+{
+    if (L && (ref != LUA_NOREF)) {
+        luaL_unref(L, LUA_REGISTRYINDEX, ref);
+    }
+    ref = LUA_NOREF;
+}
+
+/** Reference the function at the top of the stack, pops the value.
+ *
+ */
+static void assignCallbackRef(lua_State *L, int &ref)
+{
+    releaseCallbackRef(L, ref);
+
+    if (lua_isfunction(L, -1)) {
+        ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    } else {
+        lua_pop(L, 1);
+    }
+}
+
+static void updateReferencedCallbacks(void)
+{
+    MidiInputCallback::onMidiSysexCallback =
+        (onSysexRef != LUA_NOREF) ? &onMidiSysex : nullptr;
+    MidiInputCallback::onMidiMessageCallback =
+        ((onMessageRef != LUA_NOREF) || (onMessageDataRef != LUA_NOREF))
+            ? &onMidiMessage
+            : nullptr;
+}
+
+static int midi_indexCallback(lua_State *L)
+{
+    const char *function =
+        (lua_type(L, 2) == LUA_TSTRING) ? lua_tostring(L, 2) : nullptr;
+    int *ref = function ? getCallbackRef(function) : nullptr;
+
+    if (ref && (*ref != LUA_NOREF)) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, *ref);
+    } else {
+        lua_pushnil(L);
+    }
+    return (1);
+}
+
+static int midi_newIndexCallback(lua_State *L)
+{
+    const char *function =
+        (lua_type(L, 2) == LUA_TSTRING) ? lua_tostring(L, 2) : nullptr;
+    int *ref = function ? getCallbackRef(function) : nullptr;
+
+    if (!ref) {
+        lua_rawset(L, 1);
+        return (0);
+    }
+
+    lua_settop(L, 3);
+    assignCallbackRef(L, *ref);
+    updateReferencedCallbacks();
+
+    return (0);
+}
+
+/** Move the per-message callbacks from the midi table to the registry.
+ *  Falls back to references resolved once when the midi table already
+ *  has a metatable of its own.
+ */
+static void referenceMessageCallbacks(void)
+{
+    static const char *const functions[] = { "onMessage",
+                                              "onMessageData",
+                                              "onSysex" };
+    int stackSize = lua_gettop(L);
+
+    lua_getglobal(L, "midi");
+
+    if (!lua_istable(L, -1)) {
+        lua_settop(L, stackSize);
+        return;
+    }
+
+    bool hasProxy = true;
+
+    if (lua_getmetatable(L, -1)) {
+        lua_getfield(L, -1, "__newindex");
+        hasProxy = (lua_tocfunction(L, -1) == midi_newIndexCallback);
+        lua_pop(L, 2);
+    } else {
+        lua_newtable(L);
+        lua_pushcfunction(L, midi_indexCallback);
+        lua_setfield(L, -2, "__index");
+        lua_pushcfunction(L, midi_newIndexCallback);
+        lua_setfield(L, -2, "__newindex");
+        lua_setmetatable(L, -2);
+    }
+
+    for (const auto &function : functions) {
+        lua_getfield(L, -1, function);
+        assignCallbackRef(L, *getCallbackRef(function));
+
+        if (hasProxy) {
+            lua_pushstring(L, function);
+            lua_pushnil(L);
+            lua_rawset(L, -3);
+        }
+    }
+
+    if (!hasProxy) {
+        System::logger.write(
+            LOG_ERROR,
+            "midi table has a metatable, message callbacks are fixed");
+    }
+
+    lua_settop(L, stackSize);
+}
 
 void assignLuaCallbacks(void)
 {
+    referenceMessageCallbacks();
+
     if (luaLE_functionExists("midi", "onClock")) {
         System::logger.write(LOG_ERROR, "lua callback assigned: onClock");
         MidiInputCallback::onMidiClockCallback = &onMidiClock;
@@ -92,15 +234,18 @@ void assignLuaCallbacks(void)
         MidiInputCallback::onMidiAfterTouchPolyCallback = &onMidiAfterTouchPoly;
     }
 
-    if (luaLE_functionExists("midi", "onSysex")) {
+    if (onSysexRef != LUA_NOREF) {
         System::logger.write(LOG_ERROR, "lua callback assigned: onSysex");
-        MidiInputCallback::onMidiSysexCallback = &onMidiSysex;
     }
 
-    if (luaLE_functionExists("midi", "onMessage")) {
-        System::logger.write(LOG_ERROR, "lua callback assigned: onMessage");
-        MidiInputCallback::onMidiMessageCallback = &onMidiMessage;
+    if ((onMessageRef != LUA_NOREF) || (onMessageDataRef != LUA_NOREF)) {
+        System::logger.write(LOG_ERROR,
+                             "lua callback assigned: %s",
+                             (onMessageDataRef != LUA_NOREF) ? "onMessageData"
+                                                             : "onMessage");
     }
+
+    updateReferencedCallbacks();
 }
 
 void resetMidiCallbacks(void)
@@ -123,6 +268,11 @@ void resetMidiCallbacks(void)
     MidiInputCallback::onMidiAfterTouchPolyCallback = nullptr;
     MidiInputCallback::onMidiSysexCallback = nullptr;
     MidiInputCallback::onMidiMessageCallback = nullptr;
+
+    // Must be called before the Lua state is closed
+    releaseCallbackRef(L, onMessageRef);
+    releaseCallbackRef(L, onMessageDataRef);
+    releaseCallbackRef(L, onSysexRef);
 }
 
 /*
@@ -243,100 +393,134 @@ void onMidiAfterTouchPoly(MidiInput midiInput,
 
 void onMidiSysex(MidiInput &midiInput, MidiMessage &midiMessage)
 {
-    luaLE_getModuleFunction("midi", "onSysex");
+    if (onSysexRef == LUA_NOREF) {
+        return;
+    }
 
-    if (lua_isfunction(L, -1)) {
+    lua_rawgeti(L, LUA_REGISTRYINDEX, onSysexRef);
+
+    SysexBlock sysexBlock = midiMessage.getSysExBlock();
+    lua_newtable(L);
+    luaLE_pushTableInteger(
+        L, "interface", (uint8_t)midiInput.getInterfaceType());
+    luaLE_pushTableInteger(L, "port", midiInput.getPort());
+    luaLE_pushObject(L, "SysexBlock", &sysexBlock);
+
+    if (lua_pcall(L, 2, 0, 0) != 0) {
+        System::logger.write(LOG_ERROR,
+                             "error running function 'onSysex': %s",
+                             lua_tostring(L, -1));
+    }
+    luaLE_postFunctionCleanUp(L);
+}
+
+/** Pass the message to midi.onMessageData as plain integers.
+ *  No Lua tables are created, so a busy MIDI stream does not keep
+ *  the garbage collector running.
+ */
+static void onMidiMessageData(MidiInput &midiInput, MidiMessage &midiMessage)
+{
+    lua_rawgeti(L, LUA_REGISTRYINDEX, onMessageDataRef);
+
+    lua_pushinteger(L, (uint8_t)midiInput.getInterfaceType());
+    lua_pushinteger(L, midiInput.getPort());
+    lua_pushinteger(L, (uint8_t)midiMessage.getType());
+    lua_pushinteger(L, midiMessage.getChannel());
+    lua_pushinteger(L, midiMessage.getData1());
+    lua_pushinteger(L, midiMessage.getData2());
+
+    if (lua_pcall(L, 6, 0, 0) != 0) {
+        System::logger.write(LOG_ERROR,
+                             "error running function 'midi.onMessageData': %s",
+                             lua_tostring(L, -1));
+    }
+    luaLE_postFunctionCleanUp(L);
+}
+
+void onMidiMessage(MidiInput &midiInput, MidiMessage &midiMessage)
+{
+    if ((onMessageDataRef != LUA_NOREF) && !midiMessage.isSysEx()) {
+        onMidiMessageData(midiInput, midiMessage);
+        return;
+    }
+
+    if (onMessageRef == LUA_NOREF) {
+        return;
+    }
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, onMessageRef);
+
+    if (midiMessage.isSysEx()) {
         SysexBlock sysexBlock = midiMessage.getSysExBlock();
+        MidiMessage::Type type = MidiMessage::Type::SystemExclusive;
+
         lua_newtable(L);
         luaLE_pushTableInteger(
             L, "interface", (uint8_t)midiInput.getInterfaceType());
         luaLE_pushTableInteger(L, "port", midiInput.getPort());
-        luaLE_pushObject(L, "SysexBlock", &sysexBlock);
+
+        lua_newtable(L);
+        luaLE_pushTableInteger(L, "type", (uint8_t)type);
+        luaLE_pushTableObject(L, "sysexBlock", "SysexBlock", &sysexBlock);
 
         if (lua_pcall(L, 2, 0, 0) != 0) {
-            System::logger.write(LOG_ERROR,
-                                 "error running function 'onSysex': %s",
-                                 lua_tostring(L, -1));
+            System::logger.write(
+                LOG_ERROR,
+                "error running function 'midi.onMessage': %s",
+                lua_tostring(L, -1));
         }
-    }
-}
+    } else {
+        lua_newtable(L);
+        luaLE_pushTableInteger(
+            L, "interface", (uint8_t)midiInput.getInterfaceType());
+        luaLE_pushTableInteger(L, "port", midiInput.getPort());
 
-void onMidiMessage(MidiInput &midiInput, MidiMessage &midiMessage)
-{
-    luaLE_getModuleFunction("midi", "onMessage");
+        MidiMessage::Type type = midiMessage.getType();
 
-    if (lua_isfunction(L, -1)) {
-        if (midiMessage.isSysEx()) {
-            SysexBlock sysexBlock = midiMessage.getSysExBlock();
-            MidiMessage::Type type = MidiMessage::Type::SystemExclusive;
+        lua_newtable(L);
+        luaLE_pushTableInteger(L, "channel", midiMessage.getChannel());
+        luaLE_pushTableInteger(L, "type", (uint8_t)type);
+        luaLE_pushTableInteger(L, "data1", midiMessage.getData1());
+        luaLE_pushTableInteger(L, "data2", midiMessage.getData2());
 
-            lua_newtable(L);
+        if (type == MidiMessage::Type::ControlChange) {
             luaLE_pushTableInteger(
-                L, "interface", (uint8_t)midiInput.getInterfaceType());
-            luaLE_pushTableInteger(L, "port", midiInput.getPort());
-
-            lua_newtable(L);
-            luaLE_pushTableInteger(L, "type", (uint8_t)type);
-            luaLE_pushTableObject(L, "sysexBlock", "SysexBlock", &sysexBlock);
-
-            if (lua_pcall(L, 2, 0, 0) != 0) {
-                System::logger.write(
-                    LOG_ERROR,
-                    "error running function 'midi.onMessage': %s",
-                    lua_tostring(L, -1));
-            }
-        } else {
-            lua_newtable(L);
+                L, "controllerNumber", midiMessage.getData1());
+            luaLE_pushTableInteger(L, "value", midiMessage.getData2());
+        } else if (type == MidiMessage::Type::NoteOn) {
+            luaLE_pushTableInteger(L, "noteNumber", midiMessage.getData1());
+            luaLE_pushTableInteger(L, "velocity", midiMessage.getData2());
+        } else if (type == MidiMessage::Type::NoteOff) {
+            luaLE_pushTableInteger(L, "noteNumber", midiMessage.getData1());
+            luaLE_pushTableInteger(L, "velocity", midiMessage.getData2());
+        } else if (type == MidiMessage::Type::AfterTouchPoly) {
+            luaLE_pushTableInteger(L, "noteNumber", midiMessage.getData1());
+            luaLE_pushTableInteger(L, "pressure", midiMessage.getData2());
+        } else if (type == MidiMessage::Type::ProgramChange) {
             luaLE_pushTableInteger(
-                L, "interface", (uint8_t)midiInput.getInterfaceType());
-            luaLE_pushTableInteger(L, "port", midiInput.getPort());
-
-            MidiMessage::Type type = midiMessage.getType();
-
-            lua_newtable(L);
-            luaLE_pushTableInteger(L, "channel", midiMessage.getChannel());
-            luaLE_pushTableInteger(L, "type", (uint8_t)type);
-            luaLE_pushTableInteger(L, "data1", midiMessage.getData1());
-            luaLE_pushTableInteger(L, "data2", midiMessage.getData2());
-
-            if (type == MidiMessage::Type::ControlChange) {
-                luaLE_pushTableInteger(
-                    L, "controllerNumber", midiMessage.getData1());
-                luaLE_pushTableInteger(L, "value", midiMessage.getData2());
-            } else if (type == MidiMessage::Type::NoteOn) {
-                luaLE_pushTableInteger(L, "noteNumber", midiMessage.getData1());
-                luaLE_pushTableInteger(L, "velocity", midiMessage.getData2());
-            } else if (type == MidiMessage::Type::NoteOff) {
-                luaLE_pushTableInteger(L, "noteNumber", midiMessage.getData1());
-                luaLE_pushTableInteger(L, "velocity", midiMessage.getData2());
-            } else if (type == MidiMessage::Type::AfterTouchPoly) {
-                luaLE_pushTableInteger(L, "noteNumber", midiMessage.getData1());
-                luaLE_pushTableInteger(L, "pressure", midiMessage.getData2());
-            } else if (type == MidiMessage::Type::ProgramChange) {
-                luaLE_pushTableInteger(
-                    L, "programNumber", midiMessage.getData1());
-            } else if (type == MidiMessage::Type::SongSelect) {
-                luaLE_pushTableInteger(L, "songNumber", midiMessage.getData1());
-            } else if (type == MidiMessage::Type::AfterTouchChannel) {
-                luaLE_pushTableInteger(L, "pressure", midiMessage.getData1());
-            } else if (type == MidiMessage::Type::PitchBend) {
-                luaLE_pushTableInteger(L,
-                                       "value",
-                                       midiMessage.getData1()
-                                           | midiMessage.getData2() << 7);
-            } else if (type == MidiMessage::Type::SongPosition) {
-                luaLE_pushTableInteger(L,
-                                       "position",
-                                       midiMessage.getData1()
-                                           | midiMessage.getData2() << 7);
-            }
-
-            if (lua_pcall(L, 2, 0, 0) != 0) {
-                System::logger.write(
-                    LOG_ERROR,
-                    "error running function 'midi.onMessage': %s",
-                    lua_tostring(L, -1));
-            }
+                L, "programNumber", midiMessage.getData1());
+        } else if (type == MidiMessage::Type::SongSelect) {
+            luaLE_pushTableInteger(L, "songNumber", midiMessage.getData1());
+        } else if (type == MidiMessage::Type::AfterTouchChannel) {
+            luaLE_pushTableInteger(L, "pressure", midiMessage.getData1());
+        } else if (type == MidiMessage::Type::PitchBend) {
+            luaLE_pushTableInteger(L,
+                                   "value",
+                                   midiMessage.getData1()
+                                       | midiMessage.getData2() << 7);
+        } else if (type == MidiMessage::Type::SongPosition) {
+            luaLE_pushTableInteger(L,
+                                   "position",
+                                   midiMessage.getData1()
+                                       | midiMessage.getData2() << 7);
+        }
+
+        if (lua_pcall(L, 2, 0, 0) != 0) {
+            System::logger.write(
+                LOG_ERROR,
+                "error running function 'midi.onMessage': %s",
+                lua_tostring(L, -1));
         }
     }
+    luaLE_postFunctionCleanUp(L);
 }
@@ -1,4 +1,5 @@
 #include "MidiLearn.h"
+#include "ControllerLog.h"
 
 void MidiLearn::process(const MidiInput &midiInput,
                         const MidiMessage &midiMessage)
@@ -12,13 +13,11 @@ void MidiLearn::process(const MidiInput &midiInput,
 
     Device midiLearnDevice(MidiLearnDeviceId, "ml", midiPort, midiChannel, 0);
 
-#ifdef DEBUG
-    System::logger.write(
-        LOG_ERROR,
+    LOG_TRACE_IN(
+        learn,
         "ElectraMidi::processMidiLearn: getting a device: port=%d, channel=%d",
         midiPort,
         midiChannel);
-#endif
 
     if (midiType == MidiMessage::Type::ControlChange) {
         uint8_t midiParameterId = midiMessage.getData1();
@@ -30,8 +29,8 @@ void MidiLearn::process(const MidiInput &midiInput,
 
         if (rpnDetector.parseControllerMessage(
                 device.getId(), midiParameterId, midiValue, midiRpnMessage)) {
-            System::logger.write(
-                LOG_ERROR,
+            LOG_DEBUG_IN(
+                learn,
                 "ElectraMidi::processMidiLearn: RPN detected: parameter=%d, "
                 "value=%d, isNrpn=%d, is14bit=%d",
                 midiRpnMessage.parameterNumber,
@@ -68,8 +67,8 @@ void MidiLearn::process(const MidiInput &midiInput,
 
         if (cc14Detector.parseControllerMessage(
                 device.getId(), midiParameterId, midiValue, midiCc14Message)) {
-            System::logger.write(
-                LOG_ERROR,
+            LOG_DEBUG_IN(
+                learn,
                 "ElectraMidi::processMidiLearn: CC14 detected: parameter=%d, value=%d",
                 midiCc14Message.parameterNumber,
                 midiCc14Message.value);
@@ -97,8 +96,8 @@ void MidiLearn::process(const MidiInput &midiInput,
                || (midiType == MidiMessage::Type::NoteOff)) {
         uint8_t midiNoteNr = midiMessage.getData1();
         uint8_t value = (midiType == MidiMessage::Type::NoteOn) ? 127 : 0;
-        System::logger.write(
-            LOG_ERROR,
+        LOG_DEBUG_IN(
+            learn,
             "ElectraMidi::processMidiLearn: note message: note=%d",
             midiNoteNr);
         MidiOutput::sendMidiLearn(MidiInterface::Type::MidiUsbDev,
@@ -111,8 +110,8 @@ void MidiLearn::process(const MidiInput &midiInput,
         return;
     } else if (midiType == MidiMessage::Type::ProgramChange) {
         uint8_t programNumber = midiMessage.getData1();
-        System::logger.write(
-            LOG_ERROR,
+        LOG_DEBUG_IN(
+            learn,
             "ElectraMidi::processMidiLearn: program message: program=%d",
             programNumber);
         MidiOutput::sendMidiLearn(MidiInterface::Type::MidiUsbDev,
@@ -126,8 +125,8 @@ void MidiLearn::process(const MidiInput &midiInput,
     } else if (midiType == MidiMessage::Type::AfterTouchPoly) {
         uint8_t noteNumber = midiMessage.getData1();
         uint8_t pressure = midiMessage.getData2();
-        System::logger.write(
-            LOG_ERROR,
+        LOG_DEBUG_IN(
+            learn,
             "ElectraMidi::processMidiLearn: aftertouch poly message: "
             "program=%d, pressure=%d",
             noteNumber,
@@ -142,8 +141,8 @@ void MidiLearn::process(const MidiInput &midiInput,
         return;
     } else if (midiType == MidiMessage::Type::AfterTouchChannel) {
         uint8_t pressure = midiMessage.getData1();
-        System::logger.write(
-            LOG_ERROR,
+        LOG_DEBUG_IN(
+            learn,
             "ElectraMidi::processMidiLearn: aftertouch channel message: "
             "pressure=%d",
             pressure);
@@ -157,8 +156,8 @@ void MidiLearn::process(const MidiInput &midiInput,
         return;
     } else if (midiType == MidiMessage::Type::PitchBend) {
         uint16_t value = midiMessage.getData2() << 7 | midiMessage.getData1();
-        System::logger.write(
-            LOG_ERROR,
+        LOG_DEBUG_IN(
+            learn,
             "ElectraMidi::processMidiLearn: pitchbend message: "
             "value=%d",
             value);
@@ -172,8 +171,8 @@ void MidiLearn::process(const MidiInput &midiInput,
         return;
     } else if (midiType == MidiMessage::Type::SongPosition) {
         uint16_t value = midiMessage.getData2() << 7 | midiMessage.getData1();
-        System::logger.write(
-            LOG_ERROR,
+        LOG_DEBUG_IN(
+            learn,
             "ElectraMidi::processMidiLearn: song position message: "
             "value=%d",
             value);
@@ -4,6 +4,8 @@
 #include "MidiMessage.h"
 #include "Config/Router.h"
 #include "InstanceCallback.h"
+#include "ControllerLog.h"
+#include "Midi.h"
 
 typedef bool (*router_callback_t)(MidiInput &midiInput,
                                   MidiMessage &midiMessage);
@@ -16,8 +18,8 @@ typedef void (*router_sysex_callback_t)(MidiInput &midiInput,
 class MidiRouter
 {
 public:
-    explicit MidiRouter(const Router &newRouterConfig)
-        : routerConfig(newRouterConfig)
+    MidiRouter(const Router &newRouterConfig, Midi &newMidi)
+        : routerConfig(newRouterConfig), midi(newMidi)
     {
         InstanceCallback<bool(MidiInput & midiInput,
                               MidiMessage & midiMessage)>::callbackFunction =
@@ -56,60 +58,35 @@ public:
     {
         // Do not forward/process the CTRL messages. It is done on purpose for now.
         if (midiInput.getPort() == MIDI_CTRL_PORT) {
-            System::logger.write(LOG_ERROR,
-                                 "External MIDI control command arrived");
+            COUNT_EVENT(ctrlPortMessages);
+            LOG_TRACE_IN(router, "External MIDI control command arrived");
             return (true);
         }
 
-        if (midiInput.getInterfaceType() == MidiInterface::Type::MidiUsbDev) {
-            if (routerConfig.usbDevToMidiIo) {
-                MidiOutput::send(MidiInterface::Type::MidiIo,
-                                 midiInput.getPort(),
-                                 midiMessage.getType(),
-                                 midiMessage.getChannel(),
-                                 midiMessage.getData1(),
-                                 midiMessage.getData2());
-            }
-            if (routerConfig.usbDevToUsbHost) {
-                MidiOutput::send(MidiInterface::Type::MidiUsbHost,
-                                 midiInput.getPort(),
-                                 midiMessage.getType(),
-                                 midiMessage.getChannel(),
-                                 midiMessage.getData1(),
-                                 midiMessage.getData2());
-            }
+        uint8_t routes = getRoutes(midiInput.getInterfaceType());
+
+        if (routes == 0) {
+            return (true);
         }
 
-        if (midiInput.getInterfaceType() == MidiInterface::Type::MidiIo) {
-            if (routerConfig.midiIoToUsbDev) {
-                MidiOutput::send(MidiInterface::Type::MidiUsbDev,
-                                 midiInput.getPort(),
-                                 midiMessage.getType(),
-                                 midiMessage.getChannel(),
-                                 midiMessage.getData1(),
-                                 midiMessage.getData2());
-            }
-            if (routerConfig.midiIoToUsbHost) {
-                MidiOutput::send(MidiInterface::Type::MidiUsbHost,
-                                 midiInput.getPort(),
-                                 midiMessage.getType(),
-                                 midiMessage.getChannel(),
-                                 midiMessage.getData1(),
-                                 midiMessage.getData2());
-            }
+        if (!routerConfig.isAllowed((uint8_t)midiMessage.getType(),
+                                    midiMessage.getChannel())) {
+            COUNT_EVENT(droppedMessages);
+            return (true);
         }
 
-        if (midiInput.getInterfaceType() == MidiInterface::Type::MidiUsbHost) {
-            if (routerConfig.usbHostToMidiIo) {
-                MidiOutput::send(MidiInterface::Type::MidiIo,
-                                 midiInput.getPort(),
-                                 midiMessage.getType(),
-                                 midiMessage.getChannel(),
-                                 midiMessage.getData1(),
-                                 midiMessage.getData2());
-            }
-            if (routerConfig.usbHostToUsbDev) {
-                MidiOutput::send(MidiInterface::Type::MidiUsbDev,
+        COUNT_EVENT(routedMessages);
+
+        // The routed controller may change the receivers' NRPN selection
+        if (midiMessage.getType() == MidiMessage::Type::ControlChange) {
+            midi.forgetControlChange(midiInput.getPort(),
+                                     midiMessage.getChannel(),
+                                     midiMessage.getData1());
+        }
+
+        for (uint8_t i = 0; i < Router::NumInterfaces; i++) {
+            if (routes & (1 << i)) {
+                MidiOutput::send(destinations[i],
                                  midiInput.getPort(),
                                  midiMessage.getType(),
                                  midiMessage.getChannel(),
@@ -126,50 +103,13 @@ public:
                            uint16_t sysExSize,
                            bool complete)
     {
-        if (midiInput.getInterfaceType() == MidiInterface::Type::MidiUsbDev) {
-            if (routerConfig.usbDevToMidiIo) {
-                MidiOutput::sendSysExPartial(MidiInterface::Type::MidiIo,
-                                             midiInput.getPort(),
-                                             sysExData,
-                                             sysExSize,
-                                             complete);
-            }
-            if (routerConfig.usbDevToUsbHost) {
-                MidiOutput::sendSysExPartial(MidiInterface::Type::MidiUsbHost,
-                                             midiInput.getPort(),
-                                             sysExData,
-                                             sysExSize,
-                                             complete);
-            }
-        }
+        COUNT_EVENT(routedSysex);
 
-        if (midiInput.getInterfaceType() == MidiInterface::Type::MidiIo) {
-            if (routerConfig.midiIoToUsbDev) {
-                MidiOutput::sendSysExPartial(MidiInterface::Type::MidiUsbDev,
-                                             midiInput.getPort(),
-                                             sysExData,
-                                             sysExSize,
-                                             complete);
-            }
-            if (routerConfig.usbDevToUsbHost) {
-                MidiOutput::sendSysExPartial(MidiInterface::Type::MidiUsbHost,
-                                             midiInput.getPort(),
-                                             sysExData,
-                                             sysExSize,
-                                             complete);
-            }
-        }
+        uint8_t routes = getRoutes(midiInput.getInterfaceType());
 
-        if (midiInput.getInterfaceType() == MidiInterface::Type::MidiUsbHost) {
-            if (routerConfig.usbHostToMidiIo) {
-                MidiOutput::sendSysExPartial(MidiInterface::Type::MidiIo,
-                                             midiInput.getPort(),
-                                             sysExData,
-                                             sysExSize,
-                                             complete);
-            }
-            if (routerConfig.usbHostToUsbDev) {
-                MidiOutput::sendSysExPartial(MidiInterface::Type::MidiUsbDev,
+        for (uint8_t i = 0; i < Router::NumInterfaces; i++) {
+            if (routes & (1 << i)) {
+                MidiOutput::sendSysExPartial(destinations[i],
                                              midiInput.getPort(),
                                              sysExData,
                                              sysExSize,
@@ -179,5 +119,24 @@ public:
     }
 
 private:
+    uint8_t getRoutes(MidiInterface::Type interfaceType) const
+    {
+        if (interfaceType == MidiInterface::Type::MidiUsbDev) {
+            return (routerConfig.getRoutes(Router::UsbDev));
+        } else if (interfaceType == MidiInterface::Type::MidiIo) {
+            return (routerConfig.getRoutes(Router::MidiIo));
+        } else if (interfaceType == MidiInterface::Type::MidiUsbHost) {
+            return (routerConfig.getRoutes(Router::UsbHost));
+        }
+        return (0);
+    }
+
+    static constexpr MidiInterface::Type destinations[Router::NumInterfaces] = {
+        MidiInterface::Type::MidiUsbDev,
+        MidiInterface::Type::MidiIo,
+        MidiInterface::Type::MidiUsbHost
+    };
+
     const Router &routerConfig;
+    Midi &midi;
 };
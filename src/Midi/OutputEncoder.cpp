@@ -0,0 +1,93 @@
+#include "OutputEncoder.h"
+
+OutputEncoder::OutputEncoder()
+{
+    reset();
+}
+
+/** Forget everything that was sent.
+ *  The next message to every receiver is sent in full.
+ */
+void OutputEncoder::reset(void)
+{
+    for (uint8_t port = 0; port < NumPorts; port++) {
+        for (uint8_t channel = 0; channel < NumChannels; channel++) {
+            selections[port][channel] = Selection{ NoParameter, false };
+        }
+    }
+    msbValues.clear();
+}
+
+bool OutputEncoder::isSelected(uint8_t port,
+                               uint8_t channel,
+                               bool isNrpn,
+                               uint16_t parameterNumber) const
+{
+    const Selection &selection = getSelection(port, channel);
+
+    return ((selection.parameterNumber == parameterNumber)
+            && (selection.isNrpn == isNrpn));
+}
+
+void OutputEncoder::select(uint8_t port,
+                           uint8_t channel,
+                           bool isNrpn,
+                           uint16_t parameterNumber)
+{
+    getSelection(port, channel) = Selection{ parameterNumber, isNrpn };
+}
+
+void OutputEncoder::deselect(uint8_t port, uint8_t channel)
+{
+    getSelection(port, channel).parameterNumber = NoParameter;
+}
+
+bool OutputEncoder::isMsbSent(uint8_t port,
+                              uint8_t channel,
+                              uint8_t controllerNumber,
+                              uint8_t msb) const
+{
+    auto it = msbValues.find(getMsbKey(port, channel, controllerNumber));
+
+    return ((it != msbValues.end()) && (it->second == msb));
+}
+
+void OutputEncoder::setMsbSent(uint8_t port,
+                               uint8_t channel,
+                               uint8_t controllerNumber,
+                               uint8_t msb)
+{
+    msbValues[getMsbKey(port, channel, controllerNumber)] = msb;
+}
+
+void OutputEncoder::forgetMsb(uint8_t port,
+                              uint8_t channel,
+                              uint8_t controllerNumber)
+{
+    msbValues.erase(getMsbKey(port, channel, controllerNumber));
+}
+
+uint16_t OutputEncoder::getMsbKey(uint8_t port,
+                                  uint8_t channel,
+                                  uint8_t controllerNumber)
+{
+    return (((port % NumPorts) << 9) | (getChannelIndex(channel) << 5)
+            | (controllerNumber & 0x1F));
+}
+
+uint8_t OutputEncoder::getChannelIndex(uint8_t channel)
+{
+    return ((uint8_t)(channel - 1) % NumChannels);
+}
+
+OutputEncoder::Selection &OutputEncoder::getSelection(uint8_t port,
+                                                      uint8_t channel)
+{
+    return (selections[port % NumPorts][getChannelIndex(channel)]);
+}
+
+const OutputEncoder::Selection &
+    OutputEncoder::getSelection(uint8_t port, uint8_t channel) const
+{
+    return (selections[port % NumPorts][getChannelIndex(channel)]);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <map>
+
+/*
+ * Remembers what the receivers were last sent on every port and channel.
+ *
+ * The state lets the MIDI output skip the NRPN/RPN parameter select
+ * messages and the MSB of 14-bit controllers when the receiver already
+ * has them. It is used for devices with compact output enabled only.
+ */
+class OutputEncoder
+{
+public:
+    OutputEncoder();
+
+    void reset(void);
+
+    bool isSelected(uint8_t port,
+                    uint8_t channel,
+                    bool isNrpn,
+                    uint16_t parameterNumber) const;
+    void select(uint8_t port,
+                uint8_t channel,
+                bool isNrpn,
+                uint16_t parameterNumber);
+    void deselect(uint8_t port, uint8_t channel);
+
+    bool isMsbSent(uint8_t port,
+                   uint8_t channel,
+                   uint8_t controllerNumber,
+                   uint8_t msb) const;
+    void setMsbSent(uint8_t port,
+                    uint8_t channel,
+                    uint8_t controllerNumber,
+                    uint8_t msb);
+    void forgetMsb(uint8_t port, uint8_t channel, uint8_t controllerNumber);
+
+private:
+    static constexpr uint8_t NumPorts = 4;
+    static constexpr uint8_t NumChannels = 16;
+    static constexpr uint16_t NoParameter = 0xFFFF;
+
+    struct Selection {
+        uint16_t parameterNumber;
+        bool isNrpn;
+    };
+
+    static uint16_t
+        getMsbKey(uint8_t port, uint8_t channel, uint8_t controllerNumber);
+    static uint8_t getChannelIndex(uint8_t channel);
+    Selection &getSelection(uint8_t port, uint8_t channel);
+    const Selection &getSelection(uint8_t port, uint8_t channel) const;
+
+    Selection selections[NumPorts][NumChannels];
+    std::map<uint16_t, uint8_t> msbValues;
+};
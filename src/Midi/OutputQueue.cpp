@@ -0,0 +1,107 @@
+#include "OutputQueue.h"
+#include "ControllerLog.h"
+
+/** Returns true for messages that carry an absolute value of a parameter.
+ *  Only those can be replaced by a newer value without changing
+ *  the result on the receiving device.
+ */
+bool OutputQueue::isCoalescable(Message::Type type)
+{
+    return ((type == Message::Type::cc7) || (type == Message::Type::cc14)
+            || (type == Message::Type::nrpn) || (type == Message::Type::rpn)
+            || (type == Message::Type::atpoly)
+            || (type == Message::Type::atchannel)
+            || (type == Message::Type::pitchbend));
+}
+
+bool OutputQueue::hasPending(uint8_t deviceId) const
+{
+    auto it = queues.find(deviceId);
+
+    return ((it != queues.end()) && !it->second.messages.empty());
+}
+
+/** Returns true when the rate interval of the device has passed.
+ *
+ */
+bool OutputQueue::isDue(uint8_t deviceId, uint16_t rate, uint32_t now) const
+{
+    auto it = queues.find(deviceId);
+
+    if (it == queues.end()) {
+        return (true);
+    }
+    return ((now - it->second.tsLastMessage) >= rate);
+}
+
+/** Adds the message to the queue of its device.
+ *  A pending message of the same type and parameter number gets
+ *  the new value. Returns false when the queue is full.
+ */
+bool OutputQueue::push(const Message &message)
+{
+    auto &messages = queues[message.getDeviceId()].messages;
+
+    for (auto &pending : messages) {
+        if ((pending.getType() == message.getType())
+            && (pending.getParameterNumber() == message.getParameterNumber())) {
+            pending.setValue(message.getValue());
+            COUNT_EVENT(outputCoalesced);
+            return (true);
+        }
+    }
+
+    if (messages.size() >= MaxPendingMessages) {
+        return (false);
+    }
+
+    messages.push_back(message);
+    COUNT_EVENT(outputQueued);
+
+    return (true);
+}
+
+/** Takes the oldest pending message of the device.
+ *
+ */
+bool OutputQueue::pop(uint8_t deviceId, Message &message)
+{
+    auto it = queues.find(deviceId);
+
+    if ((it == queues.end()) || it->second.messages.empty()) {
+        return (false);
+    }
+
+    auto &messages = it->second.messages;
+
+    message = messages.front();
+    messages.erase(messages.begin());
+
+    return (true);
+}
+
+void OutputQueue::markSent(uint8_t deviceId, uint32_t now)
+{
+    queues[deviceId].tsLastMessage = now;
+}
+
+void OutputQueue::discard(uint8_t deviceId)
+{
+    queues.erase(deviceId);
+}
+
+void OutputQueue::clear(void)
+{
+    queues.clear();
+}
+
+void OutputQueue::getPendingDevices(std::vector<uint8_t> &deviceIds) const
+{
+    deviceIds.clear();
+
+    for (const auto &[deviceId, queue] : queues) {
+        if (!queue.messages.empty()) {
+            deviceIds.push_back(deviceId);
+        }
+    }
+}
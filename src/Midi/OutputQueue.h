@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "Message.h"
+
+/*
+ * Per-device queue of outgoing messages.
+ *
+ * Only the latest value of every (type, parameterNumber) pair is kept.
+ * The queue keeps the time of the last message sent to every device so
+ * that the pending messages can be released at the rate of the device.
+ */
+class OutputQueue
+{
+public:
+    OutputQueue() = default;
+
+    static bool isCoalescable(Message::Type type);
+
+    bool hasPending(uint8_t deviceId) const;
+    bool isDue(uint8_t deviceId, uint16_t rate, uint32_t now) const;
+    bool push(const Message &message);
+    bool pop(uint8_t deviceId, Message &message);
+    void markSent(uint8_t deviceId, uint32_t now);
+    void discard(uint8_t deviceId);
+    void clear(void);
+    void getPendingDevices(std::vector<uint8_t> &deviceIds) const;
+
+    static constexpr uint8_t MaxPendingMessages = 32;
+
+private:
+    struct DeviceQueue {
+        DeviceQueue() : tsLastMessage(0)
+        {
+        }
+
+        std::vector<Message> messages;
+        uint32_t tsLastMessage;
+    };
+
+    std::map<uint8_t, DeviceQueue> queues;
+};
@@ -0,0 +1,108 @@
+#include "SysexJsonWriter.h"
+
+SysexJsonWriter::SysexJsonWriter(uint8_t newPort,
+                                 ElectraCommand::Object object)
+    : position(0), port(newPort), numTransfers(0), length(0)
+{
+    const uint8_t header[] = { 0xf0, 0x00, 0x21, 0x45, 0x01, (uint8_t)object };
+
+    for (uint8_t byte : header) {
+        write((char)byte);
+    }
+}
+
+void SysexJsonWriter::write(char c)
+{
+    if (position == BufferSize) {
+        flush();
+    }
+    buffer[position++] = c;
+    length++;
+}
+
+void SysexJsonWriter::write(const char *text)
+{
+    while (*text) {
+        write(*text++);
+    }
+}
+
+/** Write a quoted JSON string.
+ *  Quotes and backslashes are escaped, control characters are written
+ *  as \u escapes and 8-bit characters are replaced, as they cannot be
+ *  carried by SysEx.
+ */
+void SysexJsonWriter::writeString(const char *text)
+{
+    static const char hexDigits[] = "0123456789ABCDEF";
+
+    write('"');
+
+    for (; *text; text++) {
+        uint8_t c = *text;
+
+        if ((c == '"') || (c == '\\')) {
+            write('\\');
+            write(c);
+        } else if (c < 0x20) {
+            write("\\u00");
+            write(hexDigits[c >> 4]);
+            write(hexDigits[c & 0x0f]);
+        } else if (c >= 0x80) {
+            write('?');
+        } else {
+            write(c);
+        }
+    }
+
+    write('"');
+}
+
+void SysexJsonWriter::writeInteger(int32_t value)
+{
+    char text[12];
+
+    snprintf(text, sizeof(text), "%ld", (long)value);
+    write(text);
+}
+
+void SysexJsonWriter::writeHex(uint32_t value, uint8_t numDigits)
+{
+    char text[9];
+
+    if (numDigits > sizeof(text) - 1) {
+        numDigits = sizeof(text) - 1;
+    }
+
+    snprintf(text, sizeof(text), "%0*lX", numDigits, (unsigned long)value);
+    write(text);
+}
+
+/** Terminate the SysEx message and send the rest of the buffer.
+ *
+ */
+void SysexJsonWriter::end(void)
+{
+    write((char)0xf7);
+    flush();
+}
+
+uint16_t SysexJsonWriter::getNumTransfers(void) const
+{
+    return (numTransfers);
+}
+
+uint32_t SysexJsonWriter::getLength(void) const
+{
+    return (length);
+}
+
+void SysexJsonWriter::flush(void)
+{
+    if (position > 0) {
+        MidiOutput::sendSysExPartial(
+            MidiInterface::Type::MidiUsbDev, port, buffer, position, false);
+        numTransfers++;
+        position = 0;
+    }
+}
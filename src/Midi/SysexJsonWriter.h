@@ -0,0 +1,40 @@
+#pragma once
+
+#include "MidiOutput.h"
+#include <stdint.h>
+
+/*
+ * Streams a JSON document to the editor as one Electra SysEx message.
+ *
+ * The output is collected in a fixed buffer that is sent whenever it is
+ * full, so the message is transferred in as few USB transfers as possible
+ * and no record can overflow the buffer. Strings are escaped and limited
+ * to 7-bit characters to keep the SysEx valid.
+ */
+class SysexJsonWriter
+{
+public:
+    SysexJsonWriter(uint8_t port, ElectraCommand::Object object);
+
+    void write(char c);
+    void write(const char *text);
+    void writeString(const char *text);
+    void writeInteger(int32_t value);
+    void writeHex(uint32_t value, uint8_t numDigits);
+    void end(void);
+
+    uint16_t getNumTransfers(void) const;
+    uint32_t getLength(void) const;
+
+private:
+    void flush(void);
+
+    // 128 USB MIDI events of 3 SysEx bytes each
+    static constexpr uint16_t BufferSize = 384;
+
+    uint8_t buffer[BufferSize];
+    uint16_t position;
+    uint8_t port;
+    uint16_t numTransfers;
+    uint32_t length;
+};
@@ -0,0 +1,155 @@
+#include "ValueTransform.h"
+#include "helpers.h"
+#include "Arduino.h"
+
+std::deque<ValueTransform> ValueTransform::transforms;
+size_t ValueTransform::numTableTransforms = 0;
+
+ValueTransform::ValueTransform(SignMode newSignMode,
+                               uint8_t newBitWidth,
+                               int16_t newMinValue,
+                               int16_t newMaxValue,
+                               uint16_t newMidiMin,
+                               uint16_t newMidiMax,
+                               bool withTables)
+    : signMode(newSignMode),
+      bitWidth(newBitWidth),
+      minValue(newMinValue),
+      maxValue(newMaxValue),
+      midiMin(newMidiMin),
+      midiMax(newMidiMax),
+      isOffset(false)
+{
+    int32_t range = (int32_t)maxValue - minValue;
+    int32_t midiRange = (int32_t)midiMax - midiMin;
+
+    // Only the unsigned translation scales the values
+    if ((signMode == SignMode::twosComplement)
+        || (signMode == SignMode::signBit) || (range <= 0)
+        || (midiRange <= 0)) {
+        return;
+    }
+
+    if ((range == midiRange) && (midiMax <= INT16_MAX)) {
+        /* The float translation of equally sized ranges differs from
+         * the offset by far less than the rounding step.
+         */
+        isOffset = true;
+        return;
+    }
+
+    if (!withTables) {
+        return;
+    }
+
+    if (midiRange < MaxTableSize) {
+        values.resize(midiRange + 1);
+
+        for (int32_t i = 0; i <= midiRange; i++) {
+            values[i] = translateMidiValueToValue(signMode,
+                                                  bitWidth,
+                                                  midiMin + i,
+                                                  midiMin,
+                                                  midiMax,
+                                                  minValue,
+                                                  maxValue);
+        }
+    }
+
+    if (range < MaxTableSize) {
+        midiValues.resize(range + 1);
+
+        for (int32_t i = 0; i <= range; i++) {
+            midiValues[i] = translateValueToMidiValue(signMode,
+                                                      bitWidth,
+                                                      minValue + i,
+                                                      minValue,
+                                                      maxValue,
+                                                      midiMin,
+                                                      midiMax);
+        }
+    }
+}
+
+/** Get a shared transform for the parameters.
+ *  A transform is always returned so that the callers can keep it. Once
+ *  MaxTableTransforms transforms have lookup tables, new transforms are
+ *  created without them.
+ */
+const ValueTransform *ValueTransform::get(SignMode signMode,
+                                          uint8_t bitWidth,
+                                          int16_t minValue,
+                                          int16_t maxValue,
+                                          uint16_t midiMin,
+                                          uint16_t midiMax)
+{
+    for (const auto &transform : transforms) {
+        if (transform.matches(
+                signMode, bitWidth, minValue, maxValue, midiMin, midiMax)) {
+            return (&transform);
+        }
+    }
+
+    bool withTables = (numTableTransforms < MaxTableTransforms);
+
+    transforms.emplace_back(
+        signMode, bitWidth, minValue, maxValue, midiMin, midiMax, withTables);
+
+    if (!transforms.back().values.empty()
+        || !transforms.back().midiValues.empty()) {
+        numTableTransforms++;
+    }
+
+    return (&transforms.back());
+}
+
+/** Release all transforms.
+ *  Must be called only when no ControlValue refers to them.
+ */
+void ValueTransform::clear(void)
+{
+    transforms.clear();
+    numTableTransforms = 0;
+}
+
+bool ValueTransform::matches(SignMode otherSignMode,
+                             uint8_t otherBitWidth,
+                             int16_t otherMinValue,
+                             int16_t otherMaxValue,
+                             uint16_t otherMidiMin,
+                             uint16_t otherMidiMax) const
+{
+    return ((signMode == otherSignMode) && (bitWidth == otherBitWidth)
+            && (minValue == otherMinValue) && (maxValue == otherMaxValue)
+            && (midiMin == otherMidiMin) && (midiMax == otherMidiMax));
+}
+
+int16_t ValueTransform::toValue(uint16_t midiValue) const
+{
+    if (!values.empty()) {
+        return (values[constrain(midiValue, midiMin, midiMax) - midiMin]);
+    }
+
+    if (isOffset) {
+        return (constrain(midiValue, midiMin, midiMax) - midiMin + minValue);
+    }
+
+    return (translateMidiValueToValue(
+        signMode, bitWidth, midiValue, midiMin, midiMax, minValue, maxValue));
+}
+
+uint16_t ValueTransform::toMidiValue(int16_t value) const
+{
+    if ((value >= minValue) && (value <= maxValue)) {
+        if (!midiValues.empty()) {
+            return (midiValues[value - minValue]);
+        }
+
+        if (isOffset) {
+            return (value - minValue + midiMin);
+        }
+    }
+
+    return (translateValueToMidiValue(
+        signMode, bitWidth, value, minValue, maxValue, midiMin, midiMax));
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "SignMode.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/*
+ * A translation between the display values and the MIDI values of
+ * a ControlValue, prepared for one set of translation parameters.
+ *
+ * Ranges of the same size are translated with an integer offset and ranges
+ * of up to 128 steps with lookup tables filled by the float translation
+ * functions. Both give the same results as the float translation, which
+ * is still used for all other ranges. Transforms are shared by all values
+ * with the same parameters. Only the first MaxTableTransforms transforms
+ * get lookup tables, the others use the offset or the float translation.
+ */
+class ValueTransform
+{
+public:
+    ValueTransform(SignMode newSignMode,
+                   uint8_t newBitWidth,
+                   int16_t newMinValue,
+                   int16_t newMaxValue,
+                   uint16_t newMidiMin,
+                   uint16_t newMidiMax,
+                   bool withTables = true);
+
+    static const ValueTransform *get(SignMode signMode,
+                                     uint8_t bitWidth,
+                                     int16_t minValue,
+                                     int16_t maxValue,
+                                     uint16_t midiMin,
+                                     uint16_t midiMax);
+    static void clear(void);
+
+    bool matches(SignMode otherSignMode,
+                 uint8_t otherBitWidth,
+                 int16_t otherMinValue,
+                 int16_t otherMaxValue,
+                 uint16_t otherMidiMin,
+                 uint16_t otherMidiMax) const;
+    int16_t toValue(uint16_t midiValue) const;
+    uint16_t toMidiValue(int16_t value) const;
+
+private:
+    static constexpr int32_t MaxTableSize = 128;
+    static constexpr size_t MaxTableTransforms = 64;
+
+    SignMode signMode;
+    uint8_t bitWidth;
+    int16_t minValue;
+    int16_t maxValue;
+    uint16_t midiMin;
+    uint16_t midiMax;
+    bool isOffset;
+
+    // indexed by midiValue - midiMin and value - minValue
+    std::vector<int16_t> values;
+    std::vector<uint16_t> midiValues;
+
+    static std::deque<ValueTransform> transforms;
+    static size_t numTableTransforms;
+};
@@ -386,13 +386,7 @@ void Control::setDefaultValue(ControlValue &value, bool sendMidiMessages)
                of the list item, not the MIDI value. */
             midiValue = defaultValue;
         } else {
-            midiValue = translateValueToMidiValue(value.message.getSignMode(),
-                                                  value.message.getBitWidth(),
-                                                  defaultValue,
-                                                  value.getMin(),
-                                                  value.getMax(),
-                                                  value.message.getMidiMin(),
-                                                  value.message.getMidiMax());
+            midiValue = value.translateToMidiValue(defaultValue);
         }
         parameterMap.setValue(lookupEntry,
                               midiValue,
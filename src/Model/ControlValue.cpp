@@ -36,7 +36,8 @@ ControlValue::ControlValue()
       overlay(nullptr),
       relative(false),
       accelerated(false),
-      value(defaultValue)
+      value(defaultValue),
+      transform(nullptr)
 {
     label[0] = '\0';
 }
@@ -62,7 +63,8 @@ ControlValue::ControlValue(Control *newControl,
       formatter(newFormatter),
       function(newFunction),
       overlay(newOverlay),
-      value(defaultValue)
+      value(defaultValue),
+      transform(nullptr)
 {
     // translate the valueId to the numeric handle
     handle = translateId(newValueId);
@@ -226,32 +228,17 @@ int16_t ControlValue::getValue(void) const
 
 void ControlValue::callFormatter(int16_t value)
 {
-    /* @todo this need some clean up */
-    if ((L != nullptr) // Lua is initialized
-        && luaPreset // preset is loaded
-        && (formatter
-            < luaPreset->luaFunctions.size()) // function Id is within the range
-        && !luaPreset->luaFunctions[formatter]
-                .empty()) { // function really exists
-        runFormatter(luaPreset->luaFunctions[formatter].c_str(),
-                     this,
-                     value,
-                     label,
-                     MaxLabelLength);
+    // the function is resolved when the preset Lua script is loaded
+    if (L != nullptr) {
+        runFormatter(formatter, this, value, label, MaxLabelLength);
     }
 }
 
 void ControlValue::callFunction(int16_t value) const
 {
-    /* @todo this need some clean up */
-    if ((L != nullptr) // Lua is initialized
-        && luaPreset // preset is loaded
-        && (value != MIDI_VALUE_DO_NOT_SEND) // MIDI value is valid
-        && (function
-            < luaPreset->luaFunctions.size()) // function Id is within the range
-        && !luaPreset->luaFunctions[function]
-                .empty()) { // function really exists
-        runFunction(luaPreset->luaFunctions[function].c_str(), this, value);
+    // the function is resolved when the preset Lua script is loaded
+    if ((L != nullptr) && (value != MIDI_VALUE_DO_NOT_SEND)) {
+        runFunction(function, this, value);
     }
 }
 
@@ -297,13 +284,18 @@ int16_t ControlValue::translateMidiValue(uint16_t midiValue) const
 {
     if (control->getType() == Control::Type::List) {
         if (overlay) {
-            return (overlay->getIndexByValue(midiValue));
+            return (overlay->findIndexByValue(midiValue));
         } else {
             return (0);
         }
     } else if (control->getType() == Control::Type::Pad) {
         return (midiValue == message.getOnValue());
     }
+
+    if (const ValueTransform *valueTransform = getTransform()) {
+        return (valueTransform->toValue(midiValue));
+    }
+
     return (translateMidiValueToValue(message.getSignMode(),
                                       message.getBitWidth(),
                                       midiValue,
@@ -313,6 +305,44 @@ int16_t ControlValue::translateMidiValue(uint16_t midiValue) const
                                       getMax()));
 }
 
+uint16_t ControlValue::translateToMidiValue(int16_t value) const
+{
+    if (const ValueTransform *valueTransform = getTransform()) {
+        return (valueTransform->toMidiValue(value));
+    }
+
+    return (translateValueToMidiValue(message.getSignMode(),
+                                      message.getBitWidth(),
+                                      value,
+                                      getMin(),
+                                      getMax(),
+                                      message.getMidiMin(),
+                                      message.getMidiMax()));
+}
+
+/** Get the transform for the current translation parameters.
+ *  The min, max and the message range can be changed at any time, so the
+ *  transform is looked up again when they do not match anymore.
+ */
+const ValueTransform *ControlValue::getTransform(void) const
+{
+    if (!transform
+        || !transform->matches(message.getSignMode(),
+                               message.getBitWidth(),
+                               getMin(),
+                               getMax(),
+                               message.getMidiMin(),
+                               message.getMidiMax())) {
+        transform = ValueTransform::get(message.getSignMode(),
+                                        message.getBitWidth(),
+                                        getMin(),
+                                        getMax(),
+                                        message.getMidiMin(),
+                                        message.getMidiMax());
+    }
+    return (transform);
+}
+
 void ControlValue::print(uint8_t logLevel) const
 {
     System::logger.write(
@@ -32,6 +32,7 @@
 #include "Message.h"
 #include "Macros.h"
 #include "luaHooks.h"
+#include "ValueTransform.h"
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -93,6 +94,14 @@ public:
 
     int16_t translateMidiValue(uint16_t midiValue) const;
 
+    /**
+     * @brief Translates the display value to the MIDI value
+     * 
+     * @param value display value
+     * @return uint16_t MIDI value
+     */
+    uint16_t translateToMidiValue(int16_t value) const;
+
     /**
      * @brief Sets the flag that Control is using relative MIDI messages
      * 
@@ -121,6 +130,8 @@ public:
     static int16_t invertedSign(int16_t value);
 
 private:
+    friend class PresetCache;
+
     struct {
         uint8_t handle : 4;
         uint8_t index : 4;
@@ -139,6 +150,10 @@ private:
     char label[MaxLabelLength + 1];
     int16_t value;
 
+    // Prepared translation of the current min, max and message range
+    mutable const ValueTransform *transform;
+    const ValueTransform *getTransform(void) const;
+
 public:
     Message message;
 };
@@ -2,6 +2,9 @@
 
 #include "System.h"
 #include "Hardware.h"
+#include <algorithm>
+#include <map>
+#include <vector>
 
 #define MAX_SNAPSHOT_NAME_LENGTH 14
 
@@ -20,7 +23,10 @@ public:
     static constexpr uint8_t maxDatabaseFilenameLength = 48;
 
     Database(const char *newFilename)
-        : dataOffset(sizeof(Header)), isOpen(false)
+        : dataOffset(sizeof(Header)),
+          isOpen(false),
+          inTransaction(false),
+          occupancyLoaded(false)
     {
         copyString(filename, newFilename, maxDatabaseFilenameLength);
 
@@ -45,6 +51,9 @@ public:
 #endif
 
         if (file) {
+            if (inTransaction) {
+                commit();
+            }
             file.close();
         }
     }
@@ -148,6 +157,13 @@ public:
 
     bool update(uint16_t id, byte *record)
     {
+        setOccupied(id, true);
+
+        if (inTransaction) {
+            pendingRecords[id].assign(record, record + header.recordSize);
+            return (true);
+        }
+
         size_t address = calculateAddress(id);
 
         return (writeRecord(address, record));
@@ -155,6 +171,18 @@ public:
 
     bool select(uint16_t id, byte *record)
     {
+        if (inTransaction) {
+            auto pendingRecord = pendingRecords.find(id);
+
+            if (pendingRecord != pendingRecords.end()) {
+                if (pendingRecord->second.empty()) {
+                    return (false);
+                }
+                memcpy(record, pendingRecord->second.data(), header.recordSize);
+                return (true);
+            }
+        }
+
         size_t address = calculateAddress(id);
 
         return (readRecord(address, record));
@@ -162,18 +190,81 @@ public:
 
     bool remove(uint16_t id)
     {
+        setOccupied(id, false);
+
+        if (inTransaction) {
+            // an empty record marks a pending removal
+            pendingRecords[id].clear();
+            return (true);
+        }
+
         size_t address = calculateAddress(id);
 
         return (deleteRecord(address));
     }
 
+    /*
+     * Start a batch of updates and removals. The changes are kept in RAM,
+     * repeated changes of one record are merged, and nothing is written
+     * until commit().
+     */
+    void begin(void)
+    {
+        inTransaction = true;
+    }
+
+    /*
+     * Write all changes of the batch in the order of record ids and sync
+     * the file once.
+     */
+    bool commit(void)
+    {
+        bool status = true;
+
+        for (const auto &[id, record] : pendingRecords) {
+            size_t address = calculateAddress(id);
+
+            if (record.empty()) {
+                status &= deleteRecord(address);
+            } else {
+                status &= writeRecord(address, (byte *)record.data());
+            }
+        }
+
+        pendingRecords.clear();
+        inTransaction = false;
+        file.sync();
+
+        return (status);
+    }
+
+    /*
+     * Check if the record is used without reading it. The occupancy of all
+     * records is read from the file in one pass when first needed.
+     */
+    bool isUsed(uint16_t id)
+    {
+        if (!occupancyLoaded) {
+            loadOccupancy();
+        }
+
+        if (id >= header.numRecords) {
+            return (false);
+        }
+
+        return ((occupancy[id / 8] & (1 << (id % 8))) != 0);
+    }
+
     void close(void)
     {
 #if DEBUG
         System::logger.write(LOG_ERROR, "Database::closed: file=%s", filename);
 #endif
+        if (inTransaction) {
+            commit();
+        }
         file.close();
-        isOpen = true;
+        isOpen = false;
     }
 
 private:
@@ -209,7 +300,10 @@ private:
 
         file.write(1);
         int rc = file.write(record, header.recordSize);
-        file.sync();
+
+        if (!inTransaction) {
+            file.sync();
+        }
 
         //logMessage ("write address=%d, written=%d, (%s)", address, rc, ((SnapshotRecord *) record)->name);
         return ((rc == header.recordSize) ? true : false);
@@ -254,11 +348,65 @@ private:
         }
 
         int rc = file.write(0);
-        file.sync();
+
+        if (!inTransaction) {
+            file.sync();
+        }
 
         return ((rc == 1) ? true : false);
     }
 
+    bool loadOccupancy(void)
+    {
+        uint8_t buffer[occupancyChunkSize];
+        size_t recordLength = header.recordSize + 1;
+        size_t dataSize = header.numRecords * recordLength;
+
+        occupancy.assign((header.numRecords + 7) / 8, 0);
+        occupancyLoaded = true;
+
+        if (!file.seek(dataOffset)) {
+            System::logger.write(LOG_ERROR,
+                                 "loadOccupancy: cannot seek: %d, max size=%d",
+                                 dataOffset,
+                                 file.size());
+            return (false);
+        }
+
+        for (size_t position = 0; position < dataSize;) {
+            size_t length = std::min(sizeof(buffer), dataSize - position);
+
+            if (file.read(buffer, length) != (int)length) {
+                return (false);
+            }
+
+            // the first flag byte at or after the start of the chunk
+            size_t id = (position + recordLength - 1) / recordLength;
+
+            for (; id * recordLength < position + length; id++) {
+                if (buffer[id * recordLength - position]) {
+                    occupancy[id / 8] |= (1 << (id % 8));
+                }
+            }
+            position += length;
+        }
+
+        return (true);
+    }
+
+    void setOccupied(uint16_t id, bool isOccupied)
+    {
+        if (!occupancyLoaded || (id >= header.numRecords)) {
+            return;
+        }
+
+        if (isOccupied) {
+            occupancy[id / 8] |= (1 << (id % 8));
+        } else {
+            occupancy[id / 8] &= ~(1 << (id % 8));
+        }
+    }
+
     /*
 		 * Variables
 		 */
@@ -272,6 +420,12 @@ private:
     } header;
 
     static constexpr size_t headerOffset = 0;
+    static constexpr size_t occupancyChunkSize = 512;
     size_t dataOffset;
     bool isOpen;
+    bool inTransaction;
+
+    std::map<uint16_t, std::vector<uint8_t>> pendingRecords;
+    std::vector<uint8_t> occupancy;
+    bool occupancyLoaded;
 };
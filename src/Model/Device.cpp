@@ -31,6 +31,7 @@
 Device::Device()
     : MidiOutput(MidiInterface::Type::MidiAll, 0, 0, 0),
       id(0),
+      compactOutput(false),
       lastMessageId(100)
 {
     *name = '\0';
@@ -43,6 +44,7 @@ Device::Device(uint8_t newId,
                uint16_t newRate)
     : MidiOutput(MidiInterface::Type::MidiAll, newPort, newChannel, newRate),
       id(newId),
+      compactOutput(false),
       lastMessageId(1)
 {
     setName(newName);
@@ -72,6 +74,20 @@ const char *Device::getName(void) const
     return (name);
 }
 
+/** Enables elision of redundant bytes in the MIDI output to the device.
+ *  The device must not receive NRPN/RPN or 14-bit CC messages from other
+ *  sources on the same port and channel.
+ */
+void Device::setCompactOutput(bool shouldBeCompact)
+{
+    compactOutput = shouldBeCompact;
+}
+
+bool Device::hasCompactOutput(void) const
+{
+    return (compactOutput);
+}
+
 uint8_t Device::getResponseIndex(uint8_t id) const
 {
     uint8_t index = 0;
@@ -112,6 +128,7 @@ void Device::print(uint8_t logLevel) const
     System::logger.write(logLevel, "port: %d", getPort());
     System::logger.write(logLevel, "channel: %d", getChannel());
     System::logger.write(logLevel, "rate: %d", getRate());
+    System::logger.write(logLevel, "compactOutput: %d", hasCompactOutput());
     System::logger.write(logLevel, "requests: %d", requests.size());
     System::logger.write(logLevel, "responses: %d", responses.size());
     System::logger.write(logLevel, "sysex messages: %d", sysexMessages.size());
@@ -53,15 +53,20 @@ public:
     uint8_t getId(void) const;
     void setName(const char *newName);
     const char *getName(void) const;
+    void setCompactOutput(bool shouldBeCompact);
+    bool hasCompactOutput(void) const;
     uint8_t getResponseIndex(uint8_t id) const;
     DataBytes *registerData(JsonVariant jData, Preset *preset);
     void print(uint8_t logLevel = LOG_TRACE) const;
 
 private:
+    friend class PresetCache;
+
     static constexpr uint8_t MaxNameLength = 20;
 
     struct {
         uint8_t id : 6;
+        bool compactOutput : 1;
     };
     char name[MaxNameLength + 1];
     uint16_t lastMessageId;
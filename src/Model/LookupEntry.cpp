@@ -22,7 +22,11 @@
 #include "LookupEntry.h"
 
 LookupEntry::LookupEntry()
-    : midiValue(MIDI_VALUE_DO_NOT_SEND), dirty(false), callFunction(false)
+    : midiValue(MIDI_VALUE_DO_NOT_SEND),
+      dirty(false),
+      callFunction(false),
+      queued(false),
+      collected(false)
 {
 }
 
@@ -145,4 +149,24 @@ bool LookupEntry::isForRepaintWithoutFunction(void) const
     return (dirty && !callFunction);
 }
 
+void LookupEntry::setQueued(bool shouldBeQueued)
+{
+    queued = shouldBeQueued;
+}
+
+bool LookupEntry::isQueued(void) const
+{
+    return (queued);
+}
+
+void LookupEntry::setCollected(bool shouldBeCollected)
+{
+    collected = shouldBeCollected;
+}
+
+bool LookupEntry::isCollected(void) const
+{
+    return (collected);
+}
+
 Message LookupEntry::emptyMessage;
\ No newline at end of file
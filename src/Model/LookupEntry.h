@@ -171,11 +171,43 @@ public:
      */
     bool isForRepaintWithoutFunction(void) const;
 
+    /**
+     * @brief Marks the entry as placed in the ParameterMap dirty queue
+     *  The flag prevents the entry from being queued more than once.
+     * 
+     * @param shouldBeQueued true when the entry has been queued
+     */
+    void setQueued(bool shouldBeQueued);
+
+    /**
+     * @brief Returns true when the entry is waiting in the dirty queue
+     * 
+     * @return true when the entry is queued
+     */
+    bool isQueued(void) const;
+
+    /**
+     * @brief Marks the entry as collected in a list of changed entries
+     *  The flag prevents the entry from being listed more than once.
+     * 
+     * @param shouldBeCollected true when the entry has been listed
+     */
+    void setCollected(bool shouldBeCollected);
+
+    /**
+     * @brief Returns true when the entry is in a list of changed entries
+     * 
+     * @return true when the entry is listed
+     */
+    bool isCollected(void) const;
+
 private:
     uint16_t midiValue;
     struct {
         bool dirty : 1;
         bool callFunction : 1;
+        bool queued : 1;
+        bool collected : 1;
     };
     std::vector<ControlValue *> messageDestination;
 
@@ -0,0 +1,137 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+#include "LookupTable.h"
+#include <algorithm>
+
+LookupTable::LookupTable() : capacityBits(0)
+{
+}
+
+LookupEntry *LookupTable::find(uint32_t hash)
+{
+    if (slots.empty()) {
+        return (nullptr);
+    }
+
+    const Slot &slot = slots[findSlot(hash)];
+
+    if (slot.index == EmptySlot) {
+        return (nullptr);
+    }
+    return (&items[slot.index].second);
+}
+
+LookupEntry *LookupTable::emplace(uint32_t hash)
+{
+    if (slots.empty()) {
+        rehash(InitialCapacity);
+    }
+
+    size_t position = findSlot(hash);
+
+    if (slots[position].index != EmptySlot) {
+        return (&items[slots[position].index].second);
+    }
+
+    if (items.size() >= (EmptySlot - 1)) {
+        return (nullptr);
+    }
+
+    // keep the load factor below 3/4 to keep the probe sequences short
+    if ((items.size() + 1) * 4 > slots.size() * 3) {
+        rehash(slots.size() * 2);
+        position = findSlot(hash);
+    }
+
+    items.emplace_back(hash, LookupEntry());
+    slots[position].hash = hash;
+    slots[position].index = items.size() - 1;
+
+    return (&items.back().second);
+}
+
+void LookupTable::getSortedItems(std::vector<const Item *> &sortedItems) const
+{
+    sortedItems.clear();
+    sortedItems.reserve(items.size());
+
+    for (const auto &item : items) {
+        sortedItems.push_back(&item);
+    }
+
+    std::sort(sortedItems.begin(),
+              sortedItems.end(),
+              [](const Item *a, const Item *b) {
+                  return (a->first < b->first);
+              });
+}
+
+void LookupTable::clear(void)
+{
+    items.clear();
+    slots = std::vector<Slot>();
+    capacityBits = 0;
+}
+
+size_t LookupTable::size(void) const
+{
+    return (items.size());
+}
+
+size_t LookupTable::capacity(void) const
+{
+    return (slots.size());
+}
+
+size_t LookupTable::getMemoryUsage(void) const
+{
+    return (slots.capacity() * sizeof(Slot) + items.size() * sizeof(Item));
+}
+
+void LookupTable::rehash(size_t newCapacity)
+{
+    capacityBits = 0;
+
+    while (((size_t)1 << capacityBits) < newCapacity) {
+        capacityBits++;
+    }
+
+    slots.assign((size_t)1 << capacityBits, Slot{ 0, EmptySlot });
+
+    for (uint16_t i = 0; i < items.size(); i++) {
+        size_t position = findSlot(items[i].first);
+        slots[position].hash = items[i].first;
+        slots[position].index = i;
+    }
+}
+
+size_t LookupTable::findSlot(uint32_t hash) const
+{
+    const size_t mask = slots.size() - 1;
+    size_t position = mix(hash) >> (32 - capacityBits);
+
+    while ((slots[position].index != EmptySlot)
+           && (slots[position].hash != hash)) {
+        position = (position + 1) & mask;
+    }
+    return (position);
+}
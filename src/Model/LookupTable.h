@@ -0,0 +1,143 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+/**
+ * @file LookupTable.h
+ *
+ * @brief Implements a flat open-addressed index of LookupEntries
+ *  used by the ParameterMap.
+ */
+
+#pragma once
+
+#include "LookupEntry.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+class LookupTable
+{
+public:
+    typedef std::pair<uint32_t, LookupEntry> Item;
+    typedef std::deque<Item> Items;
+
+    LookupTable();
+    ~LookupTable() = default;
+
+    /**
+     * @brief Finds the LookupEntry identified by the hash
+     *
+     * @param hash value to identify the entry
+     * @return LookupEntry* pointer to the entry or nullptr
+     */
+    LookupEntry *find(uint32_t hash);
+
+    /**
+     * @brief Finds or creates the LookupEntry identified by the hash
+     *
+     * The address of the entry does not change until the table
+     * is cleared.
+     *
+     * @param hash value to identify the entry
+     * @return LookupEntry* pointer to the found or newly created entry
+     */
+    LookupEntry *emplace(uint32_t hash);
+
+    /**
+     * @brief Collects the items sorted by their hashes
+     *
+     * Iteration visits the items in the order of their insertion. Files
+     * written from the table use this order to stay independent of it.
+     *
+     * @param sortedItems vector to be filled with pointers to the items
+     */
+    void getSortedItems(std::vector<const Item *> &sortedItems) const;
+
+    /**
+     * @brief Removes all entries and releases the index
+     */
+    void clear(void);
+
+    /**
+     * @brief Returns number of entries stored in the table
+     *
+     * @return size_t number of entries
+     */
+    size_t size(void) const;
+
+    /**
+     * @brief Returns number of slots of the index
+     *
+     * @return size_t number of slots
+     */
+    size_t capacity(void) const;
+
+    /**
+     * @brief Returns approximate number of bytes allocated by the table
+     *
+     * @return size_t number of bytes
+     */
+    size_t getMemoryUsage(void) const;
+
+    Items::iterator begin(void)
+    {
+        return (items.begin());
+    }
+
+    Items::iterator end(void)
+    {
+        return (items.end());
+    }
+
+    Items::const_iterator begin(void) const
+    {
+        return (items.begin());
+    }
+
+    Items::const_iterator end(void) const
+    {
+        return (items.end());
+    }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        uint16_t index;
+    };
+
+    static constexpr uint16_t EmptySlot = 0xFFFF;
+    static constexpr size_t InitialCapacity = 256;
+
+    void rehash(size_t newCapacity);
+    size_t findSlot(uint32_t hash) const;
+
+    inline static uint32_t mix(uint32_t hash)
+    {
+        // Fibonacci hashing spreads the packed deviceId/type/parameter bits
+        return (hash * 2654435769u);
+    }
+
+    std::vector<Slot> slots;
+    Items items;
+    uint8_t capacityBits;
+};
@@ -0,0 +1,79 @@
+#include "Overlay.h"
+#include <algorithm>
+
+/** Build the value index of the overlay.
+ *  Should be called when all items were added.
+ */
+void Overlay::buildIndex(void)
+{
+    uint16_t numItems = getNumItems();
+    bool isSevenBit = true;
+
+    directIndex.clear();
+    sortedIndex.clear();
+
+    for (uint16_t i = 0; i < numItems; i++) {
+        int16_t value = getValueByIndex(i);
+
+        if ((value < 0) || (value >= DirectIndexSize)) {
+            isSevenBit = false;
+            break;
+        }
+    }
+
+    if (isSevenBit) {
+        directIndex.assign(DirectIndexSize, -1);
+
+        // the first item with the value wins, as in the linear search
+        for (uint16_t i = 0; i < numItems; i++) {
+            int16_t &index = directIndex[getValueByIndex(i)];
+
+            if (index < 0) {
+                index = i;
+            }
+        }
+    } else {
+        sortedIndex.reserve(numItems);
+
+        for (uint16_t i = 0; i < numItems; i++) {
+            sortedIndex.push_back(IndexEntry{ getValueByIndex(i), i });
+        }
+
+        std::stable_sort(sortedIndex.begin(),
+                         sortedIndex.end(),
+                         [](const IndexEntry &a, const IndexEntry &b) {
+                             return (a.value < b.value);
+                         });
+    }
+
+    numIndexedItems = numItems;
+}
+
+/** Get the index of the first item with the value, -1 if there is none.
+ *
+ */
+int16_t Overlay::findIndexByValue(int16_t value) const
+{
+    if (numIndexedItems != getNumItems()) {
+        return (getIndexByValue(value));
+    }
+
+    if (!directIndex.empty()) {
+        if ((value < 0) || (value >= DirectIndexSize)) {
+            return (-1);
+        }
+        return (directIndex[value]);
+    }
+
+    auto entry = std::lower_bound(sortedIndex.begin(),
+                                  sortedIndex.end(),
+                                  value,
+                                  [](const IndexEntry &a, int16_t value) {
+                                      return (a.value < value);
+                                  });
+
+    if ((entry == sortedIndex.end()) || (entry->value != value)) {
+        return (-1);
+    }
+    return (entry->index);
+}
@@ -2,19 +2,43 @@
 
 #include "ListData.h"
 #include <map>
+#include <vector>
 
+/*
+ * An overlay keeps a value index next to the items of its ListData.
+ * ListData::getIndexByValue() is not virtual and is left untouched, only
+ * findIndexByValue() uses the index. The index covers the items present
+ * when it was built, items added later are found with the linear search
+ * until the index is rebuilt.
+ */
 class Overlay : public ListData
 {
 public:
-    Overlay() : ListData(0)
+    Overlay() : ListData(0), numIndexedItems(0)
     {
     }
 
-    explicit Overlay(uint8_t newId) : ListData(newId)
+    explicit Overlay(uint8_t newId) : ListData(newId), numIndexedItems(0)
     {
     }
 
     virtual ~Overlay() = default;
+
+    void buildIndex(void);
+    int16_t findIndexByValue(int16_t value) const;
+
+private:
+    // values 0 - 127 are indexed with a direct table
+    static constexpr int16_t DirectIndexSize = 128;
+
+    struct IndexEntry {
+        int16_t value;
+        uint16_t index;
+    };
+
+    std::vector<int16_t> directIndex;
+    std::vector<IndexEntry> sortedIndex;
+    uint16_t numIndexedItems;
 };
 
 typedef std::map<uint8_t, Overlay> Overlays;
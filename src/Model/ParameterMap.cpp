@@ -24,6 +24,7 @@
 #include "ControlComponent.h"
 #include "JsonTools.h"
 #include "luaExtension.h"
+#include <algorithm>
 
 #pragma GCC optimize("O0")
 
@@ -31,9 +32,17 @@
 ParameterMap parameterMap;
 
 ParameterMap::ParameterMap()
-    : lastRead(nullptr), lastReadHash(0), enabled(false), onReadyPending(false)
+    : lastRead(nullptr),
+      lastReadHash(0),
+      onReadyPending(false),
+      fullRepaintPending(false),
+      queueStats{ 0, 0, 0, 0 },
+      keepOffset(0)
 {
     memset(projectId, 0x00, sizeof(projectId));
+    memset(keepFilename, 0x00, sizeof(keepFilename));
+    dirtyEntries.reserve(MaxDirtyEntries);
+    processedEntries.reserve(MaxDirtyEntries);
 }
 
 void ParameterMap::setProjectId(const char *newProjectId)
@@ -51,13 +60,12 @@ LookupEntry *ParameterMap::getAndCache(uint32_t hash)
     if (lastRead && (lastReadHash == hash)) {
         return (lastRead);
     }
-    auto it = entries.find(hash);
-    if (it != entries.end()) {
-        lastRead = &(it->second);
+    LookupEntry *entry = entries.find(hash);
+    if (entry) {
+        lastRead = entry;
         lastReadHash = hash;
-        return &(it->second);
     }
-    return (nullptr);
+    return (entry);
 }
 
 LookupEntry *ParameterMap::getOrCreate(uint8_t deviceId,
@@ -67,16 +75,27 @@ LookupEntry *ParameterMap::getOrCreate(uint8_t deviceId,
 {
     uint32_t hash = calculateHash(deviceId, type, parameterNumber);
 
-    auto insertResult = entries.emplace(hash, LookupEntry());
+    LookupEntry *entry = entries.emplace(hash);
+
+    if (!entry) {
+        System::logger.write(
+            LOG_ERROR,
+            "ParameterMap::getOrCreate: cannot create entry: deviceId=%d, "
+            "type=%d, parameterNumber=%d",
+            deviceId,
+            type,
+            parameterNumber);
+        return (nullptr);
+    }
 
     if (controlValue) {
-        insertResult.first->second.addDestination(controlValue);
+        entry->addDestination(controlValue);
     }
 
-    lastRead = &(insertResult.first->second);
+    lastRead = entry;
     lastReadHash = hash;
 
-    return &(insertResult.first->second);
+    return (entry);
 }
 
 LookupEntry *ParameterMap::get(uint8_t deviceId,
@@ -176,7 +195,9 @@ LookupEntry *ParameterMap::setValueSimple(uint8_t deviceId,
         getAndCache(calculateHash(deviceId, type, parameterNumber));
 
     if (entry) {
-        entry->setMidiValue(midiValue);
+        if (entry->setMidiValue(midiValue)) {
+            postEntry(entry);
+        }
     }
     return (entry);
 }
@@ -283,6 +304,7 @@ bool ParameterMap::removeDestination(Message *message)
     if (entry) {
         removed = entry->removeDestination(message->getControlValue());
     }
+    componentBindings.erase(message->getControlValue());
     return (removed);
 }
 
@@ -296,6 +318,7 @@ bool ParameterMap::removeDestination(ControlValue *value)
     if (entry) {
         removed = entry->removeDestination(value);
     }
+    componentBindings.erase(value);
     return (removed);
 }
 
@@ -319,6 +342,9 @@ void ParameterMap::clear(void)
         lookupEntry.removeAllDestinations();
     }
     entries.clear();
+    dirtyEntries.clear();
+    componentBindings.clear();
+    fullRepaintPending = false;
 
     lastRead = nullptr;
 }
@@ -327,6 +353,18 @@ void ParameterMap::print(uint8_t logLevel)
 {
     System::logger.write(logLevel,
                          "--[Parameter Map]---------------------------------");
+    System::logger.write(logLevel,
+                         "ParameterMap: entries=%lu, slots=%lu, memory=%lu",
+                         (unsigned long)entries.size(),
+                         (unsigned long)entries.capacity(),
+                         (unsigned long)entries.getMemoryUsage());
+    System::logger.write(logLevel,
+                         "ParameterMap queue: depth=%d, maxDepth=%d, "
+                         "drainTime=%luus, overflows=%lu",
+                         queueStats.depth,
+                         queueStats.maxDepth,
+                         (unsigned long)queueStats.drainTime,
+                         (unsigned long)queueStats.overflows);
     for (auto &[hash, entry] : entries) {
         if (getType(hash) != Message::Type::none) {
             System::logger.write(
@@ -353,19 +391,149 @@ void ParameterMap::print(uint8_t logLevel)
     System::logger.write(logLevel, "--");
 }
 
+/** Keep the current state.
+ *  Only the serialization is done here, the file is written by flushKeep()
+ *  so that a preset switch does not wait for the SD card.
+ */
 void ParameterMap::keep(void)
 {
+    // the state of the previous preset must reach the card first
+    finishKeep();
+
     createMapsDir();
+    prepareMapStateFilename(keepFilename, MaxKeepFilenameLength);
+
+    keepBuffer.clear();
+    keepOffset = 0;
+    serialize(keepBuffer);
+
+    System::logger.write(LOG_INFO,
+                         "ParameterMap::keep: filename=%s, size=%lu",
+                         keepFilename,
+                         (unsigned long)keepBuffer.size());
+}
+
+void ParameterMap::flushKeep(void)
+{
+    if (keepBuffer.empty()) {
+        return;
+    }
+
+    char tempFilename[MAX_FILENAME_LENGTH + 1];
+    snprintf(tempFilename, MAX_FILENAME_LENGTH, "%s.tmp", keepFilename);
+
+    if (keepOffset < keepBuffer.size()) {
+        if (!writeKeepChunk(KeepChunkSize)) {
+            System::logger.write(
+                LOG_ERROR,
+                "ParameterMap::flushKeep: write failed: filename=%s",
+                tempFilename);
+            if (keepFile) {
+                keepFile.close();
+            }
+            Hardware::sdcard.deleteFile(tempFilename);
+            std::string().swap(keepBuffer);
+            keepOffset = 0;
+        }
+        return;
+    }
+
+    keepFile.close();
+
+    // the complete file replaces the previous state. The previous file is
+    // removed only when it cannot be renamed over, recall() recovers the
+    // complete temporary file if the power is lost in between.
+    if (!Hardware::sdcard.renameFile(tempFilename, keepFilename)) {
+        Hardware::sdcard.deleteFile(keepFilename);
+
+        if (!Hardware::sdcard.renameFile(tempFilename, keepFilename)) {
+            System::logger.write(
+                LOG_ERROR,
+                "ParameterMap::flushKeep: cannot rename %s to %s",
+                tempFilename,
+                keepFilename);
+        }
+    }
+
+    std::string().swap(keepBuffer);
+    keepOffset = 0;
+}
+
+void ParameterMap::finishKeep(void)
+{
+    while (!keepBuffer.empty()) {
+        flushKeep();
+    }
+}
+
+/** Write the next chunk of the kept state to the temporary file.
+ *  The file stays open until the last chunk is written.
+ */
+bool ParameterMap::writeKeepChunk(size_t length)
+{
+    if (keepOffset == 0) {
+        char tempFilename[MAX_FILENAME_LENGTH + 1];
+        snprintf(tempFilename, MAX_FILENAME_LENGTH, "%s.tmp", keepFilename);
+
+        keepFile = Hardware::sdcard.createOutputStream(
+            tempFilename, FILE_WRITE | O_CREAT | O_TRUNC);
+    }
+
+    if (!keepFile) {
+        return (false);
+    }
+
+    length = std::min(length, keepBuffer.size() - keepOffset);
+
+    bool status = (keepFile.write((const uint8_t *)keepBuffer.data()
+                                      + keepOffset,
+                                  length)
+                   == length);
+
+    keepOffset += length;
+
+    return (status);
+}
+
+bool ParameterMap::recoverKeep(const char *filename)
+{
+    char tempFilename[MAX_FILENAME_LENGTH + 1];
+    snprintf(tempFilename, MAX_FILENAME_LENGTH, "%s.tmp", filename);
+
+    if (!Hardware::sdcard.exists(tempFilename)) {
+        return (false);
+    }
+
+    // serialize() ends every complete state with the closing brackets
+    char tail[2] = { 0, 0 };
+
+    if (File file = Hardware::sdcard.createInputStream(tempFilename)) {
+        if ((file.size() >= sizeof(tail))
+            && file.seek(file.size() - sizeof(tail))) {
+            file.read((uint8_t *)tail, sizeof(tail));
+        }
+        file.close();
+    }
+
+    if ((tail[0] != ']') || (tail[1] != '}')) {
+        System::logger.write(LOG_ERROR,
+                             "ParameterMap::recoverKeep: incomplete file: %s",
+                             tempFilename);
+        Hardware::sdcard.deleteFile(tempFilename);
+        return (false);
+    }
 
-    char mapStateFilename[MAX_FILENAME_LENGTH + 1];
-    prepareMapStateFilename(mapStateFilename, MAX_FILENAME_LENGTH);
     System::logger.write(
-        LOG_INFO, "ParameterMap::keep: filename=%s", mapStateFilename);
-    save(mapStateFilename);
+        LOG_INFO, "ParameterMap::recoverKeep: filename=%s", tempFilename);
+
+    return (Hardware::sdcard.renameFile(tempFilename, filename));
 }
 
 void ParameterMap::save(const char *filename)
 {
+    std::string buffer;
+    serialize(buffer);
+
     File file = Hardware::sdcard.createOutputStream(
         filename, FILE_WRITE | O_CREAT | O_TRUNC);
 
@@ -376,73 +544,60 @@ void ParameterMap::save(const char *filename)
         return;
     }
 
-    file.print("{");
-    serializeRoot(file);
-    serializeMap(file);
-    file.print("}");
-
+    file.write((const uint8_t *)buffer.data(), buffer.size());
     file.close();
 }
 
-void ParameterMap::serializeMap(File &file)
+void ParameterMap::serialize(std::string &buffer)
 {
+    char record[96];
     bool firstRecord = true;
 
-    file.print(",\"parameters\":[");
+    buffer.reserve(buffer.size() + 64 + entries.size() * 72);
 
-    for (const auto &[hash, entry] : entries) {
-        const auto deviceId = getDeviceId(hash);
+    snprintf(record,
+             sizeof(record),
+             "{\"version\":1,\"projectId\":\"%s\",\"parameters\":[",
+             projectId);
+    buffer.append(record);
+
+    // sorted by hash, the file does not depend on the order of insertion
+    std::vector<const LookupTable::Item *> sortedItems;
+    entries.getSortedItems(sortedItems);
+
+    for (const auto item : sortedItems) {
+        const uint32_t hash = item->first;
         const auto messageType = getType(hash);
-        const auto parameterNumber = getParameterNumber(hash);
-        const auto midiValue = entry.getMidiValue();
+        const auto midiValue = item->second.getMidiValue();
 
         if (messageType != Message::Type::none
             && midiValue != MIDI_VALUE_DO_NOT_SEND) {
-            if (!firstRecord) {
-                file.print(",");
-            } else {
-                firstRecord = false;
-            }
-
-            file.print("{\"deviceId\":");
-            file.print(deviceId);
-            file.print(",\"messageType\":");
-            file.print(messageType);
-            file.print(",\"parameterNumber\":");
-            file.print(parameterNumber);
-            file.print(",\"midiValue\":");
-            file.print(midiValue);
-            file.print("}");
-
-            System::logger.write(
-                LOG_TRACE,
-                "ParameterMap::serializeMap: entry: deviceI=%d, type=%d, "
-                "parameterNumber=%d, midiValue=%d",
-                deviceId,
-                messageType,
-                parameterNumber,
-                midiValue);
+            snprintf(record,
+                     sizeof(record),
+                     "%s{\"deviceId\":%d,\"messageType\":%d,"
+                     "\"parameterNumber\":%d,\"midiValue\":%d}",
+                     (firstRecord) ? "" : ",",
+                     getDeviceId(hash),
+                     messageType,
+                     getParameterNumber(hash),
+                     midiValue);
+            buffer.append(record);
+            firstRecord = false;
         }
     }
-    file.print("]");
-}
-
-void ParameterMap::serializeRoot(File &file)
-{
-    file.print("\"version\":1,");
-    file.print("\"projectId\":\"");
-    file.print(projectId);
-    file.print("\"");
+    buffer.append("]}");
 }
 
 bool ParameterMap::recall(void)
 {
     bool status = false;
+    finishKeep();
     char mapStateFilename[MAX_FILENAME_LENGTH + 1];
     prepareMapStateFilename(mapStateFilename, MAX_FILENAME_LENGTH);
     System::logger.write(
         LOG_INFO, "ParameterMap::recall: filename=%s", mapStateFilename);
-    if (Hardware::sdcard.exists(mapStateFilename)) {
+    if (Hardware::sdcard.exists(mapStateFilename)
+        || recoverKeep(mapStateFilename)) {
         status = load(mapStateFilename);
     }
     return (status);
@@ -450,6 +605,8 @@ bool ParameterMap::recall(void)
 
 void ParameterMap::forget(void)
 {
+    finishKeep();
+
     char mapStateFilename[MAX_FILENAME_LENGTH + 1];
     prepareMapStateFilename(mapStateFilename, MAX_FILENAME_LENGTH);
     if (Hardware::sdcard.deleteFile(mapStateFilename)) {
@@ -460,10 +617,67 @@ void ParameterMap::forget(void)
 }
 
 bool ParameterMap::load(const char *filename)
+{
+    uint16_t numEntries = 0;
+
+    return (load(filename, nullptr, numEntries));
+}
+
+uint16_t ParameterMap::loadChanges(const char *filename,
+                                   std::vector<LookupEntry *> &changedEntries)
+{
+    uint16_t numEntries = 0;
+
+    changedEntries.clear();
+    load(filename, &changedEntries, numEntries);
+
+    for (auto entry : changedEntries) {
+        entry->setCollected(false);
+    }
+
+    return (numEntries);
+}
+
+bool ParameterMap::load(const char *filename,
+                        std::vector<LookupEntry *> *changedEntries,
+                        uint16_t &numEntries)
 {
     System::logger.write(
         LOG_INFO, "ParameterMap::load: file: filename=%s", filename);
 
+    auto applyValue = [this, changedEntries, &numEntries](uint32_t hash,
+                                                          uint16_t midiValue) {
+        LookupEntry *entry = getAndCache(hash);
+
+        // An entry is listed once, even if the file sets it repeatedly
+        if (entry && changedEntries && !entry->isCollected()
+            && (entry->getMidiValue() != midiValue)) {
+            entry->setCollected(true);
+            changedEntries->push_back(entry);
+        }
+
+        setValue(entry, midiValue, Origin::file);
+        numEntries++;
+    };
+
+    if (isSnapshotImage(filename)) {
+        std::vector<SnapshotEntry> snapshotEntries;
+        char imageProjectId[sizeof(projectId)];
+
+        if (!readSnapshotImage(filename, imageProjectId, snapshotEntries)) {
+            System::logger.write(
+                LOG_ERROR,
+                "ParameterMap::load: cannot read snapshot: filename=%s",
+                filename);
+            return (false);
+        }
+
+        for (const auto &snapshotEntry : snapshotEntries) {
+            applyValue(snapshotEntry.hash, snapshotEntry.midiValue);
+        }
+        return (true);
+    }
+
     File file = Hardware::sdcard.createInputStream(filename);
 
     if (!file) {
@@ -475,7 +689,7 @@ bool ParameterMap::load(const char *filename)
 
     file.setTimeout(100);
 
-    if (!parse(file)) {
+    if (!parseParameters(file, applyValue)) {
         System::logger.write(
             LOG_ERROR,
             "ParameterMap::load: cannot parse setup: filename=%s",
@@ -489,13 +703,9 @@ bool ParameterMap::load(const char *filename)
     return (true);
 }
 
-bool ParameterMap::parse(File &file)
-{
-    parseParameters(file);
-    return (true);
-}
-
-bool ParameterMap::parseParameters(File &file)
+bool ParameterMap::parseParameters(
+    File &file,
+    const std::function<void(uint32_t hash, uint16_t midiValue)> &onParameter)
 {
     const size_t capacity = JSON_OBJECT_SIZE(3) + 512;
     StaticJsonDocument<capacity> doc;
@@ -531,11 +741,10 @@ bool ParameterMap::parseParameters(File &file)
             parameterNumber = item["parameterNumber"].as<uint16_t>();
             midiValue = item["midiValue"].as<uint16_t>();
 
-            setValue(deviceId,
-                     (Message::Type)messageType,
-                     parameterNumber,
-                     midiValue,
-                     Origin::file);
+            onParameter(calculateHash(deviceId,
+                                      (Message::Type)messageType,
+                                      parameterNumber),
+                        midiValue);
 
             System::logger.write(
                 LOG_TRACE,
@@ -553,6 +762,250 @@ bool ParameterMap::parseParameters(File &file)
     return (true);
 }
 
+bool ParameterMap::saveSnapshot(const char *filename)
+{
+    std::vector<SnapshotEntry> snapshotEntries;
+
+    snapshotEntries.reserve(entries.size());
+
+    for (const auto &[hash, entry] : entries) {
+        const auto midiValue = entry.getMidiValue();
+
+        if (getType(hash) != Message::Type::none
+            && midiValue != MIDI_VALUE_DO_NOT_SEND) {
+            snapshotEntries.push_back(SnapshotEntry{ hash, midiValue });
+        }
+    }
+
+    return (writeSnapshotImage(filename, projectId, snapshotEntries));
+}
+
+bool ParameterMap::isSnapshotImage(const char *filename)
+{
+    File file = Hardware::sdcard.createInputStream(filename);
+
+    if (!file) {
+        return (false);
+    }
+
+    uint8_t header[4];
+    bool status = (file.read(header, sizeof(header)) == sizeof(header))
+                  && (readLittleEndian(header, 4) == SnapshotMagic);
+    file.close();
+
+    return (status);
+}
+
+/** Convert a binary snapshot to the JSON format used by the editor.
+ *
+ */
+bool ParameterMap::exportSnapshot(const char *imageFilename,
+                                  const char *jsonFilename)
+{
+    std::vector<SnapshotEntry> snapshotEntries;
+    char imageProjectId[sizeof(projectId)];
+
+    if (!readSnapshotImage(imageFilename, imageProjectId, snapshotEntries)) {
+        return (false);
+    }
+
+    File file = Hardware::sdcard.createOutputStream(
+        jsonFilename, FILE_WRITE | O_CREAT | O_TRUNC);
+
+    if (!file) {
+        System::logger.write(LOG_ERROR,
+                             "ParameterMap::exportSnapshot: cannot open file: %s",
+                             jsonFilename);
+        return (false);
+    }
+
+    file.print("{\"version\":1,\"projectId\":\"");
+    file.print(imageProjectId);
+    file.print("\",\"parameters\":[");
+
+    for (size_t i = 0; i < snapshotEntries.size(); i++) {
+        const auto hash = snapshotEntries[i].hash;
+
+        if (i > 0) {
+            file.print(",");
+        }
+        file.print("{\"deviceId\":");
+        file.print(getDeviceId(hash));
+        file.print(",\"messageType\":");
+        file.print(getType(hash));
+        file.print(",\"parameterNumber\":");
+        file.print(getParameterNumber(hash));
+        file.print(",\"midiValue\":");
+        file.print(snapshotEntries[i].midiValue);
+        file.print("}");
+    }
+    file.print("]}");
+    file.close();
+
+    return (true);
+}
+
+/** Convert a JSON snapshot received from the editor to a binary snapshot.
+ *
+ */
+bool ParameterMap::importSnapshot(const char *jsonFilename,
+                                  const char *imageFilename)
+{
+    std::vector<SnapshotEntry> snapshotEntries;
+    char jsonProjectId[sizeof(projectId)] = "";
+
+    File file = Hardware::sdcard.createInputStream(jsonFilename);
+
+    if (!file) {
+        System::logger.write(LOG_ERROR,
+                             "ParameterMap::importSnapshot: cannot open file: %s",
+                             jsonFilename);
+        return (false);
+    }
+
+    file.setTimeout(100);
+
+    const size_t capacity = JSON_OBJECT_SIZE(1) + 64;
+    StaticJsonDocument<capacity> doc;
+    StaticJsonDocument<capacity> filter;
+
+    filter["projectId"] = true;
+
+    if (!deserializeJson(doc, file, DeserializationOption::Filter(filter))) {
+        copyString(jsonProjectId,
+                   doc["projectId"] | "",
+                   sizeof(jsonProjectId) - 1);
+    }
+
+    bool status = file.seek(0)
+                  && parseParameters(file,
+                                     [&snapshotEntries](uint32_t hash,
+                                                        uint16_t midiValue) {
+                                         snapshotEntries.push_back(
+                                             SnapshotEntry{ hash, midiValue });
+                                     });
+    file.close();
+
+    if (!status) {
+        return (false);
+    }
+
+    return (writeSnapshotImage(imageFilename, jsonProjectId, snapshotEntries));
+}
+
+/** Write the snapshot entries sorted by hash with a single write.
+ *
+ */
+bool ParameterMap::writeSnapshotImage(
+    const char *filename,
+    const char *imageProjectId,
+    std::vector<SnapshotEntry> &snapshotEntries)
+{
+    std::sort(snapshotEntries.begin(),
+              snapshotEntries.end(),
+              [](const SnapshotEntry &a, const SnapshotEntry &b) {
+                  return (a.hash < b.hash);
+              });
+
+    std::vector<uint8_t> buffer(SnapshotHeaderLength
+                                + snapshotEntries.size() * SnapshotEntryLength);
+    uint8_t *position = buffer.data();
+
+    writeLittleEndian(position, SnapshotMagic, 4);
+    writeLittleEndian(position + 4, SnapshotVersion, 2);
+    writeLittleEndian(position + 6, snapshotEntries.size(), 2);
+    strncpy((char *)position + 8, imageProjectId, MaxProjectIdLength);
+    position += SnapshotHeaderLength;
+
+    for (const auto &snapshotEntry : snapshotEntries) {
+        writeLittleEndian(position, snapshotEntry.hash, 4);
+        writeLittleEndian(position + 4, snapshotEntry.midiValue, 2);
+        position += SnapshotEntryLength;
+    }
+
+    File file = Hardware::sdcard.createOutputStream(
+        filename, FILE_WRITE | O_CREAT | O_TRUNC);
+
+    if (!file) {
+        System::logger.write(
+            LOG_ERROR,
+            "ParameterMap::writeSnapshotImage: cannot open file: %s",
+            filename);
+        return (false);
+    }
+
+    bool status = (file.write(buffer.data(), buffer.size()) == buffer.size());
+    file.close();
+
+    return (status);
+}
+
+/** Read all snapshot entries with a single read.
+ *
+ */
+bool ParameterMap::readSnapshotImage(
+    const char *filename,
+    char *imageProjectId,
+    std::vector<SnapshotEntry> &snapshotEntries)
+{
+    File file = Hardware::sdcard.createInputStream(filename);
+
+    if (!file) {
+        return (false);
+    }
+
+    std::vector<uint8_t> buffer(file.size());
+    bool status = (file.read(buffer.data(), buffer.size()) == buffer.size());
+    file.close();
+
+    if (!status || (buffer.size() < SnapshotHeaderLength)
+        || (readLittleEndian(&buffer[0], 4) != SnapshotMagic)
+        || (readLittleEndian(&buffer[4], 2) != SnapshotVersion)) {
+        return (false);
+    }
+
+    uint16_t numEntries = readLittleEndian(&buffer[6], 2);
+
+    if (buffer.size()
+        != SnapshotHeaderLength + numEntries * SnapshotEntryLength) {
+        return (false);
+    }
+
+    memcpy(imageProjectId, &buffer[8], MaxProjectIdLength);
+    imageProjectId[MaxProjectIdLength] = '\0';
+
+    snapshotEntries.resize(numEntries);
+
+    const uint8_t *position = &buffer[SnapshotHeaderLength];
+
+    for (auto &snapshotEntry : snapshotEntries) {
+        snapshotEntry.hash = readLittleEndian(position, 4);
+        snapshotEntry.midiValue = readLittleEndian(position + 4, 2);
+        position += SnapshotEntryLength;
+    }
+
+    return (true);
+}
+
+void ParameterMap::writeLittleEndian(uint8_t *buffer,
+                                     uint32_t value,
+                                     uint8_t length)
+{
+    for (uint8_t i = 0; i < length; i++) {
+        buffer[i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+uint32_t ParameterMap::readLittleEndian(const uint8_t *buffer, uint8_t length)
+{
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; i < length; i++) {
+        value |= (uint32_t)buffer[i] << (i * 8);
+    }
+    return (value);
+}
+
 void ParameterMap::addWindow(ParameterMapWindow *windowToAdd)
 {
     System::logger.write(LOG_TRACE,
@@ -560,6 +1013,7 @@ void ParameterMap::addWindow(ParameterMapWindow *windowToAdd)
                          windowToAdd->getName(),
                          windowToAdd);
     windows.push_back(windowToAdd);
+    invalidateBindings();
 }
 
 void ParameterMap::removeWindow(ParameterMapWindow *windowToRemove)
@@ -576,6 +1030,7 @@ void ParameterMap::removeWindow(ParameterMapWindow *windowToRemove)
                              "ParameterMap::removeWindow: window removed");
         windows.erase(it, windows.end());
     }
+    invalidateBindings();
 }
 
 void ParameterMap::listWindows(void)
@@ -593,6 +1048,44 @@ void ParameterMap::listWindows(void)
     }
 }
 
+void ParameterMap::invalidateBindings(void)
+{
+    componentBindings.clear();
+}
+
+const std::vector<ControlComponent *> &
+    ParameterMap::getBoundComponents(ControlValue *value)
+{
+    auto it = componentBindings.find(value);
+
+    if (it != componentBindings.end()) {
+        return (it->second);
+    }
+
+    std::vector<ControlComponent *> &components = componentBindings[value];
+
+    for (const auto &window : windows) {
+        Component *rc = window->getOwnedContent();
+
+        if (!rc) {
+            continue;
+        }
+
+        Component *c = rc->findChildById(value->getControl()->getId());
+
+        if (c) {
+            // @todo get rid of dynamic_cast. Replace it with polymorphism.
+            ControlComponent *cc = dynamic_cast<ControlComponent *>(c);
+
+            if (cc) {
+                components.push_back(cc);
+            }
+        }
+    }
+
+    return (components);
+}
+
 void ParameterMap::enable(bool newPresetLoaded)
 {
     if (newPresetLoaded) {
@@ -627,6 +1120,7 @@ void ParameterMap::scheduleLuaProcessing(void)
                 } else {
                     mapEntry.markForFullRepaint();
                 }
+                postEntry(&mapEntry);
             }
         }
     }
@@ -634,18 +1128,53 @@ void ParameterMap::scheduleLuaProcessing(void)
 
 void ParameterMap::repaintParameterMap(void)
 {
-    for (auto &[hash, mapEntry] : entries) {
-        if (mapEntry.isDirty() && mapEntry.hasValidMidiValue()) {
-            System::logger.write(
-                LOG_TRACE,
-                "repaintParameterMap: dirty entry found: device=%d, type=%d, "
-                "parameterNumber=%d, midiValue=%d",
-                getDeviceId(hash),
-                getType(hash),
-                getParameterNumber(hash),
-                mapEntry.getMidiValue());
-            repaintLookupEntry(&mapEntry);
+    uint32_t drainStartTime = micros();
+
+    // Entries queued while draining are left for the next run
+    processedEntries.swap(dirtyEntries);
+
+    for (auto entry : processedEntries) {
+        entry->setQueued(false);
+    }
+
+    if (fullRepaintPending) {
+        fullRepaintPending = false;
+
+        for (auto &[hash, mapEntry] : entries) {
+            if (mapEntry.isDirty() && mapEntry.hasValidMidiValue()) {
+                System::logger.write(
+                    LOG_TRACE,
+                    "repaintParameterMap: dirty entry found: device=%d, "
+                    "type=%d, parameterNumber=%d, midiValue=%d",
+                    getDeviceId(hash),
+                    getType(hash),
+                    getParameterNumber(hash),
+                    mapEntry.getMidiValue());
+                repaintLookupEntry(&mapEntry);
+            }
         }
+    } else {
+        for (auto entry : processedEntries) {
+            if (entry->isDirty() && entry->hasValidMidiValue()) {
+                repaintLookupEntry(entry);
+            }
+        }
+    }
+
+    if (!processedEntries.empty()) {
+        queueStats.depth = processedEntries.size();
+        queueStats.drainTime = micros() - drainStartTime;
+
+        if (queueStats.depth > queueStats.maxDepth) {
+            queueStats.maxDepth = queueStats.depth;
+        }
+
+        System::logger.write(
+            LOG_TRACE,
+            "repaintParameterMap: drained queue: depth=%d, drainTime=%dus",
+            queueStats.depth,
+            queueStats.drainTime);
+        processedEntries.clear();
     }
 
     if (onReadyPending) {
@@ -675,29 +1204,18 @@ void ParameterMap::repaintLookupEntry(LookupEntry *mapEntry)
         }
 
         // Repaint affected Controls that are part of active windows
-        for (const auto &window : windows) {
-            Component *rc = window->getOwnedContent();
-            Component *c =
-                rc->findChildById(messageDestination->getControl()->getId());
-
-            if (c) {
-                System::logger.write(
-                    LOG_TRACE,
-                    "repaintParameterMap: repainting component: "
-                    "component: %s, controlId=%d, valueId=%s",
-                    c->getName(),
-                    messageDestination->getControl()->getId(),
-                    messageDestination->getId());
-
-                // @todo get rid of dynamic_cast. Replace it with polymorphism.
-                ControlComponent *cc = dynamic_cast<ControlComponent *>(c);
-
-                if (cc) {
-                    cc->onMidiValueChange(*messageDestination,
-                                          mapEntry->getMidiValue(),
-                                          messageDestination->getHandle());
-                }
-            }
+        for (const auto &cc : getBoundComponents(messageDestination)) {
+            System::logger.write(
+                LOG_TRACE,
+                "repaintParameterMap: repainting component: "
+                "component: %s, controlId=%d, valueId=%s",
+                cc->getName(),
+                messageDestination->getControl()->getId(),
+                messageDestination->getId());
+
+            cc->onMidiValueChange(*messageDestination,
+                                  mapEntry->getMidiValue(),
+                                  messageDestination->getHandle());
         }
     }
 
@@ -711,21 +1229,34 @@ void ParameterMap::prepareMapStateFilename(char *buffer, size_t maxLength)
 
 void ParameterMap::postEntry(LookupEntry *entry)
 {
-    if (enabled) {
-        postMessage(entry, RepaintLookupEntry);
-    }
+    postMessage(entry, RepaintLookupEntry);
 }
 
 void ParameterMap::postRepaint(void)
 {
-    if (enabled) {
-        postMessage(nullptr, RepaintParameterMap);
-    }
+    postMessage(nullptr, RepaintParameterMap);
 }
 
-void ParameterMap::postMessage(LookupEntry *entry,
-                               [[maybe_unused]] RepaintAction repaintAction)
+void ParameterMap::postMessage(LookupEntry *entry, RepaintAction repaintAction)
 {
+    if (repaintAction == RepaintParameterMap) {
+        fullRepaintPending = true;
+        return;
+    }
+
+    if (!entry || entry->isQueued() || fullRepaintPending) {
+        return;
+    }
+
+    // When the queue is full, fall back to scanning the whole map
+    if (dirtyEntries.size() >= MaxDirtyEntries) {
+        fullRepaintPending = true;
+        queueStats.overflows++;
+        return;
+    }
+
+    entry->setQueued(true);
+    dirtyEntries.push_back(entry);
 }
 
 bool ParameterMap::createMapsDir(void)
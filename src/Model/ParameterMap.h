@@ -29,13 +29,16 @@
 
 #include <ArduinoJson.h>
 #include "LookupEntry.h"
+#include "LookupTable.h"
 #include "Control.h"
 #include "Origin.h"
 #include "Event.h"
 #include "System.h"
 #include <functional>
+#include <string>
 
 class ParameterMapWindow;
+class ControlComponent;
 
 class ParameterMap
 {
@@ -264,11 +267,25 @@ public:
     /**
      * @brief Keep the current state of the ParameterMap
      * 
-     * The current state is stored on the persistent storage
-     * using the default .map file name.
+     * The current state is serialized to memory and written to
+     * the persistent storage in chunks by flushKeep(), using
+     * the default .map file name.
      */
     void keep(void);
 
+    /**
+     * @brief Write the next chunk of the kept state to the storage
+     * 
+     * The state is written to a temporary file that replaces the .map
+     * file once it is complete. Meant to be called from the user task.
+     */
+    void flushKeep(void);
+
+    /**
+     * @brief Write the remaining part of the kept state to the storage
+     */
+    void finishKeep(void);
+
     /**
      * @brief Save the current state of the ParameterMap
      * 
@@ -288,6 +305,61 @@ public:
      */
     bool load(const char *filename);
 
+    /**
+     * @brief Load the state of the ParameterMap and collect the entries
+     *  whose MIDI value was changed by the load
+     * 
+     * @param filename name of the file to be used for loading the state
+     * @param changedEntries list to store the changed entries to
+     * 
+     * @return uint16_t number of entries read from the file
+     */
+    uint16_t loadChanges(const char *filename,
+                         std::vector<LookupEntry *> &changedEntries);
+
+    /**
+     * @brief Save the current state of the ParameterMap as a binary snapshot
+     * 
+     * The file holds a fixed header followed by (hash, midiValue) pairs
+     * sorted by hash. It is written with one write and read with one read.
+     * 
+     * @param filename name of the file to be used for storing the state
+     * 
+     * @return true if the snapshot was written
+     */
+    bool saveSnapshot(const char *filename);
+
+    /**
+     * @brief Check if the file is a binary snapshot
+     * 
+     * @param filename name of the file
+     * 
+     * @return true if the file starts with the binary snapshot header
+     */
+    static bool isSnapshotImage(const char *filename);
+
+    /**
+     * @brief Convert a binary snapshot to the JSON snapshot format
+     * 
+     * @param imageFilename name of the binary snapshot file
+     * @param jsonFilename name of the JSON file to be written
+     * 
+     * @return true if the JSON file was written
+     */
+    static bool exportSnapshot(const char *imageFilename,
+                               const char *jsonFilename);
+
+    /**
+     * @brief Convert a JSON snapshot to the binary snapshot format
+     * 
+     * @param jsonFilename name of the JSON snapshot file
+     * @param imageFilename name of the binary file to be written
+     * 
+     * @return true if the binary file was written
+     */
+    static bool importSnapshot(const char *jsonFilename,
+                               const char *imageFilename);
+
     /**
      * @brief Recall the last saved state of the ParameterMap
      * 
@@ -324,6 +396,14 @@ public:
      */
     void listWindows(void);
 
+    /**
+     * @brief Invalidate ControlValue to ControlComponent bindings
+     * 
+     * Must be called whenever components of registered windows are
+     * created, re-assigned, or removed.
+     */
+    void invalidateBindings(void);
+
     /**
      * @brief Repaint all registered ParameterMapWindows
      * 
@@ -395,41 +475,113 @@ private:
     LookupEntry *getAndCache(uint32_t hash);
 
     /**
-     * @brief Serialize the ParameterMap entries.
+     * @brief Get ControlComponents displaying the ControlValue
+     * 
+     * The components are looked up in all registered windows on the first
+     * call and the result is kept until the bindings are invalidated.
      * 
-     * The JSON is written directly to the provided file.
+     * @param value ControlValue to find the components for
      * 
-     * @param file file to write to
+     * @return list of live ControlComponents bound to the value
      */
-    void serializeMap(File &file);
+    const std::vector<ControlComponent *> &
+        getBoundComponents(ControlValue *value);
 
     /**
-     * @brief Serialize the common information about the ParameterMap.
+     * @brief Serialize the ParameterMap to JSON.
      * 
-     * version and projectId are included. The JSON is written directly
-     * to the provided file.
+     * The version, projectId and all entries with a value are included.
      * 
-     * @param file file to write to
+     * @param buffer buffer to append the JSON to
      */
-    void serializeRoot(File &file);
+    void serialize(std::string &buffer);
 
     /**
-     * @brief Deserialize the ParameterMap entries.
+     * @brief Write a chunk of the kept state to the temporary file.
      * 
-     * @param file file to read from
+     * @param length maximum number of bytes to write
      * 
-     * @return true if the JSON was parsed successfully
+     * @return true if the chunk was written
+     */
+    bool writeKeepChunk(size_t length);
+
+    /**
+     * @brief Restore the .map file from a complete temporary file
+     *  left behind by an interrupted flushKeep().
+     * 
+     * @param filename name of the .map file
+     * 
+     * @return true if the .map file was restored
+     */
+    bool recoverKeep(const char *filename);
+
+    /**
+     * @brief Open and deserialize a ParameterMap file.
+     * 
+     * @param filename name of the file to read from
+     * @param changedEntries list to store the changed entries to, or nullptr
+     * @param numEntries number of entries read from the file
+     * 
+     * @return true if the file was parsed successfully
      */
-    bool parse(File &file);
+    bool load(const char *filename,
+              std::vector<LookupEntry *> *changedEntries,
+              uint16_t &numEntries);
 
     /**
      * @brief Deserialize the parameters stored the ParameterMap file.
      * 
      * @param file file to read from
+     * @param onParameter function called with the hash and the MIDI value
+     *  of every parameter
      * 
      * @return true if the JSON was parsed successfully
      */
-    bool parseParameters(File &file);
+    static bool parseParameters(
+        File &file,
+        const std::function<void(uint32_t hash, uint16_t midiValue)>
+            &onParameter);
+
+    struct SnapshotEntry {
+        uint32_t hash;
+        uint16_t midiValue;
+    };
+
+    static constexpr uint32_t SnapshotMagic = 0x504E5345; // "ESNP"
+    static constexpr uint16_t SnapshotVersion = 1;
+    static constexpr uint8_t MaxProjectIdLength = 20;
+    static constexpr size_t SnapshotHeaderLength = 8 + MaxProjectIdLength;
+    static constexpr size_t SnapshotEntryLength = 6;
+
+    /**
+     * @brief Write a binary snapshot file
+     * 
+     * @param filename name of the file to be written
+     * @param imageProjectId project Id stored in the header
+     * @param snapshotEntries entries to be stored, sorted in place by hash
+     * 
+     * @return true if the file was written
+     */
+    static bool writeSnapshotImage(const char *filename,
+                                   const char *imageProjectId,
+                                   std::vector<SnapshotEntry> &snapshotEntries);
+
+    /**
+     * @brief Read a binary snapshot file
+     * 
+     * @param filename name of the file to be read
+     * @param imageProjectId buffer to store the project Id to
+     * @param snapshotEntries list to store the entries to
+     * 
+     * @return true if the file is a valid binary snapshot
+     */
+    static bool readSnapshotImage(const char *filename,
+                                  char *imageProjectId,
+                                  std::vector<SnapshotEntry> &snapshotEntries);
+
+    static void
+        writeLittleEndian(uint8_t *buffer, uint32_t value, uint8_t length);
+    static uint32_t readLittleEndian(const uint8_t *buffer, uint8_t length);
 
     /**
      * @brief Compose a name for keeping the ParameterMap state.
@@ -442,6 +594,9 @@ private:
     /**
      * @brief Post a LookupEntry for repainting.
      * 
+     * The entry is placed in the dirty queue that is drained
+     * by the repaint task.
+     * 
      * @param entry LookupEntry to be repainted
      */
     void postEntry(LookupEntry *entry);
@@ -504,17 +659,39 @@ private:
      */
     inline static uint16_t getParameterNumber(uint32_t hash);
 
-    std::map<uint32_t, LookupEntry> entries;
+    LookupTable entries;
     LookupEntry *lastRead;
     uint32_t lastReadHash;
-    bool enabled;
     bool onReadyPending;
-    char projectId[20 + 1];
+    char projectId[MaxProjectIdLength + 1];
     char appSandbox[20 + 1];
 
     std::vector<ParameterMapWindow *> windows;
+    std::map<const ControlValue *, std::vector<ControlComponent *>>
+        componentBindings;
+
+    // Dirty queue drained by repaintParameterMap()
+    static constexpr size_t MaxDirtyEntries = 256;
+    std::vector<LookupEntry *> dirtyEntries;
+    std::vector<LookupEntry *> processedEntries;
+    bool fullRepaintPending;
+
+    struct {
+        uint16_t depth;
+        uint16_t maxDepth;
+        uint32_t drainTime;
+        uint32_t overflows;
+    } queueStats;
 
     Task repaintParameterMapTask;
+
+    // State kept by keep() and written by flushKeep()
+    static constexpr size_t KeepChunkSize = 512;
+    static constexpr size_t MaxKeepFilenameLength = 64;
+    std::string keepBuffer;
+    size_t keepOffset;
+    File keepFile;
+    char keepFilename[MaxKeepFilenameLength + 1];
 };
 
 extern ParameterMap parameterMap;
@@ -2,14 +2,18 @@
 #include "Hardware.h"
 #include "Colours.h"
 #include "JsonTools.h"
+#include "JsonStream.h"
 #include "System.h"
+#include <algorithm>
 
 Page Preset::pageNotFound;
 Device Preset::deviceNotFound;
 Control Preset::controlNotFound;
 Group Preset::groupNotFound;
+const std::vector<Control *> Preset::noControls;
+const std::vector<Group *> Preset::noGroups;
 
-Preset::Preset() : valid(false)
+Preset::Preset() : valid(false), layoutDigest(0)
 {
     reset();
 }
@@ -24,6 +28,14 @@ bool Preset::load(const char *filename)
 
     System::logger.write(LOG_INFO, "Preset::load: file: filename=%s", filename);
 
+    if (PresetCache::load(*this, filename)) {
+        layoutDigest = PresetCache::getLayoutDigest(*this, overlayItems);
+        overlayItems = std::vector<PresetCache::OverlayItem>();
+        buildPageIndex();
+        valid = true;
+        return (true);
+    }
+
     file = Hardware::sdcard.createInputStream(filename);
 
     if (!file) {
@@ -39,12 +51,18 @@ bool Preset::load(const char *filename)
                              "Preset::load: cannot parse preset: filename=%s",
                              filename);
         file.close();
+        overlayItems = std::vector<PresetCache::OverlayItem>();
         return (false);
     }
 
     file.close();
+    layoutDigest = PresetCache::getLayoutDigest(*this, overlayItems);
+    buildPageIndex();
     valid = true;
 
+    PresetCache::save(*this, overlayItems, filename);
+    overlayItems = std::vector<PresetCache::OverlayItem>();
+
     return (true);
 }
 
@@ -61,6 +79,130 @@ void Preset::reset(void)
     luaFunctions = std::vector<std::string>({ "" });
     overlays.clear();
     pages.clear();
+    responseIndex.clear();
+    overlayItems = std::vector<PresetCache::OverlayItem>();
+    layoutDigest = 0;
+}
+
+/** Find controls that were removed, added or changed in the update
+ *
+ * Only controls are compared. false is returned when anything else differs,
+ * the update must be loaded as a new preset then.
+ */
+bool Preset::diff(const Preset &update, ControlChanges &changes) const
+{
+    if (!valid || !update.valid || (layoutDigest != update.layoutDigest)
+        || (strcmp(projectId, update.projectId) != 0)) {
+        return (false);
+    }
+
+    auto current = controls.begin();
+    auto updated = update.controls.begin();
+
+    while (current != controls.end() || updated != update.controls.end()) {
+        if (updated == update.controls.end()
+            || (current != controls.end() && current->first < updated->first)) {
+            changes.removed.push_back(current->first);
+            current++;
+        } else if (current == controls.end()
+                   || updated->first < current->first) {
+            changes.added.push_back(updated->first);
+            updated++;
+        } else {
+            if (!PresetCache::isSameControl(
+                    *this, current->second, update, updated->second)) {
+                changes.changed.push_back(current->first);
+            }
+            current++;
+            updated++;
+        }
+    }
+
+    return (true);
+}
+
+/** Replace the controls listed in changes with their updated versions
+ *
+ * The update must have passed diff(). Pointers to the objects of the update
+ * are redirected to the objects of this preset.
+ */
+void Preset::applyChanges(const Preset &update, const ControlChanges &changes)
+{
+    // pages that lose a control may end up empty
+    std::vector<uint8_t> vacatedPageIds;
+
+    for (auto controlId : changes.removed) {
+        vacatedPageIds.push_back(controls[controlId].getPageId());
+        unindexControl(&controls[controlId]);
+        controls.erase(controlId);
+    }
+
+    std::vector<uint16_t> updatedIds(changes.added);
+    updatedIds.insert(
+        updatedIds.end(), changes.changed.begin(), changes.changed.end());
+
+    for (auto controlId : changes.changed) {
+        vacatedPageIds.push_back(controls[controlId].getPageId());
+    }
+
+    for (auto controlId : updatedIds) {
+        Control &control = controls[controlId];
+
+        unindexControl(&control);
+        control = update.controls.at(controlId);
+
+        for (auto &value : control.values) {
+            Message &message = value.message;
+
+            // slots of values that are not defined in the preset stay empty
+            if (value.getControl() == nullptr) {
+                continue;
+            }
+
+            value.setControl(&control);
+            message.setControlValue(&value);
+
+            if (value.getOverlay()) {
+                value.setOverlay(getOverlay(value.getOverlayId()));
+            }
+
+            if (message.data) {
+                const Device &device = update.getDevice(message.getDeviceId());
+
+                for (const auto &[messageId, data] : device.sysexMessages) {
+                    if (&data == message.data) {
+                        message.data = &devices[message.getDeviceId()]
+                                            .sysexMessages[messageId];
+                        break;
+                    }
+                }
+            }
+        }
+
+        indexControl(&control);
+        pages[control.getPageId()].setHasObjects(true);
+    }
+
+    for (auto pageId : vacatedPageIds) {
+        auto page = pages.find(pageId);
+
+        if ((page == pages.end()) || !page->second.hasObjects()) {
+            continue;
+        }
+
+        bool hasObjects = false;
+
+        for (const auto &[id, control] : controls) {
+            if (control.getPageId() == pageId) {
+                hasObjects = true;
+                break;
+            }
+        }
+        page->second.setHasObjects(hasObjects);
+    }
+
+    copyString(name, update.name, MaxNameLength);
+    version = update.version;
 }
 
 /** Reset all preset controls
@@ -78,6 +220,8 @@ void Preset::resetRoot(void)
  */
 void Preset::resetControls(void)
 {
+    resetPageIndex();
+
     for (auto &[id, control] : controls) {
         control.inputs = std::vector<Input>();
         control.values = std::vector<ControlValue>();
@@ -280,17 +424,53 @@ Control &Preset::moveControlToSlot(uint16_t controlId,
         control.inputs[0].setPotId(newPotId);
         control.setControlSetId(newControlSetId);
         control.setPageId(newPageId);
+        reindexControl(control);
     }
 
     return (control);
 }
 
+/** Update the page index after the page or control set of the control
+ *  has been changed
+ */
+void Preset::reindexControl(Control &control)
+{
+    unindexControl(&control);
+    indexControl(&control);
+}
+
+/** Get controls of given page and control set
+ *
+ * The controls are sorted by their ids.
+ */
+const std::vector<Control *> &
+    Preset::getPageControls(uint8_t pageId, uint8_t controlSetId) const
+{
+    if (pageId < 1 || pageId > MaxNumPages
+        || controlSetId >= MaxNumControlSets) {
+        return (noControls);
+    }
+    return (pageIndex[pageId - 1].controls[controlSetId]);
+}
+
+/** Get groups of given page
+ *
+ */
+const std::vector<Group *> &Preset::getPageGroups(uint8_t pageId) const
+{
+    if (pageId < 1 || pageId > MaxNumPages) {
+        return (noGroups);
+    }
+    return (pageIndex[pageId - 1].groups);
+}
+
 Device &Preset::addDevice(uint8_t deviceId,
                           const char *name,
                           uint8_t port,
                           uint8_t channel)
 {
     devices[deviceId] = Device(deviceId, name, port, channel, 0);
+    responseIndex.build(devices);
     return (devices[deviceId]);
 }
 
@@ -312,16 +492,144 @@ void Preset::resetComponents(void)
 
 /*--------------------------------------------------------------------------*/
 
+/** Build the index of controls and groups of individual pages
+ *
+ * The maps are walked in the order of ids, the index vectors are therefore
+ * sorted by ids too.
+ */
+void Preset::buildPageIndex(void)
+{
+    resetPageIndex();
+
+    for (auto &[id, group] : groups) {
+        uint8_t pageId = group.getPageId();
+
+        if (pageId >= 1 && pageId <= MaxNumPages) {
+            pageIndex[pageId - 1].groups.push_back(&group);
+        }
+    }
+    for (auto &[id, control] : controls) {
+        indexControl(&control);
+    }
+}
+
+/** Remove all controls and groups from the page index
+ *
+ */
+void Preset::resetPageIndex(void)
+{
+    for (auto &page : pageIndex) {
+        for (auto &controlSet : page.controls) {
+            controlSet.clear();
+        }
+        page.groups.clear();
+    }
+}
+
+/** Add the control to the index of its page and control set
+ *
+ */
+void Preset::indexControl(Control *control)
+{
+    uint8_t pageId = control->getPageId();
+    uint8_t controlSetId = control->getControlSetId();
+
+    if (pageId < 1 || pageId > MaxNumPages
+        || controlSetId >= MaxNumControlSets) {
+        return;
+    }
+
+    auto &controlSet = pageIndex[pageId - 1].controls[controlSetId];
+    auto position = std::lower_bound(
+        controlSet.begin(),
+        controlSet.end(),
+        control->getId(),
+        [](const Control *c, uint16_t id) { return (c->getId() < id); });
+
+    controlSet.insert(position, control);
+}
+
+/** Remove the control from the page index
+ *
+ * The control may have been changed already, all control sets are searched.
+ */
+void Preset::unindexControl(const Control *control)
+{
+    for (auto &page : pageIndex) {
+        for (auto &controlSet : page.controls) {
+            auto position =
+                std::find(controlSet.begin(), controlSet.end(), control);
+
+            if (position != controlSet.end()) {
+                controlSet.erase(position);
+                return;
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+
 /** Parse individual preset objects
  *
+ * The root object is walked once, in the order of its members in the file.
+ * Controls refer to devices and overlays, if they precede them in the file,
+ * their parsing is postponed until the rest of the root object is parsed.
  */
 bool Preset::parse(File &file)
 {
-    if (!parseRoot(file)) {
-        System::logger.write(LOG_ERROR, "Preset::parse: parseName failed");
-        reset();
+    char key[MaxKeyLength + 1];
+    bool hasDevices = false;
+    bool hasOverlays = false;
+    size_t controlsPosition = 0;
+
+    copyString(name, "No name", MaxNameLength);
+    projectId[0] = '\0';
+    version = 0;
+
+    if (file.seek(0) == false) {
+        System::logger.write(LOG_ERROR, "Preset::parse: cannot rewind the file");
         return (false);
     }
+
+    while (JsonStream::readKey(file, key, MaxKeyLength)) {
+        bool success = true;
+
+        if (strcmp(key, "version") == 0) {
+            version = JsonStream::readInteger(file);
+        } else if (strcmp(key, "name") == 0) {
+            JsonStream::readString(file, name, MaxNameLength);
+        } else if (strcmp(key, "projectId") == 0) {
+            JsonStream::readString(file, projectId, MaxProjectIdLength);
+        } else if (strcmp(key, "pages") == 0) {
+            success = parsePages(file);
+        } else if (strcmp(key, "devices") == 0) {
+            success = parseDevices(file);
+            hasDevices = true;
+        } else if (strcmp(key, "overlays") == 0) {
+            success = parseOverlays(file);
+            hasOverlays = true;
+        } else if (strcmp(key, "groups") == 0) {
+            success = parseGroups(file);
+        } else if (strcmp(key, "controls") == 0) {
+            if (hasDevices && hasOverlays) {
+                success = parseControls(file);
+            } else {
+                controlsPosition = file.position();
+                success = JsonStream::skipValue(file);
+            }
+        } else {
+            success = JsonStream::skipValue(file);
+        }
+
+        if (!success) {
+            System::logger.write(
+                LOG_ERROR, "Preset::parse: parsing of %s failed", key);
+            reset();
+            return (false);
+        }
+    }
+
     if (version != 2) {
         System::logger.write(
             LOG_ERROR,
@@ -330,30 +638,27 @@ bool Preset::parse(File &file)
         reset();
         return (false);
     }
-    if (!parsePages(file)) {
-        System::logger.write(LOG_ERROR, "Preset::parse: parsePages failed");
-        reset();
-        return (false);
-    }
-    if (!parseDevices(file)) {
-        System::logger.write(LOG_ERROR, "Preset::parse: parseDevices failed");
-        reset();
-        return (false);
-    }
-    if (!parseOverlays(file)) {
-        System::logger.write(LOG_ERROR, "Preset::parse: parseOverlays failed");
+    if (!hasDevices) {
+        System::logger.write(LOG_ERROR,
+                             "Preset::parse: devices array not found");
         reset();
         return (false);
     }
-    if (!parseGroups(file)) {
-        System::logger.write(LOG_ERROR, "Preset::parse: parseGroups failed");
-        reset();
-        return (false);
+    if (controlsPosition > 0) {
+        if (!file.seek(controlsPosition) || !parseControls(file)) {
+            System::logger.write(LOG_ERROR,
+                                 "Preset::parse: parseControls failed");
+            reset();
+            return (false);
+        }
     }
-    if (!parseControls(file)) {
-        System::logger.write(LOG_ERROR, "Preset::parse: parseControls failed");
-        reset();
+
+    for (const auto &[id, control] : controls) {
+        pages[control.getPageId()].setHasObjects(true);
     }
+
+    responseIndex.build(devices);
+
     //#ifdef DEBUG
     System::logger.write(
         LOG_INFO,
@@ -364,72 +669,12 @@ bool Preset::parse(File &file)
     return (true);
 }
 
-/** parse root preset object
- *
- */
-bool Preset::parseRoot(File &file)
-{
-    if (file.seek(0) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseRoot: cannot rewind the file");
-        return (false);
-    }
-
-    StaticJsonDocument<256> doc;
-    StaticJsonDocument<64> filter;
-
-    filter["name"] = true;
-    filter["version"] = true;
-    filter["projectId"] = true;
-
-    DeserializationError err =
-        deserializeJson(doc, file, DeserializationOption::Filter(filter));
-
-    if (err) {
-        System::logger.write(
-            LOG_ERROR, "Preset::parseRooxt: parsing failed: %s", err.c_str());
-        return (false);
-    }
-
-    const char *name = doc["name"] | "No name";
-    const char *projectId = doc["projectId"] | "";
-    uint8_t version = doc["version"];
-
-    // "this" is used here on purpose
-    copyString(this->name, name, MaxNameLength);
-    copyString(this->projectId, projectId, MaxProjectIdLength);
-    this->version = version;
-
-#ifdef DEBUG
-    System::logger.write(LOG_ERROR,
-                         "Preset::parseRoot: name=%s, version=%d, projectId=%s",
-                         name,
-                         version,
-                         projectId);
-#endif /* DEBUG */
-
-    return (true);
-}
-
 /** Parse Pages array
  *
  */
 bool Preset::parsePages(File &file)
 {
-    if (file.seek(0) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parsePages: cannot rewind the file");
-        return (false);
-    }
-
-    if (findElement(file, "\"pages\"", ARRAY) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parsePages: pages array not found");
-        return (true);
-    }
-
-    if (isElementEmpty(file)) {
-        System::logger.write(LOG_ERROR, "Preset::parsePages: no pages defined");
+    if (!JsonStream::enterArray(file)) {
         return (true);
     }
 
@@ -469,21 +714,7 @@ bool Preset::parsePages(File &file)
  */
 bool Preset::parseDevices(File &file)
 {
-    if (file.seek(0) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseDevices: cannot rewind the file");
-        return (false);
-    }
-
-    if (findElement(file, "\"devices\"", ARRAY) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseDevices: devices array not found");
-        return (false);
-    }
-
-    if (isElementEmpty(file)) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseDevices: no devices defined");
+    if (!JsonStream::enterArray(file)) {
         return (true);
     }
 
@@ -495,6 +726,7 @@ bool Preset::parseDevices(File &file)
     filter["channel"] = true;
     filter["name"] = true;
     filter["rate"] = true;
+    filter["compactOutput"] = true;
 
     uint8_t numDevices = 0;
 
@@ -537,6 +769,11 @@ bool Preset::parseDevices(File &file)
                 System::logger.write(
                     LOG_ERROR,
                     "Preset::parseDevices: max number of devices reached");
+
+                // the rest of the array must be consumed for the root walk
+                while (file.findUntil(",", "]")) {
+                    JsonStream::skipValue(file);
+                }
                 break;
             }
         } else {
@@ -552,23 +789,7 @@ bool Preset::parseDevices(File &file)
  */
 bool Preset::parseOverlays(File &file)
 {
-    if (file.seek(0) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseOverlays: cannot rewind the file");
-        return (false);
-    }
-
-    if (findElement(file, "\"overlays\"", ARRAY) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseOverlays: overlays array not found");
-        return (true);
-    }
-
-    if (isElementEmpty(file)) {
-#ifdef DEBUG
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseOverlays: no overlays defined");
-#endif
+    if (!JsonStream::enterArray(file)) {
         return (true);
     }
 
@@ -601,12 +822,22 @@ bool Preset::parseOverlays(File &file)
                 return (false);
             }
 
-            if (!this->parseOverlayItems(file, overlays[id])) {
+            if (!this->parseOverlayItems(file, id)) {
                 System::logger.write(
                     LOG_ERROR,
                     "Preset::parseOverlays: parsing of overlay items has failed");
                 return (false);
             }
+
+            // Skip the members that follow the items, up to the end
+            // of the overlay object
+            char key[MaxKeyLength + 1];
+
+            while (JsonStream::readKey(file, key, MaxKeyLength)) {
+                if (!JsonStream::skipValue(file)) {
+                    return (false);
+                }
+            }
         } else {
             break;
         }
@@ -620,23 +851,7 @@ bool Preset::parseOverlays(File &file)
  */
 bool Preset::parseGroups(File &file)
 {
-    if (file.seek(0) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseGroups: cannot rewind the file");
-        return (false);
-    }
-
-    if (findElement(file, "\"groups\"", ARRAY) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseGroups: groups array not found");
-        return (true);
-    }
-
-    if (isElementEmpty(file)) {
-#ifdef DEBUG
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseGroups: no groups defined");
-#endif
+    if (!JsonStream::enterArray(file)) {
         return (true);
     }
 
@@ -668,46 +883,27 @@ bool Preset::parseGroups(File &file)
 
 /** Parse array of Control objects
  *
+ * Every control is deserialized as a whole, including its values and inputs.
+ * Controls that do not fit the document are parsed value by value.
  */
 bool Preset::parseControls(File &file)
 {
-    if (file.seek(0) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseControls: cannot rewind the file");
-        return (false);
-    }
-
-    if (findElement(file, "\"controls\"", ARRAY) == false) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseControls: controls array not found");
-        return (true);
-    }
-
-    if (isElementEmpty(file)) {
-        System::logger.write(LOG_ERROR,
-                             "Preset::parseControls: no controls defined");
+    if (!JsonStream::enterArray(file)) {
         return (true);
     }
 
-    StaticJsonDocument<1024> doc;
-    StaticJsonDocument<512> filter;
-
-    /* filter root elements only */
-    filter["id"] = true;
-    filter["pageId"] = true;
-    filter["controlSetId"] = true;
-    filter["type"] = true;
-    filter["mode"] = true;
-    filter["name"] = true;
-    filter["color"] = true;
-    filter["variant"] = true;
-    filter["visible"] = true;
-    filter["bounds"] = true;
+    DynamicJsonDocument doc(ControlDocumentSize);
 
     do {
-        uint32_t controlStartPosition = file.position();
-        auto err =
-            deserializeJson(doc, file, DeserializationOption::Filter(filter));
+        size_t controlStartPosition = file.position();
+        auto err = deserializeJson(doc, file);
+
+        if (err == DeserializationError::NoMemory) {
+            if (!file.seek(controlStartPosition) || !parseControl(file)) {
+                return (false);
+            }
+            continue;
+        }
 
         if (err) {
             System::logger.write(
@@ -716,7 +912,6 @@ bool Preset::parseControls(File &file)
                 err.c_str());
             return (false);
         }
-        uint32_t controlEndPosition = file.position();
 
         /* parse the Control */
         JsonObject jControl = doc.as<JsonObject>();
@@ -726,29 +921,75 @@ bool Preset::parseControls(File &file)
 
             uint16_t controlId = control.getId();
             controls[controlId] = control;
-            controls[controlId].values = parseValues(file,
-                                                     controlStartPosition,
-                                                     controlEndPosition,
-                                                     &controls[controlId]);
-            controls[controlId].inputs = parseInputs(file,
-                                                     controlStartPosition,
-                                                     controlEndPosition,
-                                                     control.getType());
-            pages[controls[controlId].getPageId()].setHasObjects(true);
+            controls[controlId].values =
+                parseValues(jControl["values"], &controls[controlId]);
+            controls[controlId].inputs =
+                parseInputs(jControl["inputs"], control.getType());
         } else {
             System::logger.write(LOG_ERROR, "parseControls: broken control");
             break;
         }
+    } while (file.findUntil(",", "]"));
 
-        if (file.seek(controlEndPosition) == false) {
-            System::logger.write(
-                LOG_ERROR,
-                "Preset::parseControls: cannot rewind the end position");
-            return (false);
-        }
+    return (true);
+}
 
-    } while (file.findUntil(",", "]"));
+/** Parse a Control object that is too large to be deserialized at once
+ *
+ */
+bool Preset::parseControl(File &file)
+{
+    StaticJsonDocument<1024> doc;
+    StaticJsonDocument<512> filter;
+
+    /* filter root elements only */
+    filter["id"] = true;
+    filter["pageId"] = true;
+    filter["controlSetId"] = true;
+    filter["type"] = true;
+    filter["mode"] = true;
+    filter["name"] = true;
+    filter["color"] = true;
+    filter["variant"] = true;
+    filter["visible"] = true;
+    filter["bounds"] = true;
+
+    uint32_t controlStartPosition = file.position();
+    auto err =
+        deserializeJson(doc, file, DeserializationOption::Filter(filter));
 
+    if (err) {
+        System::logger.write(
+            LOG_ERROR,
+            "Preset::parseControl: deserializeJson() failed: %s",
+            err.c_str());
+        return (false);
+    }
+    uint32_t controlEndPosition = file.position();
+
+    JsonObject jControl = doc.as<JsonObject>();
+
+    if (!jControl) {
+        System::logger.write(LOG_ERROR, "parseControl: broken control");
+        return (false);
+    }
+
+    Control control = parseControl(jControl);
+
+    uint16_t controlId = control.getId();
+    controls[controlId] = control;
+    controls[controlId].values = parseValues(file,
+                                             controlStartPosition,
+                                             controlEndPosition,
+                                             &controls[controlId]);
+    controls[controlId].inputs = parseInputs(
+        file, controlStartPosition, controlEndPosition, control.getType());
+
+    if (file.seek(controlEndPosition) == false) {
+        System::logger.write(
+            LOG_ERROR, "Preset::parseControl: cannot rewind the end position");
+        return (false);
+    }
     return (true);
 }
 
@@ -789,19 +1030,24 @@ Device Preset::parseDevice(JsonObject jDevice)
     uint8_t channel = constrainChannel(jDevice["channel"]);
     const char *name = jDevice["name"];
     uint16_t rate = constrainRate(jDevice["rate"]);
+    bool compactOutput = jDevice["compactOutput"] | false;
 
 #ifdef DEBUG
     System::logger.write(
         LOG_ERROR,
-        "parseDevice: device created: id=%d, port=%d, channel=%d, name=%s, rate=%d",
+        "parseDevice: device created: id=%d, port=%d, channel=%d, name=%s, rate=%d, compactOutput=%d",
         id,
         port,
         channel,
         name,
-        rate);
+        rate,
+        compactOutput);
 #endif /* DEBUG */
 
-    return (Device(id, name, port, channel, rate));
+    Device device(id, name, port, channel, rate);
+    device.setCompactOutput(compactOutput);
+
+    return (device);
 }
 
 /** Parse array of Patches within a file
@@ -1001,8 +1247,10 @@ std::vector<uint8_t> Preset::parseRequest(JsonArray jRequest, uint8_t deviceId)
 /** Parse array of overlay items of given overlay
  *
  */
-bool Preset::parseOverlayItems(File &file, Overlay &overlay)
+bool Preset::parseOverlayItems(File &file, uint8_t overlayId)
 {
+    Overlay &overlay = overlays[overlayId];
+
     if (findElement(file, "\"items\"", ARRAY) == false) {
         System::logger.write(
             LOG_ERROR, "Preset::parseOverlayItems: items array not found");
@@ -1039,11 +1287,15 @@ bool Preset::parseOverlayItems(File &file, Overlay &overlay)
 #endif /* DEBUG */
 
             overlay.addItem(value, label, bitmap);
+            overlayItems.push_back(PresetCache::OverlayItem{
+                overlayId, value, label, bitmap ? bitmap : "" });
         } else {
             break;
         }
     } while (file.findUntil(",", "]"));
 
+    overlay.buildIndex();
+
     return (true);
 }
 
@@ -1130,6 +1382,20 @@ std::vector<Input> Preset::parseInputs(File &file,
     return (inputs);
 }
 
+/** Parse an array of Control input JSON objects
+ *
+ */
+std::vector<Input> Preset::parseInputs(JsonArray jInputs,
+                                       Control::Type controlType)
+{
+    std::vector<Input> inputs;
+
+    for (JsonObject jInput : jInputs) {
+        inputs.push_back(parseInput(controlType, jInput));
+    }
+    return (inputs);
+}
+
 /** Parse an individual Control input
  *
  */
@@ -1208,6 +1474,24 @@ std::vector<ControlValue> Preset::parseValues(File &file,
     return (values);
 }
 
+/** Parse array of Value JSON objects of the Control
+ *
+ */
+std::vector<ControlValue> Preset::parseValues(JsonArray jValues,
+                                              Control *control)
+{
+    std::vector<ControlValue> values(Preset::getNumValues(control->getType()));
+
+    for (JsonObject jValue : jValues) {
+        ControlValue value = parseValue(control, jValue);
+        ControlValue &currentValue = values[value.getIndex()];
+        currentValue = value;
+        currentValue.message.setControlValue(&currentValue);
+    }
+
+    return (values);
+}
+
 /* Parse individual Value out of the Value Array
  *
  */
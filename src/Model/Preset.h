@@ -10,6 +10,8 @@
 #include "Overlay.h"
 #include "Group.h"
 #include "Control.h"
+#include "ResponseIndex.h"
+#include "PresetCache.h"
 
 #include "Rule.h"
 #include "Checksum.h"
@@ -17,11 +19,20 @@
 class Preset
 {
 public:
+    // Ids of controls that differ between two revisions of the preset
+    struct ControlChanges {
+        std::vector<uint16_t> removed;
+        std::vector<uint16_t> added;
+        std::vector<uint16_t> changed;
+    };
+
     Preset();
     virtual ~Preset() = default;
 
     bool load(const char *filename);
     void reset(void);
+    bool diff(const Preset &update, ControlChanges &changes) const;
+    void applyChanges(const Preset &update, const ControlChanges &changes);
 
     bool isValid(void) const;
     const char *getName(void) const;
@@ -48,6 +59,11 @@ public:
     Control &moveControlToSlot(uint16_t controlId,
                                uint8_t newPageId,
                                uint8_t slotId);
+    void reindexControl(Control &control);
+
+    const std::vector<Control *> &getPageControls(uint8_t pageId,
+                                                  uint8_t controlSetId) const;
+    const std::vector<Group *> &getPageGroups(uint8_t pageId) const;
 
     Device &addDevice(uint8_t deviceId,
                       const char *name,
@@ -70,13 +86,29 @@ public:
     std::vector<std::string> luaFunctions;
 
 private:
+    friend class PresetCache;
+
+    static constexpr uint8_t MaxKeyLength = 20;
+    static constexpr size_t ControlDocumentSize = 16384;
+
+    // Controls and groups of a page, controls are split by control set
+    struct PageIndex {
+        std::vector<Control *> controls[MaxNumControlSets];
+        std::vector<Group *> groups;
+    };
+
     // Main parser
     bool parse(File &file);
     void resetRoot(void);
     void resetControls(void);
 
+    // Page index
+    void buildPageIndex(void);
+    void resetPageIndex(void);
+    void indexControl(Control *control);
+    void unindexControl(const Control *control);
+
     // Root Elements
-    bool parseRoot(File &file);
     bool parsePages(File &file);
     bool parseDevices(File &file);
     bool parseOverlays(File &file);
@@ -109,12 +141,13 @@ private:
     std::vector<uint8_t> parseRequest(JsonArray jRequest, uint8_t deviceId);
 
     // Overlays
-    bool parseOverlayItems(File &file, Overlay &overlay);
+    bool parseOverlayItems(File &file, uint8_t overlayId);
 
     // Groups
     Group parseGroup(JsonObject jGroup);
 
     // Controls
+    bool parseControl(File &file);
     Control parseControl(JsonObject jControl);
 
     // Inputs
@@ -122,6 +155,8 @@ private:
                                    size_t startPosition,
                                    size_t endPosition,
                                    Control::Type controlType);
+    std::vector<Input> parseInputs(JsonArray jInputs,
+                                   Control::Type controlType);
     Input
         parseInput(File &file, size_t startPosition, Control::Type controlType);
     Input parseInput(Control::Type controlType, JsonObject jInput);
@@ -131,6 +166,8 @@ private:
                                           size_t startPosition,
                                           size_t endPosition,
                                           Control *control);
+    std::vector<ControlValue> parseValues(JsonArray jValues,
+                                          Control *control);
     ControlValue parseValue(File &file, size_t startPosition, Control *control);
     ControlValue parseValue(Control *control, JsonObject jValue);
 
@@ -197,6 +234,17 @@ private:
     char name[MaxNameLength + 1];
     char projectId[MaxProjectIdLength + 1];
     bool valid;
+    uint32_t layoutDigest;
+
+    // Overlay items are kept only until the preset image is written
+    std::vector<PresetCache::OverlayItem> overlayItems;
+
+    // Controls and groups are not moved within their maps, it is safe
+    // to keep pointers to them until the maps are cleared
+    PageIndex pageIndex[MaxNumPages];
+
+    static const std::vector<Control *> noControls;
+    static const std::vector<Group *> noGroups;
 
 public: // Public on the purpose
     Pages pages;
@@ -204,6 +252,7 @@ public: // Public on the purpose
     Groups groups;
     Controls controls;
     Overlays overlays;
+    ResponseIndex responseIndex;
 
     static Page pageNotFound;
     static Device deviceNotFound;
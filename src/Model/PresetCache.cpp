@@ -0,0 +1,764 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+/**
+ * @file PresetCache.cpp
+ *
+ * @brief Implements a compact binary image of a parsed Preset.
+ *
+ * All integers are stored little-endian, strings and byte arrays are
+ * prefixed with their 16bit length. The payload is followed by its
+ * FNV-1a hash to detect partially written images.
+ */
+
+#include "PresetCache.h"
+#include "Preset.h"
+#include "Hardware.h"
+#include "System.h"
+#include <cstring>
+
+class PresetCache::Writer
+{
+public:
+    void write8(uint8_t value)
+    {
+        buffer.push_back(value);
+    }
+
+    void write16(uint16_t value)
+    {
+        write8(value & 0xFF);
+        write8(value >> 8);
+    }
+
+    void write32(uint32_t value)
+    {
+        write16(value & 0xFFFF);
+        write16(value >> 16);
+    }
+
+    void writeString(const char *value)
+    {
+        size_t length = value ? strlen(value) : 0;
+        write16(length);
+        buffer.insert(buffer.end(), value, value + length);
+    }
+
+    void writeBytes(const std::vector<uint8_t> &bytes)
+    {
+        write16(bytes.size());
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+    }
+
+    std::vector<uint8_t> buffer;
+};
+
+class PresetCache::Reader
+{
+public:
+    explicit Reader(const std::vector<uint8_t> &newBuffer)
+        : buffer(newBuffer), position(0), failed(false)
+    {
+    }
+
+    uint8_t read8(void)
+    {
+        if (position >= buffer.size()) {
+            failed = true;
+            return (0);
+        }
+        return (buffer[position++]);
+    }
+
+    uint16_t read16(void)
+    {
+        uint16_t value = read8();
+        return (value | (read8() << 8));
+    }
+
+    uint32_t read32(void)
+    {
+        uint32_t value = read16();
+        return (value | ((uint32_t)read16() << 16));
+    }
+
+    std::string readString(void)
+    {
+        uint16_t length = read16();
+
+        if (failed || (position + length > buffer.size())) {
+            failed = true;
+            return (std::string());
+        }
+        if (length == 0) {
+            return (std::string());
+        }
+
+        std::string value((const char *)&buffer[position], length);
+        position += length;
+        return (value);
+    }
+
+    std::vector<uint8_t> readBytes(void)
+    {
+        uint16_t length = read16();
+
+        if (failed || (position + length > buffer.size())) {
+            failed = true;
+            return (std::vector<uint8_t>());
+        }
+
+        std::vector<uint8_t> bytes(buffer.begin() + position,
+                                   buffer.begin() + position + length);
+        position += length;
+        return (bytes);
+    }
+
+    bool isValid(void) const
+    {
+        return (!failed);
+    }
+
+private:
+    const std::vector<uint8_t> &buffer;
+    size_t position;
+    bool failed;
+};
+
+static uint32_t calculateHash(const uint8_t *data, size_t length)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return (hash);
+}
+
+bool PresetCache::load(Preset &preset, const char *presetFilename)
+{
+    char cacheFilename[MAX_FILENAME_LENGTH + 1];
+
+    if (!getCacheFilename(presetFilename, cacheFilename, MAX_FILENAME_LENGTH)
+        || !Hardware::sdcard.exists(cacheFilename)) {
+        return (false);
+    }
+
+    File file = Hardware::sdcard.createInputStream(cacheFilename);
+
+    if (!file) {
+        return (false);
+    }
+
+    std::vector<uint8_t> buffer(file.size());
+    size_t bytesRead = file.read(buffer.data(), buffer.size());
+    file.close();
+
+    if (bytesRead != buffer.size()) {
+        System::logger.write(
+            LOG_ERROR, "PresetCache::load: read failed: file=%s", cacheFilename);
+        return (false);
+    }
+
+    Reader reader(buffer);
+
+    uint32_t magic = reader.read32();
+    uint16_t formatVersion = reader.read16();
+    uint32_t sourceSize = reader.read32();
+    uint32_t payloadLength = reader.read32();
+    const size_t headerLength = 14;
+
+    if (!reader.isValid() || (magic != Magic)
+        || (formatVersion != FormatVersion)
+        || (sourceSize != getFileSize(presetFilename))
+        || (headerLength + payloadLength + 4 != buffer.size())) {
+        System::logger.write(
+            LOG_INFO, "PresetCache::load: stale image: file=%s", cacheFilename);
+        invalidate(presetFilename);
+        return (false);
+    }
+
+    uint32_t hash = buffer[buffer.size() - 4] | (buffer[buffer.size() - 3] << 8)
+                    | (buffer[buffer.size() - 2] << 16)
+                    | ((uint32_t)buffer[buffer.size() - 1] << 24);
+
+    if (hash != calculateHash(&buffer[headerLength], payloadLength)) {
+        System::logger.write(LOG_ERROR,
+                             "PresetCache::load: corrupted image: file=%s",
+                             cacheFilename);
+        invalidate(presetFilename);
+        return (false);
+    }
+
+    if (!readPreset(reader, preset)) {
+        System::logger.write(LOG_ERROR,
+                             "PresetCache::load: cannot restore preset: file=%s",
+                             cacheFilename);
+        preset.reset();
+        invalidate(presetFilename);
+        return (false);
+    }
+
+    System::logger.write(LOG_INFO,
+                         "PresetCache::load: preset restored: file=%s, size=%d",
+                         cacheFilename,
+                         buffer.size());
+    return (true);
+}
+
+bool PresetCache::save(const Preset &preset,
+                       const std::vector<OverlayItem> &overlayItems,
+                       const char *presetFilename)
+{
+    char cacheFilename[MAX_FILENAME_LENGTH + 1];
+
+    if (!getCacheFilename(presetFilename, cacheFilename, MAX_FILENAME_LENGTH)) {
+        return (false);
+    }
+
+    Writer writer;
+
+    writer.write32(Magic);
+    writer.write16(FormatVersion);
+    writer.write32(getFileSize(presetFilename));
+    writer.write32(0); // payload length, set below
+
+    size_t headerLength = writer.buffer.size();
+
+    writePreset(writer, preset, overlayItems);
+
+    uint32_t payloadLength = writer.buffer.size() - headerLength;
+
+    for (uint8_t i = 0; i < 4; i++) {
+        writer.buffer[headerLength - 4 + i] = (payloadLength >> (i * 8)) & 0xFF;
+    }
+    writer.write32(calculateHash(&writer.buffer[headerLength], payloadLength));
+
+    File file = Hardware::sdcard.createOutputStream(
+        cacheFilename, FILE_WRITE | O_CREAT | O_TRUNC);
+
+    if (!file) {
+        System::logger.write(LOG_ERROR,
+                             "PresetCache::save: cannot open file: %s",
+                             cacheFilename);
+        return (false);
+    }
+
+    size_t bytesWritten = file.write(writer.buffer.data(), writer.buffer.size());
+    file.close();
+
+    if (bytesWritten != writer.buffer.size()) {
+        System::logger.write(
+            LOG_ERROR, "PresetCache::save: write failed: file=%s", cacheFilename);
+        Hardware::sdcard.deleteFile(cacheFilename);
+        return (false);
+    }
+
+    System::logger.write(LOG_INFO,
+                         "PresetCache::save: image written: file=%s, size=%d",
+                         cacheFilename,
+                         writer.buffer.size());
+    return (true);
+}
+
+void PresetCache::invalidate(const char *presetFilename)
+{
+    char cacheFilename[MAX_FILENAME_LENGTH + 1];
+
+    if (getCacheFilename(presetFilename, cacheFilename, MAX_FILENAME_LENGTH)
+        && Hardware::sdcard.exists(cacheFilename)) {
+        Hardware::sdcard.deleteFile(cacheFilename);
+    }
+}
+
+uint32_t
+    PresetCache::getLayoutDigest(const Preset &preset,
+                                 const std::vector<OverlayItem> &overlayItems)
+{
+    Writer writer;
+
+    writeLayout(writer, preset, overlayItems);
+
+    return (calculateHash(writer.buffer.data(), writer.buffer.size()));
+}
+
+bool PresetCache::isSameControl(const Preset &preset,
+                                const Control &control,
+                                const Preset &otherPreset,
+                                const Control &otherControl)
+{
+    Writer writer;
+    Writer otherWriter;
+
+    writeControl(writer, preset, control);
+    writeControl(otherWriter, otherPreset, otherControl);
+
+    return (writer.buffer == otherWriter.buffer);
+}
+
+bool PresetCache::getCacheFilename(const char *presetFilename,
+                                   char *cacheFilename,
+                                   size_t maxCacheFilenameLength)
+{
+    if (!presetFilename) {
+        return (false);
+    }
+
+    const char *extension = strrchr(presetFilename, '.');
+    size_t baseLength =
+        extension ? (extension - presetFilename) : strlen(presetFilename);
+
+    if (baseLength + 4 > maxCacheFilenameLength) {
+        return (false);
+    }
+
+    memcpy(cacheFilename, presetFilename, baseLength);
+    strcpy(cacheFilename + baseLength, ".epc");
+
+    return (true);
+}
+
+uint32_t PresetCache::getFileSize(const char *filename)
+{
+    uint32_t size = 0;
+
+    if (File file = Hardware::sdcard.createInputStream(filename)) {
+        size = file.size();
+        file.close();
+    }
+    return (size);
+}
+
+void PresetCache::writePreset(Writer &writer,
+                              const Preset &preset,
+                              const std::vector<OverlayItem> &overlayItems)
+{
+    writer.writeString(preset.name);
+    writer.writeString(preset.projectId);
+    writer.write8(preset.version);
+
+    writeLayout(writer, preset, overlayItems);
+
+    writer.write16(preset.controls.size());
+    for (const auto &[id, control] : preset.controls) {
+        writeControl(writer, preset, control);
+    }
+}
+
+/** Write everything but the root attributes and controls
+ *
+ */
+void PresetCache::writeLayout(Writer &writer,
+                              const Preset &preset,
+                              const std::vector<OverlayItem> &overlayItems)
+{
+    writer.write16(preset.luaFunctions.size());
+    for (const auto &luaFunction : preset.luaFunctions) {
+        writer.writeString(luaFunction.c_str());
+    }
+
+    writer.write8(preset.pages.size());
+    for (const auto &[id, page] : preset.pages) {
+        writer.write8(id);
+        writer.writeString(page.getName());
+        writer.write8(page.getDefaultControlSetId());
+        writer.write8(page.isHidden());
+    }
+
+    writer.write8(preset.devices.size());
+    for (const auto &[id, device] : preset.devices) {
+        writer.write8(id);
+        writer.writeString(device.getName());
+        writer.write8(device.getPort());
+        writer.write8(device.getChannel());
+        writer.write16(device.getRate());
+        writer.write8(device.hasCompactOutput());
+        writer.write16(device.lastMessageId);
+
+        writer.write16(device.sysexMessages.size());
+        for (const auto &[messageId, data] : device.sysexMessages) {
+            writer.write8(messageId);
+            writer.writeBytes(data);
+        }
+
+        writer.write16(device.requests.size());
+        for (const auto &request : device.requests) {
+            writer.writeBytes(request);
+        }
+
+        writer.write8(device.responses.size());
+        for (const auto &response : device.responses) {
+            writer.write8(response.getId());
+            writer.writeBytes(response.headers);
+            writer.write16(response.rules.size());
+            for (const auto &rule : response.rules) {
+                writer.write8((uint8_t)rule.getType());
+                writer.write16(rule.getParameterNumber());
+                writer.write16(rule.getByte());
+                writer.write8(rule.getParameterBitPosition());
+                writer.write8(rule.getByteBitPosition());
+                writer.write8(rule.getBitWidth());
+            }
+        }
+    }
+
+    writer.write8(preset.overlays.size());
+    for (const auto &[id, overlay] : preset.overlays) {
+        writer.write8(id);
+    }
+
+    writer.write16(overlayItems.size());
+    for (const auto &item : overlayItems) {
+        writer.write8(item.overlayId);
+        writer.write16(item.value);
+        writer.writeString(item.label.c_str());
+        writer.writeString(item.bitmap.c_str());
+    }
+
+    writer.write16(preset.groups.size());
+    for (const auto &[id, group] : preset.groups) {
+        Rectangle bounds = group.getBounds();
+
+        writer.write16(id);
+        writer.write8(group.getPageId());
+        writer.write16(bounds.getX());
+        writer.write16(bounds.getY());
+        writer.write16(bounds.getWidth());
+        writer.write16(bounds.getHeight());
+        writer.writeString(group.getLabel());
+        writer.write32(group.getColour());
+        writer.write8((uint8_t)group.getVariant());
+        writer.write8(group.isVisible());
+    }
+}
+
+void PresetCache::writeControl(Writer &writer,
+                               const Preset &preset,
+                               const Control &control)
+{
+    Rectangle bounds = control.getBounds();
+
+    writer.write16(control.getId());
+    writer.write8(control.getPageId());
+    writer.writeString(control.getName());
+    writer.write16(bounds.getX());
+    writer.write16(bounds.getY());
+    writer.write16(bounds.getWidth());
+    writer.write16(bounds.getHeight());
+    writer.write8((uint8_t)control.getType());
+    writer.write8((uint8_t)control.getMode());
+    writer.write32(control.getColour());
+    writer.write8(control.getControlSetId());
+    writer.write8((uint8_t)control.getVariant());
+    writer.write8(control.isVisible());
+
+    writer.write8(control.inputs.size());
+    for (const auto &input : control.inputs) {
+        writer.write8(input.getValueId());
+        writer.write8(input.getPotId());
+    }
+
+    writer.write8(control.values.size());
+    for (const auto &value : control.values) {
+        // slots of values that are not defined in the preset stay empty
+        if (value.getControl() == nullptr) {
+            writer.write8(false);
+            continue;
+        }
+
+        const Message &message = value.message;
+        uint16_t dataId = NoData;
+
+        if (message.data) {
+            const auto &device = preset.getDevice(message.getDeviceId());
+
+            for (const auto &[messageId, data] : device.sysexMessages) {
+                if (&data == message.data) {
+                    dataId = messageId;
+                    break;
+                }
+            }
+        }
+
+        writer.write8(true);
+        writer.writeString(value.getId());
+        writer.write8(value.getIndex());
+        writer.write16(value.getDefault());
+        writer.write16(value.getMin());
+        writer.write16(value.getMax());
+        writer.write8(value.getOverlayId());
+        writer.write8(value.formatter);
+        writer.write8(value.function);
+
+        writer.write8(message.getDeviceId());
+        writer.write8((uint8_t)message.getType());
+        writer.write16(message.getParameterNumber());
+        writer.write16(message.getMidiMin());
+        writer.write16(message.getMidiMax());
+        writer.write16(message.getValue());
+        writer.write16(dataId);
+        writer.write8(message.getLsbFirst());
+        writer.write8(message.getResetRpn());
+        writer.write8((uint8_t)message.getSignMode());
+        writer.write8(message.getBitWidth());
+        writer.write8(message.isRelative());
+        writer.write8((uint8_t)message.getRelativeMode());
+        writer.write8(message.isAccelerated());
+    }
+}
+
+bool PresetCache::readPreset(Reader &reader, Preset &preset)
+{
+    copyString(preset.name, reader.readString().c_str(), Preset::MaxNameLength);
+    copyString(preset.projectId,
+               reader.readString().c_str(),
+               Preset::MaxProjectIdLength);
+    preset.version = reader.read8();
+
+    uint16_t numLuaFunctions = reader.read16();
+    preset.luaFunctions.clear();
+    for (uint16_t i = 0; i < numLuaFunctions && reader.isValid(); i++) {
+        preset.luaFunctions.push_back(reader.readString());
+    }
+
+    uint8_t numPages = reader.read8();
+    for (uint8_t i = 0; i < numPages && reader.isValid(); i++) {
+        uint8_t id = reader.read8();
+        std::string name = reader.readString();
+        uint8_t defaultControlSetId = reader.read8();
+        bool hidden = reader.read8();
+
+        preset.pages[id] = Page(id, name.c_str(), defaultControlSetId, hidden);
+    }
+
+    uint8_t numDevices = reader.read8();
+    for (uint8_t i = 0; i < numDevices && reader.isValid(); i++) {
+        uint8_t id = reader.read8();
+        std::string name = reader.readString();
+        uint8_t port = reader.read8();
+        uint8_t channel = reader.read8();
+        uint16_t rate = reader.read16();
+        bool compactOutput = reader.read8();
+
+        Device &device = preset.devices[id];
+        device = Device(id, name.c_str(), port, channel, rate);
+        device.setCompactOutput(compactOutput);
+        device.lastMessageId = reader.read16();
+
+        uint16_t numMessages = reader.read16();
+        for (uint16_t j = 0; j < numMessages && reader.isValid(); j++) {
+            uint8_t messageId = reader.read8();
+            device.sysexMessages[messageId] = reader.readBytes();
+        }
+
+        uint16_t numRequests = reader.read16();
+        for (uint16_t j = 0; j < numRequests && reader.isValid(); j++) {
+            device.requests.push_back(reader.readBytes());
+        }
+
+        uint8_t numResponses = reader.read8();
+        for (uint8_t j = 0; j < numResponses && reader.isValid(); j++) {
+            Response response;
+
+            response.setId(reader.read8());
+            response.headers = reader.readBytes();
+
+            uint16_t numRules = reader.read16();
+            for (uint16_t k = 0; k < numRules && reader.isValid(); k++) {
+                Message::Type type = (Message::Type)reader.read8();
+                uint16_t parameterNumber = reader.read16();
+                uint16_t byte = reader.read16();
+                uint8_t parameterBitPosition = reader.read8();
+                uint8_t byteBitPosition = reader.read8();
+                uint8_t bitWidth = reader.read8();
+
+                response.rules.push_back(Rule(type,
+                                              parameterNumber,
+                                              byte,
+                                              parameterBitPosition,
+                                              byteBitPosition,
+                                              bitWidth));
+            }
+            device.responses.push_back(response);
+        }
+    }
+
+    uint8_t numOverlays = reader.read8();
+    for (uint8_t i = 0; i < numOverlays && reader.isValid(); i++) {
+        uint8_t id = reader.read8();
+        preset.overlays[id] = Overlay(id);
+    }
+
+    uint16_t numOverlayItems = reader.read16();
+    for (uint16_t i = 0; i < numOverlayItems && reader.isValid(); i++) {
+        uint8_t overlayId = reader.read8();
+        int16_t value = reader.read16();
+        std::string label = reader.readString();
+        std::string bitmap = reader.readString();
+
+        preset.overlays[overlayId].addItem(
+            value, label.c_str(), bitmap.empty() ? nullptr : bitmap.c_str());
+
+        // kept for the layout digest until the preset is loaded
+        preset.overlayItems.push_back(OverlayItem{
+            overlayId, value, std::move(label), std::move(bitmap) });
+    }
+
+    for (auto &[id, overlay] : preset.overlays) {
+        overlay.buildIndex();
+    }
+
+    uint16_t numGroups = reader.read16();
+    for (uint16_t i = 0; i < numGroups && reader.isValid(); i++) {
+        uint16_t id = reader.read16();
+        uint8_t pageId = reader.read8();
+        uint16_t x = reader.read16();
+        uint16_t y = reader.read16();
+        uint16_t width = reader.read16();
+        uint16_t height = reader.read16();
+        std::string label = reader.readString();
+        uint32_t colour = reader.read32();
+        Group::Variant variant = (Group::Variant)reader.read8();
+        bool visible = reader.read8();
+
+        preset.groups[id] = Group(id,
+                                  pageId,
+                                  Rectangle(x, y, width, height),
+                                  label.c_str(),
+                                  colour,
+                                  variant);
+        preset.groups[id].setVisible(visible);
+    }
+
+    uint16_t numControls = reader.read16();
+    for (uint16_t i = 0; i < numControls && reader.isValid(); i++) {
+        uint16_t id = reader.read16();
+        uint8_t pageId = reader.read8();
+        std::string name = reader.readString();
+        uint16_t x = reader.read16();
+        uint16_t y = reader.read16();
+        uint16_t width = reader.read16();
+        uint16_t height = reader.read16();
+        Control::Type type = (Control::Type)reader.read8();
+        Control::Mode mode = (Control::Mode)reader.read8();
+        uint32_t colour = reader.read32();
+        uint8_t controlSetId = reader.read8();
+        Control::Variant variant = (Control::Variant)reader.read8();
+        bool visible = reader.read8();
+
+        preset.controls[id] = Control(id,
+                                      pageId,
+                                      name.c_str(),
+                                      Rectangle(x, y, width, height),
+                                      type,
+                                      mode,
+                                      colour,
+                                      controlSetId,
+                                      variant,
+                                      visible);
+        Control &control = preset.controls[id];
+
+        uint8_t numInputs = reader.read8();
+        for (uint8_t j = 0; j < numInputs && reader.isValid(); j++) {
+            uint8_t valueId = reader.read8();
+            uint8_t potId = reader.read8();
+            control.inputs.push_back(Input(valueId, potId));
+        }
+
+        uint8_t numValues = reader.read8();
+        std::vector<ControlValue> values(numValues);
+
+        for (uint8_t j = 0; j < numValues && reader.isValid(); j++) {
+            if (!reader.read8()) {
+                continue;
+            }
+
+            std::string valueId = reader.readString();
+            uint8_t index = reader.read8();
+            int16_t defaultValue = reader.read16();
+            int16_t min = reader.read16();
+            int16_t max = reader.read16();
+            uint8_t overlayId = reader.read8();
+            uint8_t formatter = reader.read8();
+            uint8_t function = reader.read8();
+
+            uint8_t deviceId = reader.read8();
+            Message::Type messageType = (Message::Type)reader.read8();
+            uint16_t parameterNumber = reader.read16();
+            uint16_t midiMin = reader.read16();
+            uint16_t midiMax = reader.read16();
+            uint16_t midiValue = reader.read16();
+            uint16_t dataId = reader.read16();
+            bool lsbFirst = reader.read8();
+            bool resetRpn = reader.read8();
+            SignMode signMode = (SignMode)reader.read8();
+            uint8_t bitWidth = reader.read8();
+            bool relative = reader.read8();
+            RelativeMode relativeMode = (RelativeMode)reader.read8();
+            bool accelerated = reader.read8();
+
+            DataBytes *data = nullptr;
+
+            if (dataId != NoData) {
+                data = &preset.devices[deviceId].sysexMessages[dataId];
+            }
+
+            Message message(deviceId,
+                            messageType,
+                            parameterNumber,
+                            midiMin,
+                            midiMax,
+                            midiValue,
+                            data,
+                            lsbFirst,
+                            resetRpn,
+                            signMode,
+                            bitWidth,
+                            relative,
+                            relativeMode,
+                            accelerated);
+
+            values[j] = ControlValue(&control,
+                                     valueId.c_str(),
+                                     index,
+                                     defaultValue,
+                                     min,
+                                     max,
+                                     overlayId,
+                                     message,
+                                     formatter,
+                                     function,
+                                     preset.getOverlay(overlayId));
+            values[j].message.setControlValue(&values[j]);
+        }
+
+        control.values = std::move(values);
+        preset.pages[pageId].setHasObjects(true);
+    }
+
+    if (!reader.isValid()) {
+        return (false);
+    }
+
+    preset.responseIndex.build(preset.devices);
+
+    return (true);
+}
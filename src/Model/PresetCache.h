@@ -0,0 +1,132 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+/**
+ * @file PresetCache.h
+ *
+ * @brief Implements a compact binary image of a parsed Preset.
+ *
+ * The image is stored next to the preset file, with the .epc extension.
+ * It is written after the first successful parse of the preset and read
+ * with one sequential read on subsequent loads. The image is discarded
+ * when its format version or the size of the preset file do not match,
+ * and it is removed whenever the preset file is replaced.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Preset;
+class Control;
+
+class PresetCache
+{
+public:
+    struct OverlayItem {
+        uint8_t overlayId;
+        int16_t value;
+        std::string label;
+        std::string bitmap;
+    };
+
+    /**
+     * @brief Restores the preset from its binary image
+     *
+     * @param preset preset to be restored
+     * @param presetFilename name of the preset (.epr) file
+     * @return true when the image was valid and the preset restored
+     */
+    static bool load(Preset &preset, const char *presetFilename);
+
+    /**
+     * @brief Writes the binary image of a parsed preset
+     *
+     * @param preset successfully parsed preset
+     * @param overlayItems overlay items collected during the parse
+     * @param presetFilename name of the preset (.epr) file
+     * @return true when the image was written
+     */
+    static bool save(const Preset &preset,
+                     const std::vector<OverlayItem> &overlayItems,
+                     const char *presetFilename);
+
+    /**
+     * @brief Removes the binary image of a preset
+     *
+     * @param presetFilename name of the preset (.epr) file
+     */
+    static void invalidate(const char *presetFilename);
+
+    /**
+     * @brief Calculates a digest of all preset objects but controls
+     *
+     * Presets with the same digest share their pages, devices, overlays,
+     * groups and Lua functions.
+     *
+     * @param preset parsed preset
+     * @param overlayItems overlay items collected during the load
+     * @return uint32_t digest of the preset layout
+     */
+    static uint32_t
+        getLayoutDigest(const Preset &preset,
+                        const std::vector<OverlayItem> &overlayItems);
+
+    /**
+     * @brief Tells if two controls have identical definitions
+     *
+     * @param preset preset of the first control
+     * @param control the first control
+     * @param otherPreset preset of the second control
+     * @param otherControl the second control
+     * @return true when the controls would be stored identically
+     */
+    static bool isSameControl(const Preset &preset,
+                              const Control &control,
+                              const Preset &otherPreset,
+                              const Control &otherControl);
+
+private:
+    static constexpr uint32_t Magic = 0x43525045; // "EPRC"
+    static constexpr uint16_t FormatVersion = 2;
+    static constexpr uint16_t NoData = 0xFFFF;
+
+    class Writer;
+    class Reader;
+
+    static bool getCacheFilename(const char *presetFilename,
+                                 char *cacheFilename,
+                                 size_t maxCacheFilenameLength);
+    static uint32_t getFileSize(const char *filename);
+
+    static void writePreset(Writer &writer,
+                            const Preset &preset,
+                            const std::vector<OverlayItem> &overlayItems);
+    static void writeLayout(Writer &writer,
+                            const Preset &preset,
+                            const std::vector<OverlayItem> &overlayItems);
+    static void writeControl(Writer &writer,
+                             const Preset &preset,
+                             const Control &control);
+    static bool readPreset(Reader &reader, Preset &preset);
+};
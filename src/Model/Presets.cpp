@@ -1,7 +1,9 @@
 #include "Presets.h"
 #include "MidiOutput.h"
 #include "MidiCallbacks.h"
+#include "SysexJsonWriter.h"
 #include "luaExtension.h"
+#include "ValueTransform.h"
 
 #pragma GCC optimize("O0")
 
@@ -15,78 +17,208 @@ Presets::Presets(const char *newAppSandbox,
       pendingBankNumber(0),
       presetChangePending(false),
       readyForPresetSwitch(true),
+      presetRamUsage(0),
+      presetFileSize(0),
+      loadedPresetId(NoPresetLoaded),
       keepPresetState(shouldKeepPresetState),
       loadPresetStateOnStartup(shouldLoadPresetStateOnStartup)
 {
 }
 
-void Presets::assignPresetNames(void)
+/** Assign names and project ids to all preset slots.
+ *  The names are read from the preset index. The preset files are scanned
+ *  only when the index is missing, broken, or a rescan is requested.
+ */
+void Presets::assignPresetNames(bool rescan)
+{
+    uint32_t startTime = millis();
+    bool indexUsed = !rescan && loadPresetIndex();
+
+    if (!indexUsed) {
+        for (uint16_t i = 0; i < NumSlots; i++) {
+            scanPresetSlot(i);
+        }
+        savePresetIndex();
+    }
+
+    System::logger.write(LOG_INFO,
+                         "Presets::assignPresetNames: source=%s, time=%lums",
+                         indexUsed ? "index" : "files",
+                         (unsigned long)(millis() - startTime));
+}
+
+/** Update the name of the preset slot that stores given preset file.
+ *
+ */
+void Presets::updatePresetName(const char *presetFilename)
 {
     for (uint16_t i = 0; i < NumSlots; i++) {
         char filename[MAX_FILENAME_LENGTH + 1];
-        snprintf(filename, MAX_FILENAME_LENGTH, "%s/p%03d.epr", appSandbox, i);
+        formatSlotFilename(filename, MAX_FILENAME_LENGTH, i);
 
-        if (File file = Hardware::sdcard.createInputStream(filename)) {
-            char presetName[Preset::MaxNameLength + 1];
-            Preset::getPresetName(file, presetName, Preset::MaxNameLength);
-            presetSlot[i].setPresetName(presetName);
-
-            char projectId[Preset::MaxProjectIdLength + 1];
-            Preset::getPresetProjectId(
-                file, projectId, Preset::MaxProjectIdLength);
-            presetSlot[i].setProjectId(projectId);
-            System::logger.write(LOG_ERROR,
-                                 "setting a preset name: %s, id=%d",
-                                 presetSlot[i].getPresetName(),
-                                 i);
-            file.close();
+        if (strcmp(filename, presetFilename) == 0) {
+            scanPresetSlot(i);
+            savePresetIndex();
+            return;
         }
     }
+
+    // The file does not belong to a known slot, rebuild everything
+    assignPresetNames(true);
 }
 
-void Presets::sendList(uint8_t port)
+/** Read the preset name and project id of a slot from its preset file.
+ *
+ */
+void Presets::scanPresetSlot(uint16_t slotId)
 {
-    bool firstRecord = true;
-    char buf[256]; // TODO: fix buffer overflow issue
+    char filename[MAX_FILENAME_LENGTH + 1];
+    formatSlotFilename(filename, MAX_FILENAME_LENGTH, slotId);
+
+    presetSlot[slotId].setPresetName("");
+    presetSlot[slotId].setProjectId("");
+
+    if (File file = Hardware::sdcard.createInputStream(filename)) {
+        char presetName[Preset::MaxNameLength + 1];
+        Preset::getPresetName(file, presetName, Preset::MaxNameLength);
+        presetSlot[slotId].setPresetName(presetName);
+
+        char projectId[Preset::MaxProjectIdLength + 1];
+        Preset::getPresetProjectId(file, projectId, Preset::MaxProjectIdLength);
+        presetSlot[slotId].setProjectId(projectId);
+        System::logger.write(LOG_TRACE,
+                             "setting a preset name: %s, id=%d",
+                             presetSlot[slotId].getPresetName(),
+                             slotId);
+        file.close();
+    }
+}
+
+/** Get size of the file, 0 when the file does not exist.
+ *
+ */
+uint32_t Presets::getFileSize(const char *filename) const
+{
+    uint32_t fileSize = 0;
+
+    if (File file = Hardware::sdcard.createInputStream(filename)) {
+        fileSize = file.size();
+        file.close();
+    }
+    return (fileSize);
+}
+
+/** Read the preset names and project ids of all slots from the index.
+ *  The index is trusted, every upload and removal of a preset updates it.
+ */
+bool Presets::loadPresetIndex(void)
+{
+    char filename[MAX_FILENAME_LENGTH + 1];
+    formatIndexFilename(filename, MAX_FILENAME_LENGTH);
 
-    buf[0] = 0xf0;
-    buf[1] = 0x00;
-    buf[2] = 0x21;
-    buf[3] = 0x45;
-    buf[4] = 0x01;
-    buf[5] = (char)ElectraCommand::Object::PresetList;
+    if (!Hardware::sdcard.exists(filename)) {
+        return (false);
+    }
+
+    File file = Hardware::sdcard.createInputStream(filename);
+
+    if (!file) {
+        return (false);
+    }
 
-    sprintf(buf + 6, "{\"version\":1,\"presets\":[");
+    PresetIndexHeader header;
+    PresetIndexRecord records[NumSlots];
 
-    MidiOutput::sendSysExPartial(MidiInterface::Type::MidiUsbDev,
-                                 port,
-                                 (uint8_t *)buf,
-                                 strlen(buf + 6) + 6,
-                                 false);
+    bool status =
+        (file.size() == sizeof(header) + sizeof(records))
+        && (file.read((uint8_t *)&header, sizeof(header)) == sizeof(header))
+        && (header.magic == PresetIndexMagic)
+        && (header.numSlots == NumSlots)
+        && (file.read((uint8_t *)records, sizeof(records)) == sizeof(records));
+    file.close();
+
+    if (!status) {
+        System::logger.write(
+            LOG_ERROR, "Presets::loadPresetIndex: invalid index: %s", filename);
+        return (false);
+    }
+
+    for (uint16_t i = 0; i < NumSlots; i++) {
+        presetSlot[i].setPresetName(records[i].presetName);
+        presetSlot[i].setProjectId(records[i].projectId);
+    }
+    return (true);
+}
+
+/** Write the preset names and project ids of all slots to the index.
+ *
+ */
+void Presets::savePresetIndex(void)
+{
+    char filename[MAX_FILENAME_LENGTH + 1];
+    formatIndexFilename(filename, MAX_FILENAME_LENGTH);
+
+    PresetIndexHeader header = { PresetIndexMagic, NumSlots };
+    PresetIndexRecord records[NumSlots];
+
+    for (uint16_t i = 0; i < NumSlots; i++) {
+        copyString(records[i].presetName,
+                   presetSlot[i].getPresetName(),
+                   Preset::MaxNameLength);
+        copyString(records[i].projectId,
+                   presetSlot[i].getProjectId(),
+                   Preset::MaxProjectIdLength);
+    }
+
+    File file = Hardware::sdcard.createOutputStream(
+        filename, FILE_WRITE | O_CREAT | O_TRUNC);
+
+    if (!file) {
+        System::logger.write(
+            LOG_ERROR, "Presets::savePresetIndex: cannot open file: %s", filename);
+        return;
+    }
+
+    file.write((uint8_t *)&header, sizeof(header));
+    file.write((uint8_t *)records, sizeof(records));
+    file.close();
+}
+
+void Presets::formatSlotFilename(char *buffer,
+                                 size_t maxLength,
+                                 uint16_t slotId) const
+{
+    snprintf(buffer, maxLength, "%s/p%03d.epr", appSandbox, slotId);
+}
+
+void Presets::formatIndexFilename(char *buffer, size_t maxLength) const
+{
+    snprintf(buffer, maxLength, "%s/presets.idx", appSandbox);
+}
+
+void Presets::sendList(uint8_t port)
+{
+    bool firstRecord = true;
+    SysexJsonWriter writer(port, ElectraCommand::Object::PresetList);
+
+    writer.write("{\"version\":1,\"presets\":[");
 
     for (uint8_t i = 0; i < 72; i++) {
         if (strlen(presetSlot[i].getPresetName()) > 0) {
-            sprintf(
-                buf,
-                "%s{\"slot\":%d,\"bankNumber\":%d,\"name\":\"%s\",\"projectId\":\"%s\"}",
-                (firstRecord) ? "" : ",",
-                i % 12,
-                i / 12,
-                presetSlot[i].getPresetName(),
-                presetSlot[i].getProjectId());
+            writer.write((firstRecord) ? "{\"slot\":" : ",{\"slot\":");
+            writer.writeInteger(i % 12);
+            writer.write(",\"bankNumber\":");
+            writer.writeInteger(i / 12);
+            writer.write(",\"name\":");
+            writer.writeString(presetSlot[i].getPresetName());
+            writer.write(",\"projectId\":");
+            writer.writeString(presetSlot[i].getProjectId());
+            writer.write("}");
             firstRecord = false;
-            MidiOutput::sendSysExPartial(MidiInterface::Type::MidiUsbDev,
-                                         port,
-                                         (uint8_t *)buf,
-                                         strlen(buf),
-                                         false);
         }
     }
-    sprintf(buf, "]}");
-    buf[2] = 0xf7;
-
-    MidiOutput::sendSysExPartial(
-        MidiInterface::Type::MidiUsbDev, port, (uint8_t *)buf, 3, false);
+    writer.write("]}");
+    writer.end();
 
     System::sysExBusy = false;
 }
@@ -102,11 +234,18 @@ bool Presets::loadPreset(LocalFile file)
     reset();
 
     if (Hardware::sdcard.exists(presetFile)) {
+        uint32_t freeRam = Hardware::ram.adj_free();
+
         if (preset.load(presetFile) == true) {
             System::logger.write(
                 LOG_INFO, "Default preset loaded: filename=%s", presetFile);
         }
 
+        // Kept to estimate the memory needed by a new revision of the preset
+        uint32_t usedRam = freeRam - Hardware::ram.adj_free();
+        presetRamUsage = (usedRam < freeRam) ? usedRam : 0;
+        presetFileSize = getFileSize(presetFile);
+
         // Display the preset if valid.
         if (preset.isValid()) {
             // Initialise the parameterMap
@@ -116,7 +255,7 @@ bool Presets::loadPreset(LocalFile file)
                 }
             }
 
-            if (Hardware::ram.adj_free() > 62000) {
+            if (Hardware::ram.adj_free() > MinFreeRam) {
                 parameterMap.setProjectId(preset.getProjectId());
 
                 uint8_t presetId =
@@ -152,12 +291,119 @@ bool Presets::loadPreset(LocalFile file)
     return (true);
 }
 
+/** Load a new revision of the active preset.
+ *  The revision is loaded to a separate Preset, so that it can be compared
+ *  with the active one. nullptr is returned when the file does not replace
+ *  the active preset or when there is not enough memory for both revisions.
+ */
+Preset *Presets::loadPresetUpdate(LocalFile file)
+{
+    const char *presetFile = file.getFilepath();
+
+    if (!preset.isValid() || (loadedPresetId != getPresetId())
+        || !Hardware::sdcard.exists(presetFile)) {
+        return (nullptr);
+    }
+
+    // Memory of the revision estimated from the active preset and file sizes
+    uint32_t updateFileSize = getFileSize(presetFile);
+
+    if ((presetRamUsage == 0) || (presetFileSize == 0)
+        || (Hardware::ram.adj_free()
+            <= MinFreeRam
+                   + (uint64_t)presetRamUsage * updateFileSize
+                         / presetFileSize)) {
+        System::logger.write(
+            LOG_INFO,
+            "Presets::loadPresetUpdate: not enough memory: file=%s",
+            presetFile);
+        return (nullptr);
+    }
+
+    Preset *update = new Preset();
+
+    if (!update->load(presetFile)
+        || (Hardware::ram.adj_free() <= MinFreeRam)) {
+        System::logger.write(
+            LOG_INFO,
+            "Presets::loadPresetUpdate: update not possible: file=%s",
+            presetFile);
+        delete update;
+        return (nullptr);
+    }
+
+    return (update);
+}
+
+/** Apply changed controls of the new revision to the active preset.
+ *  Controls that were not changed keep their ParameterMap entries, the
+ *  values of changed controls are taken from the ParameterMap too. Only
+ *  parameters that are new to the preset start with their default values.
+ */
+void Presets::applyPresetUpdate(const Preset &update,
+                                const Preset::ControlChanges &changes)
+{
+    std::vector<uint16_t> updatedIds(changes.added);
+    updatedIds.insert(
+        updatedIds.end(), changes.changed.begin(), changes.changed.end());
+
+    for (auto controlId : changes.removed) {
+        Control &control = preset.getControl(controlId);
+
+        for (auto &value : control.values) {
+            control.removeFromParameterMap(value);
+        }
+    }
+    for (auto controlId : changes.changed) {
+        Control &control = preset.getControl(controlId);
+
+        for (auto &value : control.values) {
+            control.removeFromParameterMap(value);
+        }
+    }
+
+    preset.applyChanges(update, changes);
+
+    for (auto controlId : updatedIds) {
+        Control &control = preset.getControl(controlId);
+
+        for (auto &value : control.values) {
+            if (parameterMap.get(value.message.getDeviceId(),
+                                 value.message.getType(),
+                                 value.message.getParameterNumber())) {
+                control.addToParameterMap(value);
+            } else {
+                control.setDefaultValue(value, false);
+            }
+        }
+    }
+
+    parameterMap.invalidateBindings();
+
+    /* Lua may hold pointers to the controls and values that were replaced,
+     * the script is run again to refer to the new ones.
+     */
+    if (L
+        && (!changes.removed.empty() || !changes.added.empty()
+            || !changes.changed.empty())) {
+        runUploadedLuaScript();
+    }
+
+    System::logger.write(
+        LOG_INFO,
+        "Presets::applyPresetUpdate: removed=%lu, added=%lu, changed=%lu",
+        (unsigned long)changes.removed.size(),
+        (unsigned long)changes.added.size(),
+        (unsigned long)changes.changed.size());
+}
+
 /** Mark preset slot
  *  Mark given preset slot as unused.
  */
 void Presets::removePreset(uint8_t slotId)
 {
     presetSlot[slotId].clear();
+    savePresetIndex();
 }
 
 /** Reset preset.
@@ -187,6 +433,8 @@ void Presets::reset(void)
 
     // Reset preset
     preset.reset();
+    ValueTransform::clear();
+    loadedPresetId = NoPresetLoaded;
 
     // Reset parameterMap
     parameterMap.clear();
@@ -233,6 +481,8 @@ bool Presets::loadPresetById(uint8_t presetId)
                              "loadPresetById: preset loaded: name='%s'",
                              preset.getName());
 
+        loadedPresetId = presetId;
+
         // Re-set Lua state and execute
         runPresetLuaScript();
 
@@ -272,6 +522,8 @@ void Presets::runUploadedLuaScript(void)
  */
 void Presets::runPresetLuaScript(void)
 {
+    // Callback references belong to the Lua state that is closed
+    resetMidiCallbacks();
     closeLua();
 
     luaPreset = &preset;
@@ -279,9 +531,13 @@ void Presets::runPresetLuaScript(void)
     if (isLuaValid(System::context.getCurrentLuaFile())) {
         L = initLua();
         loadLuaLibs();
+        resetLuaFunctions(preset.luaFunctions);
 
         executeElectraLua(System::context.getCurrentLuaFile());
 
+        // Bind the preset functions to their ids
+        resolveLuaFunctions();
+
         // Assign Lua callbacks
         assignLuaCallbacks();
 
@@ -385,6 +641,8 @@ bool Presets::updateSlot(uint8_t presetId, const char *newPresetPath)
         slotLuaFilename, MAX_FILENAME_LENGTH, presetId);
 
     // Delete existing preset and Lua files if they exist
+    PresetCache::invalidate(slotPresetFilename);
+
     if (Hardware::sdcard.exists(slotPresetFilename)) {
         Hardware::sdcard.deleteFile(slotPresetFilename);
     }
@@ -415,6 +673,9 @@ bool Presets::updateSlot(uint8_t presetId, const char *newPresetPath)
     // Force preset reload, when the slot is used next time
     presetSlot[presetId].setAlreadyLoaded(false);
 
+    scanPresetSlot(presetId);
+    savePresetIndex();
+
     return (success);
 }
 
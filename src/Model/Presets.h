@@ -13,12 +13,16 @@ public:
             const bool &shouldLoadPresetStateOnStartup);
     virtual ~Presets() = default;
 
-    void assignPresetNames(void);
+    void assignPresetNames(bool rescan = false);
+    void updatePresetName(const char *presetFilename);
     void sendList(uint8_t port);
 
     bool loadPresetById(uint8_t presetId);
     void runUploadedLuaScript(void);
     bool loadPreset(LocalFile file);
+    Preset *loadPresetUpdate(LocalFile file);
+    void applyPresetUpdate(const Preset &update,
+                           const Preset::ControlChanges &changes);
     void removePreset(uint8_t presetId);
     void reset(void);
     void runPresetLuaScript(void);
@@ -46,7 +50,29 @@ public:
     static constexpr uint16_t NumSlots = NumBanks * NumPresetsInBank;
 
 private:
+    static constexpr uint32_t PresetIndexMagic = 0x58495045; // "EPIX"
+    static constexpr uint8_t NoPresetLoaded = 0xFF;
+    static constexpr uint32_t MinFreeRam = 62000;
+
+    struct PresetIndexHeader {
+        uint32_t magic;
+        uint16_t numSlots;
+    };
+
+    struct PresetIndexRecord {
+        char presetName[Preset::MaxNameLength + 1];
+        char projectId[Preset::MaxProjectIdLength + 1];
+    };
+
     void setDefaultFiles(uint8_t newBankNumber, uint8_t newSlot);
+    void scanPresetSlot(uint16_t slotId);
+    uint32_t getFileSize(const char *filename) const;
+    bool loadPresetIndex(void);
+    void savePresetIndex(void);
+    void formatSlotFilename(char *buffer,
+                            size_t maxLength,
+                            uint16_t slotId) const;
+    void formatIndexFilename(char *buffer, size_t maxLength) const;
 
     const char *appSandbox;
 
@@ -58,6 +84,9 @@ private:
     PresetSlot presetSlot[NumSlots];
 
     bool readyForPresetSwitch;
+    uint32_t presetRamUsage; // RAM taken by the active preset when loaded
+    uint32_t presetFileSize;
+    uint8_t loadedPresetId;
     const bool &keepPresetState;
     const bool &loadPresetStateOnStartup;
 };
@@ -0,0 +1,170 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+/**
+ * @file ResponseIndex.cpp
+ *
+ * @brief Implements a prefix trie of the SysEx response headers of all
+ *  preset devices.
+ */
+
+#include "ResponseIndex.h"
+#include <algorithm>
+
+void ResponseIndex::build(const Devices &devices)
+{
+    clear();
+    nodes.push_back(Node{ 0, NoNode, NoNode, {} });
+
+    for (const auto &[id, device] : devices) {
+        for (const auto &response : device.responses) {
+            uint16_t staticLength = 0;
+            uint16_t headerLength =
+                getRenderedLength(response.headers, staticLength);
+            uint16_t node = 0;
+
+            for (uint16_t i = 0; i < staticLength; i++) {
+                node = addChild(node, response.headers[i]);
+            }
+
+            nodes[node].entries.push_back(entries.size());
+            entries.push_back(Entry{ &device,
+                                     &response,
+                                     headerLength,
+                                     (staticLength == headerLength) });
+
+            maxHeaderLength = std::max(maxHeaderLength, headerLength);
+        }
+    }
+}
+
+void ResponseIndex::clear(void)
+{
+    nodes.clear();
+    entries.clear();
+    maxHeaderLength = 0;
+}
+
+void ResponseIndex::findCandidates(const SysexBlock &sysexBlock,
+                                   std::vector<uint16_t> &candidates) const
+{
+    candidates.clear();
+
+    if (nodes.empty()) {
+        return;
+    }
+
+    auto sysexLength = sysexBlock.getLength();
+    uint16_t node = 0;
+    uint16_t depth = 0;
+
+    while (node != NoNode) {
+        for (const auto &entryIndex : nodes[node].entries) {
+            // static headers must be followed by at least one byte
+            if (!entries[entryIndex].isStatic || (sysexLength > depth)) {
+                candidates.push_back(entryIndex);
+            }
+        }
+
+        if (depth >= sysexLength) {
+            break;
+        }
+
+        node = findChild(node, sysexBlock.peek(depth));
+        depth++;
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+}
+
+void ResponseIndex::print(uint8_t logLevel) const
+{
+    System::logger.write(logLevel,
+                         "ResponseIndex: entries=%d, nodes=%d, maxLength=%d",
+                         entries.size(),
+                         nodes.size(),
+                         maxHeaderLength);
+}
+
+uint16_t ResponseIndex::addChild(uint16_t parent, uint8_t byte)
+{
+    uint16_t child = findChild(parent, byte);
+
+    if (child != NoNode) {
+        return (child);
+    }
+
+    child = nodes.size();
+    nodes.push_back(Node{ byte, NoNode, nodes[parent].firstChild, {} });
+    nodes[parent].firstChild = child;
+
+    return (child);
+}
+
+uint16_t ResponseIndex::findChild(uint16_t parent, uint8_t byte) const
+{
+    uint16_t child = nodes[parent].firstChild;
+
+    while ((child != NoNode) && (nodes[child].byte != byte)) {
+        child = nodes[child].nextSibling;
+    }
+    return (child);
+}
+
+bool ResponseIndex::isTemplateOp(uint8_t byte)
+{
+    return ((byte == VARIABLE_DATA) || (byte == VARIABLE_PARAMETER)
+            || (byte == CHECKSUM) || (byte == LUAFUNCTION));
+}
+
+/** Computes the length of the header rendered by Midi::transformMessage
+ *  and the number of its leading constant bytes.
+ */
+uint16_t ResponseIndex::getRenderedLength(const DataBytes &header,
+                                          uint16_t &staticLength)
+{
+    uint16_t length = 0;
+    bool isPrefix = true;
+
+    staticLength = 0;
+
+    for (uint16_t i = 0; i < header.size(); i++) {
+        uint8_t byte = header[i];
+
+        if (isTemplateOp(byte)) {
+            isPrefix = false;
+        } else if (isPrefix) {
+            staticLength++;
+        }
+
+        if ((byte == VARIABLE_DATA) || (byte == VARIABLE_PARAMETER)) {
+            while ((i < header.size()) && (header[i] != VARIABLE_END)) {
+                i++;
+            }
+        } else if (byte == CHECKSUM) {
+            i += 3;
+        } else if (byte == LUAFUNCTION) {
+            i++;
+        }
+        length++;
+    }
+    return (length);
+}
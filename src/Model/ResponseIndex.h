@@ -0,0 +1,127 @@
+/*
+* Electra One MIDI Controller Firmware
+* See COPYRIGHT file at the top of the source tree.
+*
+* This product includes software developed by the
+* Electra One Project (http://electra.one/).
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.
+*/
+
+/**
+ * @file ResponseIndex.h
+ *
+ * @brief Implements a prefix trie of the SysEx response headers of all
+ *  preset devices.
+ *
+ * The constant leading bytes of every response header are stored in
+ * the trie when the preset is loaded. Incoming SysEx messages are then
+ * matched with a single walk over their bytes. Headers that contain
+ * variables, checksums, or functions are stored under their constant
+ * prefix and flagged for rendering at the time of matching.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Device.h"
+#include "SysexBlock.h"
+
+class ResponseIndex
+{
+public:
+    struct Entry {
+        const Device *device;
+        const Response *response;
+        uint16_t headerLength;
+        bool isStatic;
+    };
+
+    ResponseIndex() = default;
+    ~ResponseIndex() = default;
+
+    /**
+     * @brief Compiles the response headers of all devices
+     *
+     * Entries are numbered in the order of devices and their responses.
+     * The index must be rebuilt whenever devices or responses change.
+     *
+     * @param devices devices of the preset
+     */
+    void build(const Devices &devices);
+
+    /**
+     * @brief Removes all entries and nodes
+     */
+    void clear(void);
+
+    /**
+     * @brief Collects the entries whose constant header prefix matches
+     *  the SysEx message
+     *
+     * Candidates are returned in ascending order, ie. in the order
+     * of devices and responses. Candidates that are not static must be
+     * verified by rendering their full header.
+     *
+     * @param sysexBlock received SysEx message
+     * @param candidates vector to store the indexes of entries to
+     */
+    void findCandidates(const SysexBlock &sysexBlock,
+                        std::vector<uint16_t> &candidates) const;
+
+    /**
+     * @brief Returns an entry of the index
+     *
+     * @param index index of the entry as returned by findCandidates
+     * @return const Entry& reference to the entry
+     */
+    const Entry &getEntry(uint16_t index) const
+    {
+        return (entries[index]);
+    }
+
+    /**
+     * @brief Returns the length of the longest rendered header
+     *
+     * @return uint16_t number of bytes
+     */
+    uint16_t getMaxHeaderLength(void) const
+    {
+        return (maxHeaderLength);
+    }
+
+    void print(uint8_t logLevel = LOG_TRACE) const;
+
+private:
+    struct Node {
+        uint8_t byte;
+        uint16_t firstChild;
+        uint16_t nextSibling;
+        std::vector<uint16_t> entries;
+    };
+
+    static constexpr uint16_t NoNode = 0xFFFF;
+
+    uint16_t addChild(uint16_t parent, uint8_t byte);
+    uint16_t findChild(uint16_t parent, uint8_t byte) const;
+
+    static bool isTemplateOp(uint8_t byte);
+    static uint16_t getRenderedLength(const DataBytes &header,
+                                      uint16_t &staticLength);
+
+    std::vector<Node> nodes;
+    std::vector<Entry> entries;
+    uint16_t maxHeaderLength = 0;
+};
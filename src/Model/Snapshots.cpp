@@ -2,6 +2,7 @@
 #include "Database.h"
 #include "ParameterMap.h"
 #include "MidiOutput.h"
+#include "SysexJsonWriter.h"
 
 Snapshots::Snapshots(const char *newAppSandbox)
     : appSandbox(newAppSandbox), destBankNumber(0), destSlot(0)
@@ -65,7 +66,6 @@ uint8_t Snapshots::getDestSlot(void) const
 void Snapshots::sendList(uint8_t port, const char *projectId)
 {
     char dbFile[MAX_FILENAME_LENGTH + 1];
-    char tempSnapshotFilename[MAX_FILENAME_LENGTH + 1];
 
     System::sysExBusy = true;
 
@@ -75,12 +75,6 @@ void Snapshots::sendList(uint8_t port, const char *projectId)
              appSandbox,
              projectId);
 
-    snprintf(tempSnapshotFilename,
-             MAX_FILENAME_LENGTH,
-             "%s/%08ld.tmp",
-             appSandbox,
-             millis());
-
     Database dbSnapshot(dbFile);
 
     if (!dbSnapshot.open()) {
@@ -90,62 +84,41 @@ void Snapshots::sendList(uint8_t port, const char *projectId)
         return;
     }
 
-    File snapshotJsonFile = Hardware::sdcard.createOutputStream(
-        tempSnapshotFilename, FILE_WRITE | O_CREAT | O_TRUNC);
-
-    if (!snapshotJsonFile) {
-        System::logger.write(LOG_ERROR,
-                             "Snapshots::sendList: cannot open transfer file");
-        dbSnapshot.close();
-        System::sysExBusy = false;
-        return;
-    }
-
+    uint32_t startTime = millis();
     SnapshotRecord snapRec;
     bool firstRecord = true;
-    char buf[256]; // \todo fix buffer overflow issue
-
-    buf[0] = 0xf0;
-    buf[1] = 0x00;
-    buf[2] = 0x21;
-    buf[3] = 0x45;
-    buf[4] = 0x01;
-    buf[5] = (char)ElectraCommand::Object::SnapshotList;
+    SysexJsonWriter writer(port, ElectraCommand::Object::SnapshotList);
 
-    sprintf(buf + 6,
-            "{\"version\":1,\"projectId\":\"%s\",\"snapshots\":[",
-            projectId);
-
-    MidiOutput::sendSysExPartial(MidiInterface::Type::MidiUsbDev,
-                                 port,
-                                 (uint8_t *)buf,
-                                 strlen(buf + 6) + 6,
-                                 false);
+    writer.write("{\"version\":1,\"projectId\":");
+    writer.writeString(projectId);
+    writer.write(",\"snapshots\":[");
 
     for (uint16_t i = 0; i < dbSnapshot.getNumRecords(); i++) {
-        if (dbSnapshot.select(i, DB_RECORD snapRec)) {
-            sprintf(
-                buf,
-                "%s{\"slot\":%d,\"bankNumber\":%d,\"name\":\"%s\",\"color\":\"%06X\"}",
-                (firstRecord) ? "" : ",",
-                snapRec.slot,
-                snapRec.bankNumber,
-                snapRec.name,
-                snapRec.colour & 0xffffff);
+        if (dbSnapshot.isUsed(i) && dbSnapshot.select(i, DB_RECORD snapRec)) {
+            snapRec.name[MAX_SNAPSHOT_NAME_LENGTH] = '\0';
+
+            writer.write((firstRecord) ? "{\"slot\":" : ",{\"slot\":");
+            writer.writeInteger(snapRec.slot);
+            writer.write(",\"bankNumber\":");
+            writer.writeInteger(snapRec.bankNumber);
+            writer.write(",\"name\":");
+            writer.writeString(snapRec.name);
+            writer.write(",\"color\":\"");
+            writer.writeHex(snapRec.colour & 0xffffff, 6);
+            writer.write("\"}");
             firstRecord = false;
-            MidiOutput::sendSysExPartial(MidiInterface::Type::MidiUsbDev,
-                                         port,
-                                         (uint8_t *)buf,
-                                         strlen(buf),
-                                         false);
         }
     }
 
-    sprintf(buf, "]}");
-    buf[2] = 0xf7;
+    writer.write("]}");
+    writer.end();
 
-    MidiOutput::sendSysExPartial(
-        MidiInterface::Type::MidiUsbDev, port, (uint8_t *)buf, 3, false);
+    System::logger.write(LOG_INFO,
+                         "Snapshots::sendList: length=%lu, transfers=%d, "
+                         "time=%lums",
+                         (unsigned long)writer.getLength(),
+                         writer.getNumTransfers(),
+                         (unsigned long)(millis() - startTime));
 
     System::sysExBusy = false;
 }
@@ -161,8 +134,31 @@ void Snapshots::sendSnapshot(uint8_t port,
     createSnapshotFilename(snapshotFilename, projectId, bankNumber, slot);
 
     if (Hardware::sdcard.exists(snapshotFilename)) {
-        MidiOutput::sendSysExFile(
-            port, snapshotFilename, ElectraCommand::Object::FileSnapshot);
+        if (ParameterMap::isSnapshotImage(snapshotFilename)) {
+            char tempSnapshotFilename[MAX_FILENAME_LENGTH + 1];
+
+            snprintf(tempSnapshotFilename,
+                     MAX_FILENAME_LENGTH,
+                     "%s/%08ld.tmp",
+                     appSandbox,
+                     millis());
+
+            if (ParameterMap::exportSnapshot(snapshotFilename,
+                                             tempSnapshotFilename)) {
+                MidiOutput::sendSysExFile(port,
+                                          tempSnapshotFilename,
+                                          ElectraCommand::Object::FileSnapshot);
+            } else {
+                System::logger.write(
+                    LOG_ERROR,
+                    "Snapshots::sendSnapshot: cannot export snapshot: %s",
+                    snapshotFilename);
+            }
+            Hardware::sdcard.deleteFile(tempSnapshotFilename);
+        } else {
+            MidiOutput::sendSysExFile(
+                port, snapshotFilename, ElectraCommand::Object::FileSnapshot);
+        }
     }
     System::sysExBusy = false;
 }
@@ -187,7 +183,20 @@ Snapshot Snapshots::importSnapshot(LocalFile file)
 
     System::sysExBusy = true;
     if (!Hardware::sdcard.exists(snapshotFilename)) {
-        if (file.rename(snapshotFilename)) {
+        bool status = false;
+
+        if (ParameterMap::importSnapshot(file.getFilepath(),
+                                         snapshotFilename)) {
+            Hardware::sdcard.deleteFile(file.getFilepath());
+            status = true;
+        } else {
+            System::logger.write(
+                LOG_ERROR,
+                "importSnapshot: cannot convert snapshot, storing it as is");
+            status = file.rename(snapshotFilename);
+        }
+
+        if (status) {
             updateSnapshotDb(destProjectId,
                              destBankNumber,
                              destSlot,
@@ -199,17 +208,26 @@ Snapshot Snapshots::importSnapshot(LocalFile file)
     return (snapshot);
 }
 
-void Snapshots::sendSnapshotMessages(const char *projectId,
-                                     uint8_t bankNumber,
-                                     uint8_t slot)
+/** Load the snapshot values to the ParameterMap.
+ *  The entries whose value was changed are returned in changedEntries.
+ */
+uint16_t Snapshots::sendSnapshotMessages(
+    const char *projectId,
+    uint8_t bankNumber,
+    uint8_t slot,
+    std::vector<LookupEntry *> &changedEntries)
 {
+    uint16_t numEntries = 0;
     char filename[MAX_FILENAME_LENGTH + 1];
     createSnapshotFilename(filename, projectId, bankNumber, slot);
     System::sysExBusy = true;
+    changedEntries.clear();
     if (Hardware::sdcard.exists(filename)) {
-        parameterMap.load(filename);
+        numEntries = parameterMap.loadChanges(filename, changedEntries);
     }
     System::sysExBusy = false;
+
+    return (numEntries);
 }
 
 void Snapshots::saveSnapshot(const char *projectId,
@@ -221,7 +239,7 @@ void Snapshots::saveSnapshot(const char *projectId,
     char filename[MAX_FILENAME_LENGTH + 1];
     createSnapshotFilename(filename, projectId, bankNumber, slot);
     System::sysExBusy = true;
-    parameterMap.save(filename);
+    parameterMap.saveSnapshot(filename);
     updateSnapshotDb(projectId, bankNumber, slot, newName, newColour);
     System::sysExBusy = false;
 }
@@ -417,6 +435,7 @@ void Snapshots::swapSnapshotDb(const char *projectId,
     Database dbSnapshot(snapshotFilename); // x
 
     dbSnapshot.open();
+    dbSnapshot.begin();
 
     dbSnapshot.select(sourceId, DB_RECORD sourceRec);
     bool destUsed = dbSnapshot.select(destId, DB_RECORD destRec);
@@ -458,6 +477,7 @@ void Snapshots::swapSnapshotDb(const char *projectId,
         destId,
         destBankNumber,
         destSlot);
+    dbSnapshot.commit();
     dbSnapshot.close();
 }
 
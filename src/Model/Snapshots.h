@@ -2,6 +2,8 @@
 
 #include "Snapshot.h"
 #include "LocalFile.h"
+#include "LookupEntry.h"
+#include <vector>
 
 class Snapshots
 {
@@ -25,9 +27,10 @@ public:
                       uint8_t slot);
 
     Snapshot importSnapshot(LocalFile file);
-    void sendSnapshotMessages(const char *projectId,
-                              uint8_t bankNumber,
-                              uint8_t slot);
+    uint16_t sendSnapshotMessages(const char *projectId,
+                                  uint8_t bankNumber,
+                                  uint8_t slot,
+                                  std::vector<LookupEntry *> &changedEntries);
     void saveSnapshot(const char *projectId,
                       uint8_t bankNumber,
                       uint8_t slot,
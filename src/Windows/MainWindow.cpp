@@ -244,12 +244,77 @@ void MainWindow::refreshControl(const Control &control)
 bool MainWindow::loadPreset(LocalFile &file)
 {
     System::tasks.enableSpinner();
-    switchPreset(presets.getCurrentBankNumber(), presets.getCurrentSlot());
+
+    if (!updatePreset(file)) {
+        switchPreset(presets.getCurrentBankNumber(), presets.getCurrentSlot());
+    }
     System::tasks.disableSpinner();
 
     return (preset.isValid());
 }
 
+/** Apply a new revision of the active preset in place
+ *
+ * Only components of removed, added and changed controls are rebuilt.
+ * false is returned when the preset needs to be switched to from scratch.
+ */
+bool MainWindow::updatePreset(LocalFile &file)
+{
+    Preset *update = presets.loadPresetUpdate(file);
+    Preset::ControlChanges changes;
+
+    if (!update) {
+        return (false);
+    }
+
+    if (!preset.diff(*update, changes)) {
+        delete update;
+        return (false);
+    }
+
+    // Windows may refer to the controls that are going to be replaced
+    closeAllWindows();
+
+    if (pageView) {
+        for (auto controlId : changes.removed) {
+            removeControlFromPage(preset.getControl(controlId));
+        }
+        for (auto controlId : changes.changed) {
+            removeControlFromPage(preset.getControl(controlId));
+        }
+    }
+
+    presets.applyPresetUpdate(*update, changes);
+    delete update;
+
+    if (pageView) {
+        for (auto controlId : changes.added) {
+            addControlToPage(preset.getControl(controlId));
+        }
+        for (auto controlId : changes.changed) {
+            addControlToPage(preset.getControl(controlId));
+        }
+        pageView->setControlSet(currentControlSetId);
+        pageView->changePresetName(preset.getName());
+    }
+
+    return (true);
+}
+
+void MainWindow::addControlToPage(const Control &control)
+{
+    if (control.getPageId() == currentPageId) {
+        pageView->addControl(control);
+    }
+}
+
+void MainWindow::removeControlFromPage(const Control &control)
+{
+    if (control.getPageId() == currentPageId) {
+        pageView->removeControl(control);
+    }
+}
+
 bool MainWindow::loadLua(LocalFile &file)
 {
     if (isLuaValid(System::context.getCurrentLuaFile())) {
@@ -320,6 +385,7 @@ void MainWindow::setControlPot(uint16_t controlId,
                              newPotId);
         control.setControlSetId(newControlSetId - 1);
         control.inputs[0].setPotId(newPotId - 1);
+        preset.reindexControl(control);
 
         if (pageView) {
             pageView->reassignComponent(control);
@@ -355,6 +421,7 @@ void MainWindow::setControlSlot(uint16_t controlId, uint8_t newSlot)
         control.setVisible(true);
         control.inputs[0].setPotId(newPotId);
         control.setControlSetId(newControlSetId);
+        preset.reindexControl(control);
 
         if (Component *component = control.getComponent()) {
             component->setBounds(bounds);
@@ -725,6 +792,9 @@ void MainWindow::switchPreset(uint8_t bankNumber, uint8_t slot)
         pageView = nullptr;
     }
 
+    // Devices of the new preset start with a clean output state
+    midi.resetOutput();
+
     if (!presets.loadPresetById(bankNumber * Preset::MaxNumPots + slot)) {
         setInfoText("out of memory!");
     } else {
@@ -799,8 +869,16 @@ void MainWindow::loadSnapshot(const char *projectId,
         projectId,
         bankNumber,
         slot);
-    snapshots.sendSnapshotMessages(projectId, bankNumber, slot);
-    sendAllControls();
+    std::vector<LookupEntry *> changedEntries;
+    uint16_t numEntries = snapshots.sendSnapshotMessages(
+        projectId, bankNumber, slot, changedEntries);
+    uint16_t numSent = sendChangedEntries(changedEntries);
+
+    System::logger.write(LOG_INFO,
+                         "loadSnapshot: entries=%d, sent=%d, skipped=%d",
+                         numEntries,
+                         numSent,
+                         numEntries - numSent);
 }
 
 void MainWindow::saveSnapshot(const char *projectId,
@@ -961,6 +1039,7 @@ void MainWindow::assignComponentToControl(uint16_t controlId,
     }
 #endif
     preset.getControl(controlId).setComponent(component);
+    parameterMap.invalidateBindings();
 }
 
 void MainWindow::removeComponentFromControl(uint16_t controlId)
@@ -1167,6 +1246,27 @@ void MainWindow::sendAllControls(void)
     }
 }
 
+/** Send the values of the changed entries.
+ *  Every entry is sent once, using its first message. The messages
+ *  are paced at the rate of their device.
+ */
+uint16_t MainWindow::sendChangedEntries(
+    const std::vector<LookupEntry *> &changedEntries)
+{
+    std::vector<Message> messages;
+
+    messages.reserve(changedEntries.size());
+
+    for (auto entry : changedEntries) {
+        if (entry->hasDestinations() && entry->hasValidMidiValue()) {
+            messages.push_back(entry->getMessage());
+        }
+    }
+    midi.sendMessageList(messages);
+
+    return (messages.size());
+}
+
 void MainWindow::sendPotTouchEvent(uint8_t potId,
                                    uint16_t controlId,
                                    bool touched)
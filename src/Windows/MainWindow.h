@@ -336,6 +336,9 @@ public:
     void initialiseEmpty(void) override;
 
 private:
+    bool updatePreset(LocalFile &file);
+    void addControlToPage(const Control &control);
+    void removeControlFromPage(const Control &control);
     void showDetailOfActivePotTouch(void);
     void showActiveHandle(Component *component, bool shouldBeShown);
     void switchToNextHandle(Component *component);
@@ -344,6 +347,8 @@ private:
     void switchToPreviousHandleOfActivePotTouch(void);
     Rectangle getDetailBounds(const Control &control);
     void refreshControl(const Control &control);
+    uint16_t
+        sendChangedEntries(const std::vector<LookupEntry *> &changedEntries);
 
     // MainWindow data
     Model &model;
@@ -20,6 +20,7 @@
 */
 
 #include "PageView.h"
+#include <algorithm>
 
 PageView::PageView(Preset *preset,
                    MainDelegate &newDelegate,
@@ -38,8 +39,8 @@ PageView::PageView(Preset *preset,
                 false, false, false, false, false, false }
 {
     setName("PageView");
-    addGroups(model->groups);
-    addControls(model->controls);
+    addGroups(model->getPageGroups(pageId));
+    addPageControls();
     addBottomBar(model->getName(), model->getPage(pageId).getName());
     setBounds(0, 0, 1024, 575);
     assignAllPots();
@@ -48,15 +49,13 @@ PageView::PageView(Preset *preset,
 
 PageView::~PageView(void)
 {
-    for (const auto &[id, control] : model->controls) {
-        if (control.getPageId() == pageId) {
-            delegate.removeComponentFromControl(control.getId());
+    for (uint8_t i = 0; i < Preset::MaxNumControlSets; i++) {
+        for (const auto control : model->getPageControls(pageId, i)) {
+            delegate.removeComponentFromControl(control->getId());
         }
     }
-    for (const auto &[id, group] : model->groups) {
-        if (group.getPageId() == pageId) {
-            delegate.removeComponentFromGroup(group.getId());
-        }
+    for (const auto group : model->getPageGroups(pageId)) {
+        delegate.removeComponentFromGroup(group->getId());
     }
     getWindow()->resetActiveTouch();
     parameterMap.disable();
@@ -64,24 +63,21 @@ PageView::~PageView(void)
 
 void PageView::setControlSet(uint8_t newControlSetId)
 {
+    uint8_t previousControlSetId = controlSetId;
     controlSetId = newControlSetId;
 
     resetUsedPots();
 
-    for (const auto &[id, control] : model->controls) {
-        if (control.getPageId() == pageId) {
-            auto cc = dynamic_cast<ControlComponent *>(control.getComponent());
+    // Only controls of the previous and new control set change their state
+    configureControls(model->getPageControls(pageId, controlSetId));
 
-            if (cc) {
-                configureControl(cc, control);
-            }
-        }
+    if (previousControlSetId != controlSetId) {
+        configureControls(model->getPageControls(pageId, previousControlSetId));
     }
-    for (const auto &[id, group] : model->groups) {
-        if (group.getPageId() == pageId) {
-            if (auto g = dynamic_cast<GroupControl *>(group.getComponent())) {
-                configureGroup(g, group);
-            }
+
+    for (const auto group : model->getPageGroups(pageId)) {
+        if (auto g = dynamic_cast<GroupControl *>(group->getComponent())) {
+            configureGroup(g, *group);
         }
     }
     repaint();
@@ -142,6 +138,12 @@ void PageView::reassignComponent(const Control &control)
     }
 }
 
+void PageView::changePresetName(const char *newName)
+{
+    bottomBar->setPresetName(newName);
+    bottomBar->repaint();
+}
+
 void PageView::changePageName(const char *newName)
 {
     bottomBar->setPageName(newName);
@@ -220,26 +222,46 @@ void PageView::resized(void)
     bottomBar->setBounds(12, 543, 1000, 22);
 }
 
-void PageView::addControls(const Controls &controls)
+/** Add components of all control sets of the page.
+ *  The per-set vectors are sorted by ids, they are merged so that the
+ *  components are added in the order of control ids.
+ */
+void PageView::addPageControls(void)
 {
-    for (const auto &[id, control] : controls) {
-        if (control.getPageId() == pageId) {
-            addControl(control);
-        }
+    std::vector<Control *> pageControls;
+
+    for (uint8_t i = 0; i < Preset::MaxNumControlSets; i++) {
+        const auto &controls = model->getPageControls(pageId, i);
+        auto middle = pageControls.insert(
+            pageControls.end(), controls.begin(), controls.end());
+
+        std::inplace_merge(pageControls.begin(),
+                           middle,
+                           pageControls.end(),
+                           [](const Control *a, const Control *b) {
+                               return (a->getId() < b->getId());
+                           });
     }
+
+    addControls(pageControls);
 }
 
-void PageView::addGroups(const Groups &groups)
+void PageView::addControls(const std::vector<Control *> &controls)
 {
-    for (const auto &[id, group] : groups) {
-        if (group.getPageId() == pageId) {
-            GroupControl *g = new GroupControl(group);
-
-            if (g) {
-                configureGroup(g, group);
-                addChildComponent(g);
-                delegate.assignComponentToGroup(group.getId(), g);
-            }
+    for (const auto control : controls) {
+        addControl(*control);
+    }
+}
+
+void PageView::addGroups(const std::vector<Group *> &groups)
+{
+    for (const auto group : groups) {
+        GroupControl *g = new GroupControl(*group);
+
+        if (g) {
+            configureGroup(g, *group);
+            addChildComponent(g);
+            delegate.assignComponentToGroup(group->getId(), g);
         }
     }
 }
@@ -278,6 +300,17 @@ void PageView::configureGroup(GroupControl *g,
     }
 }
 
+void PageView::configureControls(const std::vector<Control *> &controls)
+{
+    for (const auto control : controls) {
+        auto cc = dynamic_cast<ControlComponent *>(control->getComponent());
+
+        if (cc) {
+            configureControl(cc, *control);
+        }
+    }
+}
+
 void PageView::configureControl(ControlComponent *cc, const Control &control)
 {
     if (control.getControlSetId() == controlSetId) {
@@ -51,6 +51,7 @@ public:
     void onPotTouchDown(const PotEvent &potEvent) override;
     void onPotTouchUp(const PotEvent &potEvent) override;
     void reassignComponent(const Control &control);
+    void changePresetName(const char *newName);
     void changePageName(const char *newName);
     void setInfoText(const char *newText);
     void setRamPercentage(uint8_t newPercentage);
@@ -61,10 +62,12 @@ public:
     void resized(void) override;
 
 private:
-    void addControls(const Controls &controls);
-    void addGroups(const Groups &groups);
+    void addPageControls(void);
+    void addControls(const std::vector<Control *> &controls);
+    void addGroups(const std::vector<Group *> &groups);
     void addBottomBar(const char *presetName, const char *pageName);
     void configureGroup(GroupControl *g, const Group &group);
+    void configureControls(const std::vector<Control *> &controls);
     void configureControl(ControlComponent *cc, const Control &control);
     void resetUsedPots(void);
 